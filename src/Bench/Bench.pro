@@ -0,0 +1,6 @@
+# Benchmarks over mock-walletd's synthetic wallet
+
+TEMPLATE = subdirs
+
+SUBDIRS += HistoryBench.pro \
+    RpcBench.pro
@@ -0,0 +1,345 @@
+// Copyright (c) 2015-2018, The Bytecoin developers.
+// Licensed under the GNU Lesser General Public License. See LICENSE for details.
+
+#include <limits>
+#include <memory>
+#include <random>
+
+#include <QElapsedTimer>
+#include <QStandardPaths>
+#include <QTemporaryDir>
+#include <QtTest>
+
+#include "MockWalletd/SyntheticWallet.h"
+#include "balanceseries.h"
+#include "historycache.h"
+#include "historysortedmodel.h"
+#include "txcolumnstore.h"
+#include "txindex.h"
+#include "walletmodel.h"
+
+namespace WalletGUI
+{
+
+namespace
+{
+
+constexpr int DEFAULT_TRANSACTIONS = 1000000;
+constexpr quint32 CHUNK_TRANSACTIONS = 10000; // asked from the synthetic wallet at once
+constexpr quint32 REORG_BLOCKS = 10;
+constexpr int SERIES_QUERIES = 1000; // per iteration
+constexpr int BURST_UPDATES = 50; // status and balance changes each, as a fast sync brings them
+constexpr int FRAME_MSEC = 16; // WalletModel's default update interval
+constexpr int SEARCH_PREFIX = 6; // hex digits of a hash typed in
+
+int transactionCount()
+{
+    bool ok = false;
+    const int count = qEnvironmentVariableIntValue("BENCH_TRANSACTIONS", &ok);
+    return ok && count > 0 ? count : DEFAULT_TRANSACTIONS;
+}
+
+}
+
+// Benchmarks over a synthetic wallet's history, a million transactions unless BENCH_TRANSACTIONS says otherwise.
+// The history is written to a column store under a temporary home and WalletModel maps it the way it maps
+// a complete cached history on startup. Run with -iterations or -callgrind as any QtTest benchmark.
+class HistoryBench : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void sort_data();
+    void sort();
+
+    void seriesQuery_data();
+    void seriesQuery();
+    void seriesReorg_data();
+    void seriesReorg();
+
+    void coalescing_data();
+    void coalescing();
+
+    void search_data();
+    void search();
+
+private:
+    RpcApi::Transfers blocks(quint32 fromHeight, quint32 toHeight) const; // all of them, ascending
+
+    QTemporaryDir home_;
+    std::unique_ptr<MockWalletd::SyntheticWallet> wallet_;
+    std::unique_ptr<WalletModel> model_;
+    BalanceSeries series_; // of the whole history, in memory
+};
+
+void HistoryBench::initTestCase()
+{
+    // Settings and the history cache are under the home directory on Linux, in the app data location elsewhere
+    QVERIFY(home_.isValid());
+    qputenv("HOME", QFile::encodeName(home_.path()));
+    QStandardPaths::setTestModeEnabled(true);
+
+    MockWalletd::SyntheticWallet::Params params;
+    params.transactionCount = static_cast<quint32>(transactionCount());
+    wallet_.reset(new MockWalletd::SyntheticWallet(params));
+    const RpcApi::WalletInfo info = RpcApi::WalletInfo::fromJson(wallet_->walletInfo());
+
+    QElapsedTimer timer;
+    timer.start();
+    qint64 seriesNsecs = 0;
+    {
+        TxColumnStore store(HistoryCache(info.first_address, info.net).storeDirName());
+        const quint32 top = wallet_->topHeight();
+        for (quint32 from = 0; from < top;)
+        {
+            const RpcApi::Transfers transfers = RpcApi::Transfers::fromJson(wallet_->transfers(from, top + 1, true, CHUNK_TRANSACTIONS));
+            QVector<RpcApi::Transaction> txs;
+            for (const RpcApi::Block& block : transfers.blocks)
+                for (const RpcApi::Transaction& tx : block.transactions)
+                    txs << tx;
+            QVERIFY(store.append(txs));
+
+            QElapsedTimer seriesTimer;
+            seriesTimer.start();
+            for (const RpcApi::Transaction& tx : txs)
+                series_.add(tx);
+            seriesNsecs += seriesTimer.nsecsElapsed();
+
+            QVERIFY(transfers.next_from_height > from);
+            from = transfers.next_from_height;
+        }
+    }
+    qDebug("%u transactions stored in %lld ms, added to a balance series in %lld ms of it.",
+           wallet_->transactionCount(), timer.restart(), seriesNsecs / 1000000);
+
+    model_.reset(new WalletModel(nullptr));
+    model_->walletInfoReceived(info);
+    qDebug("Mapped by WalletModel in %lld ms.", timer.elapsed());
+    QCOMPARE(model_->rowCount(), static_cast<int>(wallet_->transactionCount()));
+}
+
+void HistoryBench::cleanupTestCase()
+{
+    model_.reset();
+    wallet_.reset();
+}
+
+RpcApi::Transfers HistoryBench::blocks(quint32 fromHeight, quint32 toHeight) const
+{
+    return RpcApi::Transfers::fromJson(wallet_->transfers(fromHeight, toHeight, true, std::numeric_limits<quint32>::max()));
+}
+
+void HistoryBench::sort_data()
+{
+    QTest::addColumn<int>("column");
+    QTest::newRow("amount") << static_cast<int>(WalletModel::COLUMN_AMOUNT);
+    QTest::newRow("fee") << static_cast<int>(WalletModel::COLUMN_FEE);
+    QTest::newRow("hash") << static_cast<int>(WalletModel::COLUMN_HASH);
+    QTest::newRow("block hash") << static_cast<int>(WalletModel::COLUMN_BLOCK_HASH);
+    QTest::newRow("timestamp") << static_cast<int>(WalletModel::COLUMN_TIMESTAMP);
+    QTest::newRow("height") << static_cast<int>(WalletModel::COLUMN_BLOCK_HEIGHT);
+    QTest::newRow("unlock time") << static_cast<int>(WalletModel::COLUMN_UNLOCK_TIME);
+    QTest::newRow("proof") << static_cast<int>(WalletModel::COLUMN_PROOF);
+}
+
+// A header click on the whole history: every key read through data(), then the radix sort
+void HistoryBench::sort()
+{
+    QFETCH(int, column);
+    SortedHistoryModel sorted(model_.get(), nullptr);
+    QBENCHMARK_ONCE
+    {
+        sorted.sort(column, Qt::DescendingOrder);
+    }
+
+    QCOMPARE(sorted.rowCount(), model_->rowCount());
+    const QVariant first = sorted.index(0, column).data(WalletModel::ROLE_SORT_KEY);
+    const QVariant last = sorted.index(sorted.rowCount() - 1, column).data(WalletModel::ROLE_SORT_KEY);
+    QVERIFY(first.isValid() && last.isValid());
+    QVERIFY(!(first < last));
+}
+
+void HistoryBench::seriesQuery_data()
+{
+    QTest::addColumn<QString>("query");
+    QTest::newRow("balance at height") << QStringLiteral("through");
+    QTest::newRow("days of a month") << QStringLiteral("days");
+    QTest::newRow("months of a year") << QStringLiteral("months");
+}
+
+// SERIES_QUERIES queries at random points of the history per iteration
+void HistoryBench::seriesQuery()
+{
+    QFETCH(QString, query);
+    const quint32 top = wallet_->topHeight();
+    QVERIFY(top > 100);
+    const RpcApi::Transfers first = blocks(0, 100);
+    const RpcApi::Transfers last = blocks(top - 100, top + 1);
+    QVERIFY(!first.blocks.isEmpty() && !last.blocks.isEmpty());
+    const qint64 firstDay = first.blocks.first().header.timestamp.toUTC().date().toJulianDay();
+    const qint64 lastDay = last.blocks.last().header.timestamp.toUTC().date().toJulianDay();
+
+    std::mt19937 random(1);
+    qint64 checksum = 0;
+    QBENCHMARK
+    {
+        for (int i = 0; i < SERIES_QUERIES; ++i)
+        {
+            if (query == QLatin1String("through"))
+                checksum += series_.through(random() % (top + 1)).net;
+            else
+            {
+                const QDate from = QDate::fromJulianDay(firstDay + static_cast<qint64>(random() % (lastDay - firstDay + 1)));
+                if (query == QLatin1String("days"))
+                    checksum += series_.days(from, from.addDays(30)).size();
+                else
+                    checksum += series_.months(from, from.addYears(1)).size();
+            }
+        }
+    }
+    QVERIFY(checksum != 0);
+}
+
+void HistoryBench::seriesReorg_data()
+{
+    QTest::addColumn<bool>("atTop");
+    QTest::newRow("top blocks") << true; // the usual reorganisation, the totals after it are patched
+    QTest::newRow("oldest blocks") << false; // everything after changes, taken by the base alone
+}
+
+// REORG_BLOCKS blocks taken out of the series and put back, as a splice replacing them does
+void HistoryBench::seriesReorg()
+{
+    QFETCH(bool, atTop);
+    const quint32 top = wallet_->topHeight();
+    QVERIFY(top > REORG_BLOCKS);
+    const RpcApi::Transfers replaced = atTop ? blocks(top - REORG_BLOCKS, top + 1) : blocks(0, REORG_BLOCKS + 1);
+    QVector<RpcApi::Transaction> txs;
+    for (const RpcApi::Block& block : replaced.blocks)
+        for (const RpcApi::Transaction& tx : block.transactions)
+            txs << tx;
+    QVERIFY(!txs.isEmpty());
+
+    const BalanceSeries::Totals total = series_.total();
+    QBENCHMARK
+    {
+        for (const RpcApi::Transaction& tx : txs)
+            series_.remove(tx.hash);
+        for (const RpcApi::Transaction& tx : txs)
+            series_.add(tx);
+    }
+    QCOMPARE(series_.total().net, total.net);
+    QCOMPARE(series_.total().count, total.count);
+}
+
+void HistoryBench::coalescing_data()
+{
+    QTest::addColumn<int>("interval");
+    QTest::newRow("every update") << 0; // as before the scheduler
+    QTest::newRow("once a frame") << FRAME_MSEC;
+}
+
+// BURST_UPDATES status and balance changes in a row over the whole history, the number of dataChanged
+// a view gets for them is the result
+void HistoryBench::coalescing()
+{
+    QFETCH(int, interval);
+    RpcApi::Status status = RpcApi::Status::fromJson(wallet_->status());
+    RpcApi::Balance balance = RpcApi::Balance::fromJson(wallet_->balance());
+
+    // The first status repaints the unlock times of the rows still locked, that is not what is measured
+    model_->setUpdateInterval(0);
+    model_->statusReceived(status);
+    model_->balanceReceived(balance);
+    model_->setUpdateInterval(interval);
+
+    int emitted = 0;
+    const QMetaObject::Connection connection = connect(model_.get(), &QAbstractItemModel::dataChanged, [&emitted]() { ++emitted; });
+    const quint64 merged = model_->getMergedUpdates();
+    QElapsedTimer timer;
+    timer.start();
+    for (int i = 0; i < BURST_UPDATES; ++i)
+    {
+        ++status.incoming_peer_count;
+        model_->statusReceived(status);
+        ++balance.spendable;
+        model_->balanceReceived(balance);
+    }
+    QTRY_VERIFY(emitted > 0); // once a frame goes by
+    const qint64 elapsed = timer.elapsed();
+    disconnect(connection);
+    model_->setUpdateInterval(FRAME_MSEC);
+
+    QTest::setBenchmarkResult(emitted, QTest::Events);
+    qDebug("%d updates gave %d dataChanged in %lld ms, %llu merged.",
+           2 * BURST_UPDATES, emitted, elapsed, model_->getMergedUpdates() - merged);
+}
+
+void HistoryBench::search_data()
+{
+    QTest::addColumn<QString>("by");
+    QTest::newRow("hash prefix") << QStringLiteral("hash");
+    QTest::newRow("block hash") << QStringLiteral("block");
+    QTest::newRow("payment id") << QStringLiteral("payment id"); // none in the synthetic history, a miss
+    QTest::newRow("address") << QStringLiteral("address");
+    QTest::newRow("amount range") << QStringLiteral("amount");
+    QTest::newRow("hash prefix in heights") << QStringLiteral("hash in heights");
+}
+
+// A search over the whole history as the filter box makes it, for a transaction from the middle of it,
+// which is in the store
+void HistoryBench::search()
+{
+    QFETCH(QString, by);
+    const quint32 middle = wallet_->topHeight() / 2;
+    const RpcApi::Transfers around = blocks(middle, middle + 100);
+    RpcApi::Transaction tx;
+    RpcApi::Address foreign;
+    for (const RpcApi::Block& block : around.blocks)
+        for (const RpcApi::Transaction& candidate : block.transactions)
+            for (const RpcApi::Transfer& tr : candidate.transfers)
+                if (!tr.ours && foreign.isEmpty())
+                {
+                    tx = candidate;
+                    foreign = tr.address;
+                }
+    QVERIFY(!foreign.isEmpty());
+
+    TxIndex::Query query;
+    if (by == QLatin1String("hash") || by == QLatin1String("hash in heights"))
+        query.text = tx.hash.toHex().left(SEARCH_PREFIX);
+    else if (by == QLatin1String("block"))
+        query.text = tx.block_hash.toHex();
+    else if (by == QLatin1String("payment id"))
+        query.text = QStringLiteral("payment");
+    else if (by == QLatin1String("address"))
+        query.text = foreign.toString();
+    else
+    {
+        query.minAmount = TxIndex::amountOf(tx);
+        query.maxAmount = query.minAmount;
+    }
+    if (by == QLatin1String("hash in heights"))
+    {
+        query.minHeight = middle;
+        query.maxHeight = middle + 100;
+    }
+
+    QVector<int> rows;
+    QBENCHMARK
+    {
+        rows = model_->findHistoryRows(query);
+    }
+    if (by != QLatin1String("payment id"))
+        QVERIFY(!rows.isEmpty());
+    qDebug("%d rows found.", rows.size());
+}
+
+}
+
+QTEST_GUILESS_MAIN(WalletGUI::HistoryBench)
+
+#include "HistoryBench.moc"
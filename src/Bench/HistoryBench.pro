@@ -0,0 +1,20 @@
+# history-bench: the history at a million transactions over a synthetic wallet
+
+QT       += core gui network widgets testlib
+
+TARGET = history-bench
+TEMPLATE = app
+
+CONFIG += c++14 strict_c++ console
+CONFIG -= app_bundle
+!win32: QMAKE_CXXFLAGS += -std=c++14 -Wall -Wextra -pedantic
+DEFINES += QT_FORCE_ASSERTS
+
+DESTDIR = $$PWD/../../bin
+
+include(../bytecoin-gui.pri)
+
+SOURCES += HistoryBench.cpp \
+    ../MockWalletd/SyntheticWallet.cpp
+
+HEADERS += ../MockWalletd/SyntheticWallet.h
@@ -0,0 +1,462 @@
+// Copyright (c) 2015-2018, The Bytecoin developers.
+// Licensed under the GNU Lesser General Public License. See LICENSE for details.
+
+#include <atomic>
+#include <cstdlib>
+#include <limits>
+#include <memory>
+#include <new>
+
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QtTest>
+
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+
+#include "JsonRpc/JsonRpcClient.h"
+#include "JsonRpc/JsonRpcEncoder.h"
+#include "JsonRpc/JsonRpcRequest.h"
+#include "JsonRpc/JsonRpcResponse.h"
+#include "MockWalletd/SyntheticWallet.h"
+#include "addresspool.h"
+#include "rpcapi.h"
+
+// Calls to operator new, for the allocations of the reply path. Qt containers take their data from
+// malloc() and are not counted, which leaves the shared_ptr and std::function overhead of a reply.
+static std::atomic<quint64> operatorNewCalls{0};
+
+void* operator new(std::size_t size)
+{
+    ++operatorNewCalls;
+    if (void* p = std::malloc(size == 0 ? 1 : size))
+        return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+namespace WalletGUI
+{
+
+namespace
+{
+
+constexpr quint32 REPLY_TRANSACTIONS = 20000; // a get_transfers reply the size that used to stall the GUI
+
+// The whole of a JSON-RPC reply as it comes off the wire
+QByteArray replyBody(const QJsonObject& result)
+{
+    QJsonObject reply;
+    reply.insert(QStringLiteral("jsonrpc"), QStringLiteral("2.0"));
+    reply.insert(QStringLiteral("id"), QStringLiteral("1"));
+    reply.insert(QStringLiteral("result"), result);
+    return QJsonDocument(reply).toJson(QJsonDocument::Compact);
+}
+
+// Bytes in use on the heap, -1 where the allocator cannot tell. Freed blocks do not count, unlike
+// the resident set, so a delta is what the objects made in between hold.
+qint64 heapBytes()
+{
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+    return static_cast<qint64>(mallinfo2().uordblks);
+#elif defined(__GLIBC__)
+    return static_cast<qint64>(static_cast<unsigned>(mallinfo().uordblks));
+#else
+    return -1;
+#endif
+}
+
+// A request body as WalletClient built it before: params as a QVariantMap, the request as a QJsonObject
+template<typename Request>
+void encodeViaVariantMap(const char* method, const Request& req, quint64 id, QByteArray& body)
+{
+    JsonRpc::JsonRpcRequest request;
+    request.setId(QString::number(id));
+    request.setMethod(QString::fromLatin1(method));
+    request.setParamsFromObject(req.toJson());
+    body = request.toString();
+}
+
+// And as it does now: a prefix made once per method, params written into a buffer kept between calls
+template<typename Request>
+void encodeViaWriter(const QByteArray& prefix, const Request& req, quint64 id, QByteArray& params, QByteArray& body)
+{
+    params.resize(0);
+    {
+        JsonRpc::JsonWriter writer(params);
+        req.writeJson(writer);
+    }
+    body.resize(0);
+    body += prefix;
+    body += params;
+    JsonRpc::JsonWriter::appendRequestId(body, id);
+}
+
+// WalletClient's reply path, decoder then handler, on one thread here
+struct ReplyPath : JsonRpc::WalletClient
+{
+    template<typename APIFunction, typename SuccessHandler>
+    static FunctionHandler handler(SuccessHandler successHandler)
+    {
+        auto errorHandler = [](const QString& /*id*/, const JsonRpc::Error& /*error*/) { QFAIL("Error reply."); };
+        return ResponseDispatcher<APIFunction, SuccessHandler, decltype(errorHandler)>{std::move(successHandler), errorHandler};
+    }
+
+    template<typename APIFunction>
+    static Decoded decode(const JsonRpc::JsonRpcResponse& response)
+    {
+        return decodeResponse<APIFunction>(response);
+    }
+};
+
+// Operator new calls per reply: through the reply path, and for the bare Response::fromJson()
+template<typename APIFunction>
+void countAllocations(const QJsonObject& result, double& perReply, double& perDecode)
+{
+    constexpr int REPLIES = 10000;
+    const JsonRpc::JsonRpcResponse response(QJsonDocument::fromJson(replyBody(result)).object());
+    int handled = 0;
+    const JsonRpc::Client::FunctionHandler handler = ReplyPath::handler<APIFunction>(
+                [&handled](const QString& /*id*/, const typename APIFunction::Response& /*response*/) { ++handled; });
+
+    quint64 before = operatorNewCalls;
+    for (int i = 0; i < REPLIES; ++i)
+        handler(ReplyPath::decode<APIFunction>(response));
+    perReply = double(operatorNewCalls - before) / REPLIES;
+    QCOMPARE(handled, REPLIES);
+
+    before = operatorNewCalls;
+    for (int i = 0; i < REPLIES; ++i)
+        APIFunction::Response::fromJson(response.getResultAsJsonObject());
+    perDecode = double(operatorNewCalls - before) / REPLIES;
+}
+
+}
+
+// Decoding and encoding of walletd calls, old path against new, over replies of mock-walletd's SyntheticWallet
+class RpcBench : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+
+    void decodeTransfers_data();
+    void decodeTransfers();
+
+    void encodeRequest_data();
+    void encodeRequest();
+
+    void hashMemory_data();
+    void hashMemory();
+
+    void addressMemory_data();
+    void addressMemory();
+    void recipients_data();
+    void recipients();
+
+    void dispatch_data();
+    void dispatch();
+
+private:
+    std::unique_ptr<MockWalletd::SyntheticWallet> wallet_;
+    QByteArray transfersReply_; // REPLY_TRANSACTIONS in one get_transfers reply
+    qint64 hexHashBytes_ = 0; // per transaction, for hashMemory to compare against
+    qint64 textAddressBytes_ = 0; // per transfer, for addressMemory
+    int textRecipients_ = -1; // found by the QString row of recipients, the Address row finds as many
+};
+
+void RpcBench::initTestCase()
+{
+    MockWalletd::SyntheticWallet::Params params;
+    params.transactionCount = REPLY_TRANSACTIONS;
+    wallet_.reset(new MockWalletd::SyntheticWallet(params));
+    transfersReply_ = replyBody(wallet_->transfers(0, wallet_->topHeight() + 1, false, std::numeric_limits<quint32>::max()));
+    qDebug("get_transfers reply of %u transactions, %d bytes.", wallet_->transactionCount(), transfersReply_.size());
+}
+
+void RpcBench::decodeTransfers_data()
+{
+    QTest::addColumn<bool>("viaVariantMap");
+    QTest::newRow("QVariantMap") << true; // as JsonRpcResponse::getResultAsObject() handed it over before
+    QTest::newRow("QJsonObject") << false;
+}
+
+// From the reply bytes to RpcApi::Transfers, parsing included as both paths pay for it
+void RpcBench::decodeTransfers()
+{
+    QFETCH(bool, viaVariantMap);
+    RpcApi::Transfers transfers;
+    QBENCHMARK
+    {
+        const QJsonObject result = QJsonDocument::fromJson(transfersReply_).object().value(QStringLiteral("result")).toObject();
+        transfers = viaVariantMap ? RpcApi::Transfers::fromJson(result.toVariantMap()) : RpcApi::Transfers::fromJson(result);
+    }
+
+    int count = 0;
+    for (const RpcApi::Block& block : transfers.blocks)
+        count += block.transactions.size();
+    QCOMPARE(count, static_cast<int>(wallet_->transactionCount()));
+}
+
+void RpcBench::encodeRequest_data()
+{
+    QTest::addColumn<QString>("method");
+    QTest::addColumn<bool>("viaVariantMap");
+    QTest::newRow("get_status, QVariantMap") << QString::fromLatin1(RpcApi::GetStatus::METHOD) << true;
+    QTest::newRow("get_status, JsonWriter") << QString::fromLatin1(RpcApi::GetStatus::METHOD) << false;
+    QTest::newRow("get_transfers, QVariantMap") << QString::fromLatin1(RpcApi::GetTransfers::METHOD) << true;
+    QTest::newRow("get_transfers, JsonWriter") << QString::fromLatin1(RpcApi::GetTransfers::METHOD) << false;
+}
+
+// One request body per iteration, as polling sends them, with the params the GUI has while synced
+void RpcBench::encodeRequest()
+{
+    QFETCH(QString, method);
+    QFETCH(bool, viaVariantMap);
+
+    const RpcApi::Status status = RpcApi::Status::fromJson(wallet_->status());
+    RpcApi::GetStatus::Request statusRequest;
+    statusRequest.top_block_hash = status.top_block_hash;
+    statusRequest.transaction_pool_version = status.transaction_pool_version;
+    statusRequest.outgoing_peer_count = status.outgoing_peer_count;
+    statusRequest.incoming_peer_count = status.incoming_peer_count;
+    statusRequest.lower_level_error = status.lower_level_error;
+    RpcApi::GetTransfers::Request transfersRequest;
+    transfersRequest.from_height = wallet_->topHeight() - 10;
+
+    const bool isStatus = method == QLatin1String(RpcApi::GetStatus::METHOD);
+    const QByteArray prefix = JsonRpc::JsonWriter::requestPrefix(method);
+    QByteArray params;
+    QByteArray body;
+    quint64 id = 0;
+    QBENCHMARK
+    {
+        ++id;
+        if (isStatus)
+        {
+            if (viaVariantMap)
+                encodeViaVariantMap(RpcApi::GetStatus::METHOD, statusRequest, id, body);
+            else
+                encodeViaWriter(prefix, statusRequest, id, params, body);
+        }
+        else
+        {
+            if (viaVariantMap)
+                encodeViaVariantMap(RpcApi::GetTransfers::METHOD, transfersRequest, id, body);
+            else
+                encodeViaWriter(prefix, transfersRequest, id, params, body);
+        }
+    }
+
+    // Both paths send the same request
+    QByteArray reference;
+    if (isStatus)
+        encodeViaVariantMap(RpcApi::GetStatus::METHOD, statusRequest, id, reference);
+    else
+        encodeViaVariantMap(RpcApi::GetTransfers::METHOD, transfersRequest, id, reference);
+    QCOMPARE(QJsonDocument::fromJson(body).object(), QJsonDocument::fromJson(reference).object());
+}
+
+void RpcBench::hashMemory_data()
+{
+    QTest::addColumn<bool>("asHex");
+    QTest::newRow("hex QString") << true; // as RpcApi::Hash was before Hash32
+    QTest::newRow("Hash32") << false;
+}
+
+// Heap taken by the five hashes of every transaction in the reply: hash, prefix, inputs, public key and block hash
+void RpcBench::hashMemory()
+{
+    QFETCH(bool, asHex);
+    if (heapBytes() < 0)
+        QSKIP("Heap usage is only read from glibc.");
+
+    const RpcApi::Transfers transfers = RpcApi::Transfers::fromJson(
+                QJsonDocument::fromJson(transfersReply_).object().value(QStringLiteral("result")).toObject());
+    QVector<QString> hex;
+    QVector<RpcApi::Hash32> raw;
+    const int count = static_cast<int>(wallet_->transactionCount());
+    const qint64 before = heapBytes();
+    if (asHex)
+        hex.reserve(5 * count);
+    else
+        raw.reserve(5 * count);
+    for (const RpcApi::Block& block : transfers.blocks)
+        for (const RpcApi::Transaction& tx : block.transactions)
+        {
+            for (const RpcApi::Hash32* hash : {&tx.hash, &tx.prefix_hash, &tx.inputs_hash, &tx.public_key, &tx.block_hash})
+            {
+                if (asHex)
+                    hex << hash->toHex(); // a string of its own, as the decoder made one per field
+                else
+                    raw << *hash;
+            }
+        }
+    const qint64 perTransaction = (heapBytes() - before) / count;
+    QTest::setBenchmarkResult(perTransaction, QTest::BytesAllocated);
+
+    if (asHex)
+        hexHashBytes_ = perTransaction;
+    else if (hexHashBytes_ > 0)
+    {
+        qDebug("Hashes of a transaction: %lld bytes as hex, %lld as Hash32, %.1fx less.",
+               hexHashBytes_, perTransaction, double(hexHashBytes_) / qMax<qint64>(perTransaction, 1));
+        QVERIFY(perTransaction * 5 <= hexHashBytes_);
+    }
+}
+
+
+void RpcBench::addressMemory_data()
+{
+    QTest::addColumn<bool>("asText");
+    QTest::newRow("QString") << true; // a copy per transfer, as the decoder made before the pool
+    QTest::newRow("Address") << false;
+}
+
+// Heap taken by the address of every transfer in the reply. The pool holds each distinct address once
+// on top of that, a few hundred strings for the whole history.
+void RpcBench::addressMemory()
+{
+    QFETCH(bool, asText);
+    if (heapBytes() < 0)
+        QSKIP("Heap usage is only read from glibc.");
+
+    const RpcApi::Transfers transfers = RpcApi::Transfers::fromJson(
+                QJsonDocument::fromJson(transfersReply_).object().value(QStringLiteral("result")).toObject());
+    QVector<QString> text;
+    QVector<RpcApi::Address> handles;
+    int count = 0;
+    for (const RpcApi::Block& block : transfers.blocks)
+        for (const RpcApi::Transaction& tx : block.transactions)
+            count += tx.transfers.size();
+
+    const qint64 before = heapBytes();
+    if (asText)
+        text.reserve(count);
+    else
+        handles.reserve(count);
+    for (const RpcApi::Block& block : transfers.blocks)
+        for (const RpcApi::Transaction& tx : block.transactions)
+            for (const RpcApi::Transfer& tr : tx.transfers)
+            {
+                if (asText)
+                {
+                    const QString address = tr.address.toString();
+                    text << QString(address.unicode(), address.size()); // not shared with the pool
+                }
+                else
+                    handles << tr.address;
+            }
+    const qint64 perTransfer = (heapBytes() - before) / qMax(count, 1);
+    QTest::setBenchmarkResult(perTransfer, QTest::BytesAllocated);
+
+    if (asText)
+        textAddressBytes_ = perTransfer;
+    else
+        qDebug("Address of a transfer: %lld bytes as QString, %lld as Address, %d addresses pooled.",
+               textAddressBytes_, perTransfer, RpcApi::Address::poolSize());
+}
+
+void RpcBench::recipients_data()
+{
+    QTest::addColumn<bool>("asText");
+    QTest::newRow("QString") << true;
+    QTest::newRow("Address") << false;
+}
+
+// ROLE_RECIPIENTS over every transaction of the reply: the addresses paid that are not ours, each once
+void RpcBench::recipients()
+{
+    QFETCH(bool, asText);
+    const RpcApi::Transfers transfers = RpcApi::Transfers::fromJson(
+                QJsonDocument::fromJson(transfersReply_).object().value(QStringLiteral("result")).toObject());
+    QVector<QStringList> textTransfers; // the addresses as text, made before the run as the decoder did
+    if (asText)
+        for (const RpcApi::Block& block : transfers.blocks)
+            for (const RpcApi::Transaction& tx : block.transactions)
+            {
+                QStringList addresses;
+                for (const RpcApi::Transfer& tr : tx.transfers)
+                    addresses << (tr.ours ? QString() : tr.address.toString());
+                textTransfers << addresses;
+            }
+
+    int found = 0;
+    QBENCHMARK
+    {
+        found = 0;
+        if (asText)
+        {
+            for (const QStringList& addresses : textTransfers)
+            {
+                QStringList seen;
+                for (const QString& address : addresses)
+                    if (!address.isEmpty() && !seen.contains(address))
+                        seen << address;
+                found += seen.size();
+            }
+        }
+        else
+        {
+            for (const RpcApi::Block& block : transfers.blocks)
+                for (const RpcApi::Transaction& tx : block.transactions)
+                {
+                    QVector<RpcApi::Address> seen;
+                    QStringList addresses;
+                    for (const RpcApi::Transfer& tr : tx.transfers)
+                    {
+                        if (tr.ours || seen.contains(tr.address))
+                            continue;
+                        seen << tr.address;
+                        addresses << tr.address.toString();
+                    }
+                    found += addresses.size();
+                }
+        }
+    }
+
+    if (asText)
+        textRecipients_ = found;
+    else if (textRecipients_ >= 0)
+        QCOMPARE(found, textRecipients_);
+}
+
+void RpcBench::dispatch_data()
+{
+    QTest::addColumn<QString>("method");
+    QTest::newRow("get_status") << QString::fromLatin1(RpcApi::GetStatus::METHOD); // the reply every poll gets
+    QTest::newRow("get_balance") << QString::fromLatin1(RpcApi::GetBalance::METHOD);
+}
+
+// Allocations the reply path adds to decoding the result, the decoded response it hands on included
+void RpcBench::dispatch()
+{
+    QFETCH(QString, method);
+    double perReply = 0;
+    double perDecode = 0;
+    if (method == QLatin1String(RpcApi::GetStatus::METHOD))
+        countAllocations<RpcApi::GetStatus>(wallet_->status(), perReply, perDecode);
+    else
+        countAllocations<RpcApi::GetBalance>(wallet_->balance(), perReply, perDecode);
+    qDebug("%s: %.1f operator new calls per reply, %.1f of them decoding the result.", qPrintable(method), perReply, perDecode);
+    QTest::setBenchmarkResult(perReply - perDecode, QTest::Events);
+    // The decoded response in one make_shared, the handlers are not copied per reply
+    QVERIFY(perReply - perDecode <= 1.0);
+}
+
+}
+
+QTEST_GUILESS_MAIN(WalletGUI::RpcBench)
+
+#include "RpcBench.moc"
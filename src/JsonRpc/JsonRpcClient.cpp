@@ -2,6 +2,10 @@
 // Licensed under the GNU Lesser General Public License. See LICENSE for details.
 
 #include <QAuthenticator>
+#include <QDateTime>
+#include <QSet>
+
+#include <algorithm>
 
 #include "JsonRpcClient.h"
 #include "common.h"
@@ -13,6 +17,14 @@ namespace JsonRpc
 {
 
 constexpr char DEFAULT_RPC_PATH[] = "/json_rpc";
+constexpr int DEFAULT_TIMEOUT_MSEC = 30000;
+constexpr int MAX_REQUEST_ID_SUFFIX_SIZE = 32; // ,"id":"<up to 20 digits>"}
+constexpr int PARAMS_BUFFER_SIZE = 512; // fits the params of every polling call
+constexpr int MAX_PENDING_REQUESTS = 1000;
+constexpr int COMPRESS_REQUEST_MIN_SIZE = 4 * 1024; // smaller bodies gain nothing from deflate
+constexpr int QCOMPRESS_HEADER_SIZE = 4; // qCompress prepends the uncompressed size to a zlib stream
+constexpr int HTTP_BAD_REQUEST = 400;
+constexpr int JSON_RPC_INVALID_REQUEST = -32600;
 
 Client::Client(const QUrl& url, QObject* parent)
     : Client(parent)
@@ -29,8 +41,23 @@ Client::Client(const QString& endPoint, QObject* parent)
 Client::Client(QObject* parent)
     : QObject(parent)
     , httpClient_(new QNetworkAccessManager(this))
+    , defaultTimeout_(DEFAULT_TIMEOUT_MSEC)
+    , batchSupported_(true)
     , idCount_(0)
+    , sentCount_(0)
+    , coalescedCount_(0)
+    , wholeStreamedPackets_(false)
+    , compression_(AcceptCompressed)
+    , requestBytesSaved_(0)
+    , responseBytesSaved_(0)
+    , decodeQueue_(this)
 {
+    clock_.start();
+    deadlineTimer_.setSingleShot(true);
+    connect(&deadlineTimer_, &QTimer::timeout, this, &Client::deadlineReached);
+    batchTimer_.setSingleShot(true);
+    batchTimer_.setInterval(0); // collects everything requested before control returns to the event loop
+    connect(&batchTimer_, &QTimer::timeout, this, &Client::flushBatch);
     connect(httpClient_, &QNetworkAccessManager::finished, this, &Client::replyFinished);
     connect(httpClient_, &QNetworkAccessManager::authenticationRequired, this, &Client::authenticationRequired);
 }
@@ -50,12 +77,219 @@ void Client::setUrl(const QUrl& url)
     url_ = url;
 }
 
-void Client::insertResponseHandler(const QString& id, FunctionHandler&& handler)
+void Client::setDefaultTimeout(int msec)
+{
+    defaultTimeout_ = msec;
+}
+
+void Client::setMethodTimeout(const QString& method, int msec)
+{
+    methodTimeouts_.insert(method, msec);
+}
+
+int Client::pendingRequestCount() const
+{
+    return pending_.size();
+}
+
+quint64 Client::sentRequestCount() const
+{
+    return sentCount_;
+}
+
+quint64 Client::coalescedRequestCount() const
+{
+    return coalescedCount_;
+}
+
+void Client::setCompression(CompressionFlags flags)
+{
+    compression_ = flags;
+}
+
+quint64 Client::requestBytesSaved() const
+{
+    return requestBytesSaved_;
+}
+
+quint64 Client::responseBytesSaved() const
+{
+    return responseBytesSaved_;
+}
+
+void Client::resetBatchSupport()
+{
+    batchSupported_ = true;
+}
+
+void Client::setWholeStreamedPackets(bool whole)
+{
+    wholeStreamedPackets_ = whole;
+}
+
+StatsSnapshot Client::statistics() const
+{
+    return stats_;
+}
+
+void Client::resetStatistics()
+{
+    stats_.clear();
+}
+
+bool Client::event(QEvent* event)
+{
+    return DecodeQueue::deliver(event) || QObject::event(event);
+}
+
+Client::RequestId Client::insertResponseHandler(const QString& method, ResponseDecoder&& decoder, FunctionHandler&& handler, RequestFlags flags)
+{
+    const RequestId id = idCount_++;
+    PendingRequest& pending = pending_[id];
+    pending.decoder = std::move(decoder);
+    pending.handler = std::move(handler);
+    pending.method = method;
+
+    const int timeout = flags.testFlag(NoTimeout) ? 0 : methodTimeouts_.value(method, defaultTimeout_);
+    if (timeout > 0)
+    {
+        pending.timeout = timeout;
+        pending.deadline = clock_.elapsed() + timeout;
+        deadlines_.insert(pending.deadline, id);
+        scheduleDeadline();
+    }
+
+    if (pending_.size() > MAX_PENDING_REQUESTS)
+    {
+        qDebug("[JsonRpcClient] Too many pending requests, dropping the oldest one (%llu).", pending_.firstKey());
+        removePending(pending_.firstKey(), true);
+    }
+    return id;
+}
+
+bool Client::cancelRequest(RequestId id)
+{
+    const auto it = pending_.find(id);
+    if (it == pending_.end() || !it.value().handler)
+        return false;
+    if (!it.value().isFollower && !it.value().followers.isEmpty())
+    {
+        // Others still wait for this call, only forget about our own handlers
+        it.value().handler = FunctionHandler();
+        it.value().itemHandler = ItemHandler();
+        return true;
+    }
+    removePending(id, true);
+    return true;
+}
+
+void Client::removePending(RequestId id, bool abortReply)
+{
+    const auto it = pending_.find(id);
+    if (it == pending_.end())
+        return;
+    const PendingRequest pending = it.value();
+    pending_.erase(it);
+
+    if (pending.isFollower)
+    {
+        const auto lit = pending_.find(pending.leader);
+        if (lit != pending_.end())
+        {
+            lit.value().followers.removeOne(id);
+            if (lit.value().followers.isEmpty() && !lit.value().handler)
+                removePending(pending.leader, abortReply); // the cancelled leader was kept for us only
+        }
+        return;
+    }
+
+    for (const RequestId followerId : pending.followers)
+        pending_.remove(followerId);
+    if (!pending.coalesceKey.isEmpty() && inFlight_.value(pending.coalesceKey) == id)
+        inFlight_.remove(pending.coalesceKey);
+
+    if (pending.deadline != 0)
+    {
+        deadlines_.remove(pending.deadline, id);
+        scheduleDeadline();
+    }
+
+    if (pending.reply == nullptr)
+    {
+        for (auto bit = batch_.begin(); bit != batch_.end(); ++bit)
+            if (bit->id == id)
+            {
+                batch_.erase(bit);
+                break;
+            }
+        return;
+    }
+
+    const auto rit = replyRequests_.find(pending.reply);
+    if (rit == replyRequests_.end())
+        return;
+    rit.value().removeOne(id);
+    // Nobody waits for this reply anymore
+    if (rit.value().isEmpty() && abortReply)
+    {
+        replyRequests_.erase(rit);
+        pending.reply->abort();
+    }
+}
+
+void Client::scheduleDeadline()
 {
-    Q_ASSERT(!responseHandlers_.contains(id));
-    responseHandlers_.insert(id, std::move(handler));
-    if (responseHandlers_.size() > 1000)
-        responseHandlers_.erase(responseHandlers_.begin());
+    if (deadlines_.isEmpty())
+    {
+        deadlineTimer_.stop();
+        return;
+    }
+    deadlineTimer_.start(static_cast<int>(qMax<qint64>(0, deadlines_.firstKey() - clock_.elapsed())));
+}
+
+void Client::deadlineReached()
+{
+    const qint64 now = clock_.elapsed();
+    QList<RequestId> expired;
+    for (auto it = deadlines_.constBegin(); it != deadlines_.constEnd() && it.key() <= now; ++it)
+        expired << it.value();
+
+    // A batch carries many calls and coalesced ones wait for the same answer, a reply is one failure
+    QSet<QNetworkReply*> reported;
+    for (const RequestId id : expired)
+    {
+        const auto it = pending_.constFind(id);
+        if (it == pending_.constEnd())
+            continue; // cancelled by a handler of the ones before
+        const PendingRequest& pending = it.value();
+        const QString method = pending.method;
+        // A cancelled leader is only kept for its followers, one of them is told instead
+        const RequestId reportedId = pending.handler || pending.followers.isEmpty() ? id : pending.followers.first();
+        const bool report = (pending.handler || !pending.followers.isEmpty()) && !reported.contains(pending.reply);
+        if (report)
+            reported.insert(pending.reply);
+        qDebug("[JsonRpcClient] Request %llu (%s) timed out.", id, qPrintable(method));
+        removePending(id, true);
+        if (report)
+            emit requestTimedOut(reportedId, method);
+    }
+    scheduleDeadline();
+}
+
+// A reply still coming in is not hung, its calls get their whole timeout again from its last bytes
+void Client::extendDeadlines(QNetworkReply* reply)
+{
+    const qint64 now = clock_.elapsed();
+    for (const RequestId id : replyRequests_.value(reply))
+    {
+        const auto it = pending_.find(id);
+        if (it == pending_.end() || it.value().deadline == 0)
+            continue;
+        deadlines_.remove(it.value().deadline, id);
+        it.value().deadline = now + it.value().timeout;
+        deadlines_.insert(it.value().deadline, id);
+    }
+    scheduleDeadline();
 }
 
 //template<typename... Ts>
@@ -71,7 +305,7 @@ void Client::insertResponseHandler(const QString& id, FunctionHandler&& handler)
 //    return req.getId();
 //}
 
-/*QString*/ void Client::sendRequest(const QString& method, const QVariantMap& json, FunctionHandler&& handler)
+/*QString*/ Client::RequestId Client::sendRequest(const QString& method, const QVariantMap& json, ResponseDecoder&& decoder, FunctionHandler&& handler, RequestFlags flags)
 {
 //    JsonRpcRequest req;
 //    req.setId(QString::number(idCount_++));
@@ -82,15 +316,219 @@ void Client::insertResponseHandler(const QString& id, FunctionHandler&& handler)
 
 //    return req.getId();
 
-    const QString id = QString::number(idCount_++);
-    JsonRpcRequest req;
-    req.setId(id);
-    req.setMethod(method);
-    req.setParamsFromObject(json);
+    return enqueue(method, JsonWriter::requestPrefix(method), encodeParams(json), QList<QByteArray>(), ItemDecoder(), ItemHandler(), std::move(decoder), std::move(handler), flags);
+}
+
+Client::RequestId Client::sendRequest(const QString& method, const QByteArray& prefix, const QByteArray& params, ResponseDecoder&& decoder, FunctionHandler&& handler, RequestFlags flags)
+{
+    return enqueue(method, prefix, params, QList<QByteArray>(), ItemDecoder(), ItemHandler(), std::move(decoder), std::move(handler), flags);
+}
+
+Client::RequestId Client::sendStreamingRequest(const QString& method, const QVariantMap& json, const QString& arrayName, ItemDecoder&& itemDecoder, ItemHandler&& itemHandler, ResponseDecoder&& decoder, FunctionHandler&& handler, RequestFlags flags)
+{
+    return sendStreamingRequest(method, JsonWriter::requestPrefix(method), encodeParams(json), arrayName, std::move(itemDecoder), std::move(itemHandler), std::move(decoder), std::move(handler), flags);
+}
+
+Client::RequestId Client::sendStreamingRequest(const QString& method, const QByteArray& prefix, const QByteArray& params, const QString& arrayName, ItemDecoder&& itemDecoder, ItemHandler&& itemHandler, ResponseDecoder&& decoder, FunctionHandler&& handler, RequestFlags flags)
+{
+    const QList<QByteArray> arrayPath{QByteArrayLiteral("result"), arrayName.toUtf8()};
+    return enqueue(method, prefix, params, arrayPath, std::move(itemDecoder), std::move(itemHandler), std::move(decoder), std::move(handler), flags);
+}
+
+/*static*/
+QByteArray Client::encodeParams(const QVariantMap& json)
+{
+    return QJsonDocument(QJsonObject::fromVariantMap(json)).toJson(QJsonDocument::Compact);
+}
+
+Client::RequestId Client::enqueue(const QString& method, const QByteArray& prefix, const QByteArray& params, const QList<QByteArray>& streamPath, ItemDecoder&& itemDecoder, ItemHandler&& itemHandler, ResponseDecoder&& decoder, FunctionHandler&& handler, RequestFlags flags)
+{
+    QByteArray coalesceKey;
+    if (flags.testFlag(Coalesce))
+    {
+        coalesceKey = prefix + params; // the prefix names the method
+        const auto lit = inFlight_.constFind(coalesceKey);
+        if (lit != inFlight_.constEnd() && !pending_.value(lit.value()).streaming)
+        {
+            const RequestId leaderId = lit.value();
+            const RequestId id = idCount_++;
+            PendingRequest& follower = pending_[id];
+            follower.handler = std::move(handler);
+            follower.itemHandler = std::move(itemHandler);
+            follower.method = method;
+            follower.leader = leaderId;
+            follower.isFollower = true;
+            pending_[leaderId].followers << id;
+
+            ++coalescedCount_;
+            qDebug("[JsonRpcClient] %s joined request %llu in flight, %llu of %llu calls coalesced.",
+                   qPrintable(method), leaderId, coalescedCount_, coalescedCount_ + sentCount_);
+            return id;
+        }
+    }
+
+    const RequestId id = insertResponseHandler(method, std::move(decoder), std::move(handler), flags);
+    PendingRequest& pending = pending_[id];
+    pending.itemDecoder = std::move(itemDecoder);
+    pending.itemHandler = std::move(itemHandler);
+    if (!coalesceKey.isEmpty())
+    {
+        pending.coalesceKey = coalesceKey;
+        inFlight_.insert(coalesceKey, id);
+    }
+
+    // Sized up front, so the whole request costs one allocation
+    QByteArray json;
+    json.reserve(prefix.size() + params.size() + MAX_REQUEST_ID_SUFFIX_SIZE);
+    json += prefix;
+    json += params;
+    JsonWriter::appendRequestId(json, id);
+
+    ++sentCount_;
+    post(OutgoingRequest{id, json, streamPath}, flags);
+    return id;
+}
+
+void Client::post(OutgoingRequest&& request, RequestFlags flags)
+{
+    if (flags.testFlag(NoBatch) || !batchSupported_)
+    {
+        postBatch(QList<OutgoingRequest>{std::move(request)});
+        return;
+    }
+
+    // The stream reader follows one array per reply, so a batch carries at most one streamed request
+    const auto isStreamed = [](const OutgoingRequest& r) { return !r.streamPath.isEmpty(); };
+    if (isStreamed(request) && std::any_of(batch_.cbegin(), batch_.cend(), isStreamed))
+        flushBatch();
+
+    batch_.append(std::move(request));
+    if (!batchTimer_.isActive())
+        batchTimer_.start();
+}
+
+void Client::flushBatch()
+{
+    batchTimer_.stop();
+    if (batch_.isEmpty())
+        return;
+    QList<OutgoingRequest> batch;
+    batch.swap(batch_);
+    postBatch(batch);
+}
+
+void Client::postBatch(const QList<OutgoingRequest>& batch)
+{
+    Q_ASSERT(!batch.isEmpty());
+    QByteArray json;
+    if (batch.size() == 1)
+        json = batch.first().json;
+    else
+    {
+        json += '[';
+        for (const OutgoingRequest& request : batch)
+        {
+            if (json.size() > 1)
+                json += ',';
+            json += request.json;
+        }
+        json += ']';
+    }
+
+    QNetworkReply* reply = sendJson(json);
+    if (batch.size() > 1)
+        batchReplies_.insert(reply, batch);
+
+    QList<RequestId>& ids = replyRequests_[reply];
+    ReplyDecoding& decoding = replyDecodings_[reply];
+    for (const OutgoingRequest& request : batch)
+    {
+        PendingRequest& pending = pending_[request.id];
+        pending.reply = reply;
+        ids << request.id;
+        decoding.methods << pending.method;
+        decoding.requestBytes << request.json.size();
+    }
+    decoding.decodeNsec = std::make_shared<qint64>(0);
+    decoding.bodyBytes = std::make_shared<qint64>(0);
+    decoding.sentMsecsSinceEpoch = QDateTime::currentMSecsSinceEpoch();
+    decoding.sentAt = clock_.nsecsElapsed() / 1000;
+    connect(reply, &QNetworkReply::readyRead, this, [this, reply]() { replyReadyRead(reply); });
 
-    insertResponseHandler(id, std::move(handler));
+    for (const OutgoingRequest& request : batch)
+    {
+        if (request.streamPath.isEmpty())
+            continue;
+        // The reader lives on the decoding thread, only finished items come back here
+        const RequestId id = request.id;
+        const ItemDecoder itemDecoder = pending_.value(id).itemDecoder;
+        DecodeQueue* decodeQueue = &decodeQueue_;
+        JsonRpcStreamReader::ItemHandler itemHandler = [this, id, itemDecoder, decodeQueue](const QJsonObject& item)
+        {
+            const Decoded decoded = itemDecoder(item);
+            decodeQueue->post([this, id, decoded]() { dispatchItem(id, decoded); });
+        };
+        decoding.reader = std::make_shared<JsonRpcStreamReader>(request.streamPath, std::move(itemHandler));
+        if (wholeStreamedPackets_)
+            decoding.wholePacket = std::make_shared<QByteArray>();
+    }
+}
 
-    sendJson(req.toString());
+void Client::replyReadyRead(QNetworkReply* reply)
+{
+    const auto it = replyDecodings_.find(reply);
+    if (it == replyDecodings_.end())
+        return;
+    ReplyDecoding& decoding = it.value();
+    if (decoding.firstByteAt < 0)
+        decoding.firstByteAt = clock_.nsecsElapsed() / 1000;
+    extendDeadlines(reply);
+    if (!decoding.reader)
+        return; // the whole reply is read when it is finished
+    // Always drain the reply, a broken stream must not pile up in the socket buffer
+    const QByteArray data = reply->readAll();
+    decoding.responseBytes += data.size();
+    if (reply->error() != QNetworkReply::NoError)
+        return;
+    checkEncoding(reply, decoding);
+    const std::shared_ptr<JsonRpcStreamReader> reader = decoding.reader;
+    const std::shared_ptr<Inflater> inflater = decoding.inflater;
+    const std::shared_ptr<QByteArray> wholePacket = decoding.wholePacket;
+    const std::shared_ptr<qint64> decodeNsec = decoding.decodeNsec;
+    const std::shared_ptr<qint64> bodyBytes = decoding.bodyBytes;
+    decodeQueue_.run([reader, inflater, wholePacket, decodeNsec, bodyBytes, data]()
+    {
+        QElapsedTimer timer;
+        timer.start();
+        const QByteArray json = inflateBody(inflater.get(), data);
+        *bodyBytes += json.size();
+        if (wholePacket)
+            wholePacket->append(json);
+        reader->feed(json);
+        *decodeNsec += timer.nsecsElapsed();
+    });
+}
+
+// The network stack is not left to inflate replies, it would hide what came over the wire
+/*static*/
+void Client::checkEncoding(QNetworkReply* reply, ReplyDecoding& decoding)
+{
+    if (decoding.encodingChecked)
+        return;
+    decoding.encodingChecked = true;
+    if (Inflater::isSupported(reply->rawHeader("Content-Encoding").trimmed().toLower()))
+        decoding.inflater = std::make_shared<Inflater>();
+}
+
+// Decoding thread
+/*static*/
+QByteArray Client::inflateBody(Inflater* inflater, const QByteArray& data)
+{
+    if (inflater == nullptr)
+        return data;
+    QByteArray json;
+    inflater->inflate(data, json);
+    return json;
 }
 
 //void Client::destroyedReply(QObject* obj)
@@ -104,55 +542,258 @@ void Client::replyFinished(QNetworkReply* reply)
     reply->deleteLater();
 //    connect(reply, &QNetworkReply::destroyed, this, &Client::destroyedReply);
 
-    const QByteArray data = reply->readAll();
+    ReplyDecoding decoding = replyDecodings_.take(reply);
+    decoding.finishedAt = clock_.nsecsElapsed() / 1000;
+    const QList<OutgoingRequest> batch = batchReplies_.take(reply);
+    const QList<RequestId> ids = replyRequests_.take(reply);
+    if (ids.isEmpty() && reply->error() == QNetworkReply::OperationCanceledError)
+        return; // aborted after all its requests were cancelled or timed out
+
     if (reply->error() != QNetworkReply::NoError)
     {
-        qDebug("[JsonRpcClient] Network error. %s", qPrintable(reply->errorString()));
-        emit networkError(reply->errorString());
+        // Other statuses (a 500, or a 503 while walletd restarts) say nothing about batches
+        if (!batch.isEmpty() && reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt() == HTTP_BAD_REQUEST)
+            resendBatch(batch);
+        else
+        {
+            qDebug("[JsonRpcClient] Network error. %s", qPrintable(reply->errorString()));
+            emit networkError(reply->errorString());
+        }
+        recordStats(decoding, true);
+        dropUnanswered(reply, ids);
         return;
     }
 
-    emit packetReceived(data);
+    // Decoders are taken now, the requests may be cancelled while the reply is decoded
+    QHash<QString, ResponseDecoder> decoders;
+    for (const RequestId id : ids)
+    {
+        const auto it = pending_.constFind(id);
+        if (it != pending_.constEnd() && it.value().decoder)
+            decoders.insert(QString::number(id), it.value().decoder);
+    }
+
+    const QByteArray data = reply->readAll();
+    decoding.responseBytes += data.size();
+    checkEncoding(reply, decoding);
+
+    const bool isBatch = !batch.isEmpty();
+    DecodeQueue* decodeQueue = &decodeQueue_;
+    decodeQueue_.run([this, decodeQueue, decoding, isBatch, decoders, data, reply, ids, batch]()
+    {
+        QElapsedTimer timer;
+        timer.start();
+        const auto result = std::make_shared<DecodedReply>();
+        const QByteArray json = inflateBody(decoding.inflater.get(), data);
+        *decoding.bodyBytes += json.size();
+        if (decoding.wholePacket)
+            decoding.wholePacket->append(json);
+        if (decoding.inflater && decoding.inflater->hasError())
+            result->errors << decoding.inflater->errorString();
+        else
+            decodeReply(*result, decoding.reader.get(), isBatch, decoders, json);
+        *decoding.decodeNsec += timer.nsecsElapsed();
+        // reply is only compared with, it is deleted by the time this runs
+        decodeQueue->post([this, result, decoding, reply, ids, batch]() { finishReply(*result, decoding, reply, ids, batch); });
+    });
+}
+
+void Client::dropUnanswered(QNetworkReply* reply, const QList<RequestId>& ids)
+{
+    // Whatever this reply did not answer will never be answered
+    for (const RequestId id : ids)
+        if (pending_.contains(id) && pending_.value(id).reply == reply)
+            removePending(id, false);
+}
+
+void Client::resendBatch(const QList<OutgoingRequest>& batch)
+{
+    qDebug("[JsonRpcClient] Batch of %d requests rejected, sending them one by one.", batch.size());
+    batchSupported_ = false;
+    for (const OutgoingRequest& request : batch)
+        if (pending_.contains(request.id))
+            postBatch(QList<OutgoingRequest>{request});
+}
+
+void Client::decodeReply(DecodedReply& result, JsonRpcStreamReader* reader, bool isBatch, const QHash<QString, ResponseDecoder>& decoders, QByteArray data)
+{
+    if (reader != nullptr)
+    {
+        if (!reader->feed(data))
+        {
+            result.errors << reader->errorString();
+            return;
+        }
+        data = reader->skeleton(); // streamed items are already delivered
+    }
+
+    result.data = data;
 
     QJsonParseError parseError;
     QJsonDocument jsonDocument = QJsonDocument::fromJson(data, &parseError);
     if (parseError.error != QJsonParseError::NoError)
     {
         qDebug("[JsonRpcClient] Parse error %s", qPrintable(parseError.errorString()));
-        emit jsonParsingError(parseError.errorString());
+        result.errors << parseError.errorString();
+        return;
+    }
+
+    if (jsonDocument.isArray())
+    {
+        const QJsonArray array = jsonDocument.array();
+        if (isBatch && array.size() == 1 && isInvalidRequestError(array.first()))
+        {
+            result.batchRejected = true; // the whole array was taken for one malformed call
+            return;
+        }
+        for (const QJsonValue& value : array)
+        {
+            if (!value.isObject())
+            {
+                qDebug("[JsonRpcClient] Batch element is not an object.");
+                result.errors << tr("JSON document is not an object.");
+                continue;
+            }
+            decodeResponse(result, value.toObject(), decoders);
+        }
         return;
     }
 
     if (!jsonDocument.isObject())
     {
         qDebug("[JsonRpcClient] JSON document is not an object.");
-        emit jsonParsingError(tr("JSON document is not an object."));
+        result.errors << tr("JSON document is not an object.");
         return;
     }
-    const QJsonObject json = jsonDocument.object();
 
+    // A server without batch support answers the whole array with a single error
+    if (isBatch)
+    {
+        result.batchRejected = true;
+        return;
+    }
+
+    decodeResponse(result, jsonDocument.object(), decoders);
+}
+
+/*static*/
+bool Client::isInvalidRequestError(const QJsonValue& value)
+{
+    const QJsonObject object = value.toObject();
+    return object.value(QStringLiteral("id")).isNull() &&
+            object.value(QStringLiteral("error")).toObject().value(QStringLiteral("code")).toInt() == JSON_RPC_INVALID_REQUEST;
+}
+
+void Client::decodeResponse(DecodedReply& result, const QJsonObject& json, const QHash<QString, ResponseDecoder>& decoders)
+{
     Error error;
     QScopedPointer<JsonRpcObject> jsonRpcObject(JsonRpcObjectFactory::createJsonRpcObject(json, error.code, error.message, error.data));
     if (jsonRpcObject.isNull())
     {
         qDebug("[JsonRpcClient] Failed to create JsonRpcObject (%d) %s:%s", error.code, qPrintable(error.message), qPrintable(error.data));
-        emit jsonParsingError(error.message);
+        result.errors << error.message;
         return;
     }
     if (jsonRpcObject->isResponse()) // error is a response too
     {
         const JsonRpcResponse& response = static_cast<JsonRpcResponse&>(*jsonRpcObject);
         const QString& id = response.getId();
-        auto it = responseHandlers_.find(id);
-        if (it == responseHandlers_.end())
+        const ResponseDecoder decoder = decoders.value(id);
+        result.responses << qMakePair(id, decoder ? decoder(response) : Decoded());
+    }
+}
+
+void Client::finishReply(const DecodedReply& result, const ReplyDecoding& decoding, QNetworkReply* reply, const QList<RequestId>& ids, const QList<OutgoingRequest>& batch)
+{
+    recordStats(decoding, false);
+    if (decoding.inflater)
+        responseBytesSaved_ += qMax<qint64>(0, *decoding.bodyBytes - decoding.responseBytes);
+
+    if (decoding.wholePacket && !decoding.wholePacket->isEmpty())
+        emit packetReceived(*decoding.wholePacket);
+    else if (!result.data.isEmpty())
+        emit packetReceived(result.data);
+    for (const QString& errorString : result.errors)
+        emit jsonParsingError(errorString);
+
+    if (result.batchRejected)
+    {
+        resendBatch(batch); // the requests are on a new reply now, nothing to drop
+        return;
+    }
+
+    for (const QPair<QString, Decoded>& response : result.responses)
+        processResponse(response.first, response.second);
+    dropUnanswered(reply, ids);
+}
+
+void Client::recordStats(const ReplyDecoding& decoding, bool failed)
+{
+    const int calls = decoding.methods.size();
+    for (int i = 0; i < calls; ++i)
+    {
+        MethodStats& stats = stats_[decoding.methods[i]];
+        stats.lastSent = qMax(stats.lastSent, decoding.sentMsecsSinceEpoch);
+        stats.requestBytes.add(decoding.requestBytes[i]);
+        if (failed)
+        {
+            ++stats.failures;
+            continue;
+        }
+        ++stats.calls;
+        stats.firstByte.add((decoding.firstByteAt >= 0 ? decoding.firstByteAt : decoding.finishedAt) - decoding.sentAt);
+        stats.finish.add(decoding.finishedAt - decoding.sentAt);
+        stats.decode.add(*decoding.decodeNsec / 1000 / calls);
+        stats.responseBytes.add(decoding.responseBytes / calls);
+    }
+}
+
+void Client::processResponse(const QString& id, const Decoded& decoded)
+{
+    bool ok = false;
+    const RequestId requestId = id.toULongLong(&ok);
+    const auto it = ok ? pending_.constFind(requestId) : pending_.constEnd();
+    if (it == pending_.constEnd())
+    {
+        if (ok && requestId < idCount_)
         {
-            qDebug("[JsonRpcClient] Cannot find handler for id '%s'.", qPrintable(id));
-            emit jsonUnknownMessageId(id);
+            qDebug("[JsonRpcClient] Dropping response for cancelled or timed out request '%s'.", qPrintable(id));
             return;
         }
-        it.value()(response);
-        responseHandlers_.erase(it);
+        qDebug("[JsonRpcClient] Cannot find handler for id '%s'.", qPrintable(id));
+        emit jsonUnknownMessageId(id);
+        return;
+    }
+    if (!decoded)
+    {
+        qDebug("[JsonRpcClient] Response '%s' came in a reply to other requests.", qPrintable(id));
+        emit jsonUnknownMessageId(id);
+        return;
     }
+    // Handlers may send new requests, so they must not be called from inside the table
+    QList<FunctionHandler> handlers;
+    if (it.value().handler)
+        handlers << it.value().handler;
+    for (const RequestId followerId : it.value().followers)
+        handlers << pending_.value(followerId).handler;
+    removePending(requestId, false);
+    for (const FunctionHandler& handler : handlers)
+        handler(decoded);
+}
+
+void Client::dispatchItem(RequestId id, const Decoded& item)
+{
+    const auto it = pending_.find(id);
+    if (it == pending_.end())
+        return;
+    it.value().streaming = true;
+    QList<ItemHandler> itemHandlers;
+    if (it.value().itemHandler)
+        itemHandlers << it.value().itemHandler;
+    for (const RequestId followerId : it.value().followers)
+        itemHandlers << pending_.value(followerId).itemHandler;
+    for (const ItemHandler& itemHandler : itemHandlers)
+        itemHandler(item);
 }
 
 void Client::authenticationRequired(QNetworkReply* /*reply*/, QAuthenticator* authenticator)
@@ -160,37 +801,60 @@ void Client::authenticationRequired(QNetworkReply* /*reply*/, QAuthenticator* au
     emit authRequiredSignal(authenticator);
 }
 
-void Client::sendJson(const QByteArray& json)
+QNetworkReply* Client::sendJson(const QByteArray& json)
 {
 //    Q_ASSERT(!url_.isEmpty());
     static const QString jsonContentType("application/json-rpc");
     static const QByteArray acceptHeaderName("Accept");
+    static const QByteArray acceptEncodingHeaderName("Accept-Encoding");
+    static const QByteArray contentEncodingHeaderName("Content-Encoding");
     QNetworkRequest request(url_);
     request.setHeader(QNetworkRequest::ContentTypeHeader, jsonContentType);
     request.setRawHeader(acceptHeaderName, jsonContentType.toLatin1());
+    // Set here, so the network stack leaves compressed replies as they are and we see their size
+    request.setRawHeader(acceptEncodingHeaderName, compression_.testFlag(AcceptCompressed) ? QByteArrayLiteral("gzip, deflate") : QByteArrayLiteral("identity"));
+
+    QByteArray body = json;
+    if (compression_.testFlag(CompressRequests) && json.size() >= COMPRESS_REQUEST_MIN_SIZE)
+    {
+        const QByteArray compressed = qCompress(json).mid(QCOMPRESS_HEADER_SIZE);
+        if (compressed.size() < json.size())
+        {
+            requestBytesSaved_ += json.size() - compressed.size();
+            body = compressed;
+            request.setRawHeader(contentEncodingHeaderName, QByteArrayLiteral("deflate"));
+        }
+    }
 
     request.setAttribute(QNetworkRequest::CacheLoadControlAttribute, QNetworkRequest::AlwaysNetwork);
     request.setAttribute(QNetworkRequest::CacheSaveControlAttribute, false);
     request.setAttribute(QNetworkRequest::DoNotBufferUploadDataAttribute, true);
     request.setAttribute(QNetworkRequest::HttpPipeliningAllowedAttribute, false);
 
-    httpClient_->post(request, json);
+    QNetworkReply* reply = httpClient_->post(request, body);
 
     emit packetSent(json);
+    return reply;
 }
 
 
 WalletClient::WalletClient(QObject* parent)
     : Client(parent)
-{}
+{
+    paramsBuffer_.reserve(PARAMS_BUFFER_SIZE); // reserved, so resize(0) keeps the memory
+}
 
 WalletClient::WalletClient(const QUrl& url, QObject* parent)
-    : Client(url, parent)
-{}
+    : WalletClient(parent)
+{
+    setUrl(url);
+}
 
 WalletClient::WalletClient(const QString& endPoint, QObject* parent)
-    : Client(endPoint, parent)
-{}
+    : WalletClient(parent)
+{
+    setUrl(endPoint);
+}
 
 //void WalletClient::sendGetStatus(const RpcApi::GetStatus::Request& req)
 //{
@@ -4,20 +4,30 @@
 #pragma once
 
 #include <functional>
+#include <memory>
 
 #include <QNetworkAccessManager>
 #include <QJsonArray>
 #include <QJsonParseError>
 #include <QTextStream>
 #include <QScopedPointer>
+#include <QSharedPointer>
+#include <QHash>
 #include <QHostAddress>
 #include <QUrl>
 #include <QNetworkReply>
+#include <QTimer>
+#include <QElapsedTimer>
 
 #include "JsonRpcRequest.h"
 #include "JsonRpcResponse.h"
 #include "JsonRpcNotification.h"
 #include "JsonRpcObjectFactory.h"
+#include "JsonRpcStreamReader.h"
+#include "JsonRpcDecodeQueue.h"
+#include "JsonRpcEncoder.h"
+#include "JsonRpcInflater.h"
+#include "JsonRpcStats.h"
 #include "rpcapi.h"
 
 namespace JsonRpc {
@@ -35,7 +45,31 @@ class Client : public QObject
     Q_DISABLE_COPY(Client)
 
 public:
-    typedef std::function<void(const JsonRpcResponse&)> FunctionHandler;
+    // Replies are decoded on a thread pool: a decoder builds the typed value there and
+    // the handler gets it on the GUI thread. Client does not look into the value.
+    typedef std::shared_ptr<const void> Decoded;
+    typedef std::function<Decoded(const JsonRpcResponse&)> ResponseDecoder;
+    typedef std::function<Decoded(const QJsonObject&)> ItemDecoder;
+    typedef std::function<void(const Decoded&)> FunctionHandler;
+    typedef std::function<void(const Decoded&)> ItemHandler;
+    typedef quint64 RequestId; // also serves as the cancellation token
+
+    enum RequestFlag
+    {
+        NoFlags = 0x0,
+        NoBatch = 0x1, // send at once in its own POST, for long-poll calls which must not hold others back
+        NoTimeout = 0x2, // for long-poll calls, which walletd legitimately holds for a long time
+        Coalesce = 0x4, // share the answer of an identical call still in flight, for read-only methods only
+    };
+    Q_DECLARE_FLAGS(RequestFlags, RequestFlag)
+
+    enum CompressionFlag
+    {
+        NoCompression = 0x0,
+        AcceptCompressed = 0x1, // gzip/deflate replies, inflated on the decoding thread while they download
+        CompressRequests = 0x2, // deflate large request bodies, the server must accept Content-Encoding
+    };
+    Q_DECLARE_FLAGS(CompressionFlags, CompressionFlag)
 
     Client(QObject* parent = 0);
     Client(const QUrl& url, QObject* parent = 0);
@@ -44,8 +78,34 @@ public:
     void setUrl(const QUrl& url);
     void setUrl(const QString& endPoint); // <host>:<port>
 
+    // msec, 0 disables the timeout; the per-method value wins over the default one.
+    // The time counts from the last bytes of the reply, so a large reply still downloading does not expire.
+    void setDefaultTimeout(int msec);
+    void setMethodTimeout(const QString& method, int msec);
+
+    void setCompression(CompressionFlags flags);
+    quint64 requestBytesSaved() const;
+    quint64 responseBytesSaved() const; // inflated size less what came over the wire
+
+    bool cancelRequest(RequestId id); // the handler is not called after that, returns false if id is not pending
+    int pendingRequestCount() const;
+    quint64 sentRequestCount() const;
+    quint64 coalescedRequestCount() const; // calls answered by an identical one in flight instead of a POST of their own
+
+    // Batching is switched off once the server rejects a batch, this tries it again, e.g. after a reconnect
+    void resetBatchSupport();
+
+    // packetReceived gets streamed replies whole instead of with the streamed array cut out
+    void setWholeStreamedPackets(bool whole);
+
+    StatsSnapshot statistics() const;
+    void resetStatistics();
+
 private slots:
     void replyFinished(QNetworkReply* reply);
+    void replyReadyRead(QNetworkReply* reply);
+    void flushBatch();
+    void deadlineReached();
     void authenticationRequired(QNetworkReply* reply, QAuthenticator* authenticator);
 
 signals:
@@ -54,30 +114,136 @@ signals:
     void jsonParsingError(const QString& message);
 //    void jsonErrorResponse(const QString& id, const QString& errorString);
     void jsonUnknownMessageId(const QString& id);
+    void requestTimedOut(RequestId id, const QString& method); // once per reply, id is one of the calls it carried
 
     void packetSent(const QByteArray& data);
     void packetReceived(const QByteArray& data);
     void authRequiredSignal(QAuthenticator* authenticator);
 
 protected:
+    bool event(QEvent* event) override;
+
 //    template<typename... Ts>
 //    QString sendRequest(QString method, Ts&&... args); // returns request id
 //    QString sendRequest(const QString& method, const QVariantMap& json = QVariantMap()); // returns request id
-    void sendRequest(const QString& method, const QVariantMap& json, FunctionHandler&& handler);
+    // Requests made within one event loop iteration are sent as one JSON-RPC batch unless NoBatch is set
+    // Replies of the same method are handled in the order they arrive.
+    RequestId sendRequest(const QString& method, const QVariantMap& json, ResponseDecoder&& decoder, FunctionHandler&& handler, RequestFlags flags = NoFlags);
+    // Items of result.<arrayName> are passed to itemHandler while the reply is downloaded,
+    // handler then gets the response with that array empty.
+    RequestId sendStreamingRequest(const QString& method, const QVariantMap& json, const QString& arrayName, ItemDecoder&& itemDecoder, ItemHandler&& itemHandler, ResponseDecoder&& decoder, FunctionHandler&& handler, RequestFlags flags = NoFlags);
+    // Same with the request already encoded: prefix is JsonWriter::requestPrefix(method), params a JSON object
+    RequestId sendRequest(const QString& method, const QByteArray& prefix, const QByteArray& params, ResponseDecoder&& decoder, FunctionHandler&& handler, RequestFlags flags = NoFlags);
+    RequestId sendStreamingRequest(const QString& method, const QByteArray& prefix, const QByteArray& params, const QString& arrayName, ItemDecoder&& itemDecoder, ItemHandler&& itemHandler, ResponseDecoder&& decoder, FunctionHandler&& handler, RequestFlags flags = NoFlags);
 
-    void insertResponseHandler(const QString& id, FunctionHandler&& handler);
+    RequestId insertResponseHandler(const QString& method, ResponseDecoder&& decoder, FunctionHandler&& handler, RequestFlags flags);
+
+    static QByteArray encodeParams(const QVariantMap& json); // compact JSON object
 
 private:
-    void sendJson(const QByteArray& json);
+    struct PendingRequest
+    {
+        ResponseDecoder decoder; // followers use the one of their leader
+        ItemDecoder itemDecoder;
+        FunctionHandler handler; // empty once cancelled while followers still wait for the answer
+        ItemHandler itemHandler;
+        QString method;
+        qint64 deadline = 0; // msec on clock_, 0 if none
+        int timeout = 0; // msec, the deadline is pushed by that much whenever the reply makes progress
+        QNetworkReply* reply = nullptr; // null while queued for a batch
+        QByteArray coalesceKey;
+        QList<RequestId> followers; // coalesced calls waiting for this one
+        RequestId leader = 0; // the call this one waits for, if isFollower
+        bool isFollower = false;
+        bool streaming = false; // items already went out, it is too late to join
+    };
+
+    struct OutgoingRequest
+    {
+        RequestId id;
+        QByteArray json;
+        QList<QByteArray> streamPath; // empty unless the reply is streamed
+    };
+
+    struct ReplyDecoding
+    {
+        std::shared_ptr<JsonRpcStreamReader> reader; // null unless streamed, used on the decoding thread only
+        std::shared_ptr<qint64> decodeNsec; // added to on the decoding thread only
+        std::shared_ptr<Inflater> inflater; // null unless the reply is compressed, used on the decoding thread only
+        std::shared_ptr<qint64> bodyBytes; // inflated, added to on the decoding thread only
+        std::shared_ptr<QByteArray> wholePacket; // streamed reply as received and inflated, only if wholeStreamedPackets_
+        bool encodingChecked = false;
+
+        QStringList methods; // one per call in the reply
+        QList<int> requestBytes; // one per call in the reply
+        qint64 sentMsecsSinceEpoch = 0;
+        qint64 sentAt = 0; // usec on clock_, as are the two below
+        qint64 firstByteAt = -1;
+        qint64 finishedAt = -1;
+        qint64 responseBytes = 0; // over the wire
+    };
+
+    struct DecodedReply
+    {
+        QByteArray data; // reply as received, streamed items cut out
+        QStringList errors;
+        QList<QPair<QString, Decoded>> responses; // null value if the id had no decoder
+        bool batchRejected = false;
+    };
+
+    RequestId enqueue(const QString& method, const QByteArray& prefix, const QByteArray& params, const QList<QByteArray>& streamPath, ItemDecoder&& itemDecoder, ItemHandler&& itemHandler, ResponseDecoder&& decoder, FunctionHandler&& handler, RequestFlags flags);
+    void post(OutgoingRequest&& request, RequestFlags flags);
+    void postBatch(const QList<OutgoingRequest>& batch);
+    void resendBatch(const QList<OutgoingRequest>& batch);
+    static void checkEncoding(QNetworkReply* reply, ReplyDecoding& decoding);
+    static QByteArray inflateBody(Inflater* inflater, const QByteArray& data);
+    static void decodeReply(DecodedReply& result, JsonRpcStreamReader* reader, bool isBatch, const QHash<QString, ResponseDecoder>& decoders, QByteArray data);
+    static bool isInvalidRequestError(const QJsonValue& value); // -32600 with a null id
+    static void decodeResponse(DecodedReply& result, const QJsonObject& json, const QHash<QString, ResponseDecoder>& decoders);
+    void finishReply(const DecodedReply& result, const ReplyDecoding& decoding, QNetworkReply* reply, const QList<RequestId>& ids, const QList<OutgoingRequest>& batch);
+    void recordStats(const ReplyDecoding& decoding, bool failed);
+    void dropUnanswered(QNetworkReply* reply, const QList<RequestId>& ids);
+    void processResponse(const QString& id, const Decoded& decoded);
+    void dispatchItem(RequestId id, const Decoded& item);
+    void removePending(RequestId id, bool abortReply);
+    void scheduleDeadline();
+    void extendDeadlines(QNetworkReply* reply);
+    QNetworkReply* sendJson(const QByteArray& json);
 //    void destroyedReply(QObject* obj); // debug, must be deleted
 
     QNetworkAccessManager* httpClient_;
     QUrl url_;
-    QMap<QString, FunctionHandler> responseHandlers_;
+    QMap<RequestId, PendingRequest> pending_; // ascending ids, so begin() is the oldest request
+    QMultiMap<qint64, RequestId> deadlines_;
+    QHash<QNetworkReply*, QList<RequestId>> replyRequests_;
+    QHash<QNetworkReply*, ReplyDecoding> replyDecodings_;
+    QHash<QByteArray, RequestId> inFlight_; // coalesce key -> call on the wire
+    QHash<QString, int> methodTimeouts_;
+    int defaultTimeout_;
+    QElapsedTimer clock_;
+    QTimer deadlineTimer_;
 
-    quint64 idCount_;
+    QList<OutgoingRequest> batch_;
+    QTimer batchTimer_;
+    QHash<QNetworkReply*, QList<OutgoingRequest>> batchReplies_; // kept to resend one by one if the server rejects batches
+    bool batchSupported_;
+
+    RequestId idCount_;
+    quint64 sentCount_;
+    quint64 coalescedCount_;
+    StatsSnapshot stats_;
+
+    bool wholeStreamedPackets_;
+    CompressionFlags compression_;
+    quint64 requestBytesSaved_;
+    quint64 responseBytesSaved_;
+
+    DecodeQueue decodeQueue_; // last, so running decodes are waited for before anything else goes
 };
 
+Q_DECLARE_OPERATORS_FOR_FLAGS(Client::RequestFlags)
+Q_DECLARE_OPERATORS_FOR_FLAGS(Client::CompressionFlags)
+
 class WalletClient : public Client
 {
     Q_OBJECT
@@ -89,15 +255,36 @@ public:
     WalletClient(const QString& endPoint, QObject* parent = 0);
 
     template<typename APIFunction, typename SuccessHandler, typename ErrorHandler>
-    void sendRequest(const typename APIFunction::Request& req, SuccessHandler successHandler, ErrorHandler errorHandler)
+    RequestId sendRequest(const typename APIFunction::Request& req, SuccessHandler successHandler, ErrorHandler errorHandler, RequestFlags flags = NoFlags)
     {
-        Client::sendRequest(
+        return Client::sendRequest(
             APIFunction::METHOD,
-            req.toJson(),
-            [this, successHandler, errorHandler](const JsonRpcResponse& response) /*mutable*/
+            requestPrefix<APIFunction>(),
+            encodeParams(req),
+            &WalletClient::decodeResponse<APIFunction>,
+            ResponseDispatcher<APIFunction, SuccessHandler, ErrorHandler>{std::move(successHandler), std::move(errorHandler)},
+            flags);
+    }
+
+    template<typename APIFunction, typename Item, typename ItemCallback, typename SuccessHandler, typename ErrorHandler>
+    RequestId sendStreamingRequest(const typename APIFunction::Request& req, const QString& arrayName, ItemCallback itemHandler, SuccessHandler successHandler, ErrorHandler errorHandler, RequestFlags flags = NoFlags)
+    {
+        return Client::sendStreamingRequest(
+            APIFunction::METHOD,
+            requestPrefix<APIFunction>(),
+            encodeParams(req),
+            arrayName,
+            [](const QJsonObject& item) -> Decoded
+            {
+                return std::make_shared<Item>(Item::fromJson(item));
+            },
+            [itemHandler](const Decoded& item)
             {
-                this->responseHandler<APIFunction, SuccessHandler, ErrorHandler>(response, successHandler, errorHandler);
-            });
+                itemHandler(*static_cast<const Item*>(item.get()));
+            },
+            &WalletClient::decodeResponse<APIFunction>,
+            ResponseDispatcher<APIFunction, SuccessHandler, ErrorHandler>{std::move(successHandler), std::move(errorHandler)},
+            flags);
     }
 
 //    void sendGetStatus(const RpcApi::GetStatus::Request& req);
@@ -109,21 +296,83 @@ public:
 //    void sendCreateProof(const RpcApi::CreateSendProof::Request& req);
 //    void sendCheckProof(const RpcApi::CheckSendProof::Request& req);
 
-private:
-    template<typename APIFunction, typename SuccessHandler, typename ErrorHandler>
-    void responseHandler(const JsonRpcResponse& response, SuccessHandler successHandler, ErrorHandler errorHandler)
+protected:
+    // The reply path, rpc-bench runs it without a server
+    template<typename APIFunction>
+    struct DecodedResponse
+    {
+        QString id;
+        bool isError = false;
+        Error error;
+        typename APIFunction::Response response;
+    };
+
+    // Decoding thread
+    template<typename APIFunction>
+    static Decoded decodeResponse(const JsonRpcResponse& response)
     {
+        auto decoded = std::make_shared<DecodedResponse<APIFunction>>();
+        decoded->id = response.getId();
         if (response.isErrorResponse())
         {
-            Error error{response.getErrorCode(), response.getErrorMessage(), response.getErrorData().toString()};
-            errorHandler(response.getId(), error);
-            return;
+            decoded->isError = true;
+            decoded->error = Error{response.getErrorCode(), response.getErrorMessage(), response.getErrorData().toString()};
         }
+        else
+            decoded->response = APIFunction::Response::fromJson(response.getResultAsJsonObject());
+        return decoded;
+    }
+
+    // GUI thread. Both handlers live in the one callable, they are not copied again for every reply.
+    template<typename APIFunction, typename SuccessHandler, typename ErrorHandler>
+    struct ResponseDispatcher
+    {
+        SuccessHandler successHandler;
+        ErrorHandler errorHandler;
+
+        void operator()(const Decoded& decoded) const
+        {
+            const DecodedResponse<APIFunction>& value = *static_cast<const DecodedResponse<APIFunction>*>(decoded.get());
+            if (value.isError)
+            {
+                errorHandler(value.id, value.error);
+                return;
+            }
 
-        const QVariantMap& result = response.getResultAsObject();
-        successHandler(response.getId(), APIFunction::Response::fromJson(result));
+            successHandler(value.id, value.response);
+        }
+    };
+
+private:
+    // {"jsonrpc":"2.0","method":"<method>","params": is built once per method
+    template<typename APIFunction>
+    static const QByteArray& requestPrefix()
+    {
+        static const QByteArray prefix = JsonWriter::requestPrefix(QString::fromLatin1(APIFunction::METHOD));
+        return prefix;
     }
 
+    // Polling requests write their params straight into paramsBuffer_, which keeps its capacity
+    // between calls; enqueue() copies them into the request body, so the buffer is free again after.
+    template<typename Request>
+    typename std::enable_if<HasJsonWriter<Request>::value, const QByteArray&>::type encodeParams(const Request& req)
+    {
+        paramsBuffer_.resize(0);
+        {
+            JsonWriter writer(paramsBuffer_);
+            req.writeJson(writer);
+        }
+        return paramsBuffer_;
+    }
+
+    template<typename Request>
+    typename std::enable_if<!HasJsonWriter<Request>::value, QByteArray>::type encodeParams(const Request& req)
+    {
+        return Client::encodeParams(req.toJson());
+    }
+
+    QByteArray paramsBuffer_;
+
 //    void statusHandler(const JsonRpcResponse& response);
 //    void transfersHandler(const JsonRpcResponse& response);
 //    void walletInfoHandler(const JsonRpcResponse& response);
@@ -0,0 +1,124 @@
+// Copyright (c) 2015-2018, The Bytecoin developers.
+// Licensed under the GNU Lesser General Public License. See LICENSE for details.
+
+#include <QCoreApplication>
+#include <QEvent>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QQueue>
+#include <QRunnable>
+
+#include "JsonRpcDecodeQueue.h"
+
+namespace JsonRpc {
+
+namespace {
+
+constexpr int POOL_EXPIRY_TIMEOUT_MSEC = 60000;
+
+QEvent::Type continuationEventType()
+{
+    static const QEvent::Type type = static_cast<QEvent::Type>(QEvent::registerEventType());
+    return type;
+}
+
+class ContinuationEvent : public QEvent
+{
+public:
+    explicit ContinuationEvent(DecodeQueue::Task&& continuation)
+        : QEvent(continuationEventType())
+        , continuation_(std::move(continuation))
+    {}
+
+    void run() const
+    {
+        continuation_();
+    }
+
+private:
+    const DecodeQueue::Task continuation_;
+};
+
+}
+
+struct DecodeQueue::State
+{
+    QMutex mutex;
+    QObject* receiver; // null once the queue is destroyed
+    QQueue<Task> tasks;
+    bool running = false; // a runner is active, it takes what is queued meanwhile
+};
+
+class DecodeQueue::Runner : public QRunnable
+{
+public:
+    explicit Runner(const std::shared_ptr<State>& state)
+        : state_(state)
+    {}
+
+    void run() override
+    {
+        forever
+        {
+            Task task;
+            {
+                QMutexLocker lock(&state_->mutex);
+                if (state_->tasks.isEmpty())
+                {
+                    state_->running = false;
+                    return;
+                }
+                task = state_->tasks.dequeue();
+            }
+            task();
+        }
+    }
+
+private:
+    const std::shared_ptr<State> state_;
+};
+
+DecodeQueue::DecodeQueue(QObject* receiver)
+    : state_(std::make_shared<State>())
+{
+    state_->receiver = receiver;
+    pool_.setExpiryTimeout(POOL_EXPIRY_TIMEOUT_MSEC);
+}
+
+DecodeQueue::~DecodeQueue()
+{
+    {
+        QMutexLocker lock(&state_->mutex);
+        state_->receiver = nullptr;
+        state_->tasks.clear();
+    }
+    pool_.waitForDone();
+}
+
+void DecodeQueue::run(Task&& task)
+{
+    QMutexLocker lock(&state_->mutex);
+    state_->tasks.enqueue(std::move(task));
+    if (!state_->running)
+    {
+        state_->running = true;
+        pool_.start(new Runner(state_));
+    }
+}
+
+void DecodeQueue::post(Task&& continuation)
+{
+    QMutexLocker lock(&state_->mutex);
+    if (state_->receiver != nullptr)
+        QCoreApplication::postEvent(state_->receiver, new ContinuationEvent(std::move(continuation)));
+}
+
+bool DecodeQueue::deliver(QEvent* event)
+{
+    if (event->type() != continuationEventType())
+        return false;
+    static_cast<ContinuationEvent*>(event)->run();
+    return true;
+}
+
+}
@@ -0,0 +1,41 @@
+// Copyright (c) 2015-2018, The Bytecoin developers.
+// Licensed under the GNU Lesser General Public License. See LICENSE for details.
+
+#pragma once
+
+#include <functional>
+#include <memory>
+
+#include <QObject>
+#include <QThreadPool>
+
+namespace JsonRpc {
+
+// Runs reply decoding on a private thread pool and hands the results back to the thread of receiver.
+// Tasks run one after another in the order they were queued, and since their continuations are
+// posted to one receiver, the results arrive in that order too. One queue serves all the replies
+// of a client, so a reply of a method is never overtaken by a later one, batched or not.
+class DecodeQueue
+{
+    Q_DISABLE_COPY(DecodeQueue)
+
+public:
+    typedef std::function<void()> Task;
+
+    explicit DecodeQueue(QObject* receiver);
+    ~DecodeQueue(); // waits for running tasks, continuations not delivered yet are dropped
+
+    void run(Task&& task); // receiver thread only
+    void post(Task&& continuation); // any thread, continuation is run by deliver() on the receiver thread
+
+    static bool deliver(QEvent* event); // call from receiver's event(), returns false for other events
+
+private:
+    struct State;
+    class Runner;
+
+    std::shared_ptr<State> state_;
+    QThreadPool pool_;
+};
+
+}
@@ -0,0 +1,167 @@
+// Copyright (c) 2015-2018, The Bytecoin developers.
+// Licensed under the GNU Lesser General Public License. See LICENSE for details.
+
+#include <algorithm>
+
+#include "JsonRpcEncoder.h"
+
+namespace JsonRpc {
+
+namespace {
+
+void appendEscaped(QByteArray& out, char c)
+{
+    static const char hexDigits[] = "0123456789abcdef";
+    switch (c)
+    {
+    case '"': out += "\\\""; break;
+    case '\\': out += "\\\\"; break;
+    case '\b': out += "\\b"; break;
+    case '\f': out += "\\f"; break;
+    case '\n': out += "\\n"; break;
+    case '\r': out += "\\r"; break;
+    case '\t': out += "\\t"; break;
+    default:
+        if (static_cast<unsigned char>(c) < 0x20)
+        {
+            out += "\\u00";
+            out += hexDigits[(c >> 4) & 0xf];
+            out += hexDigits[c & 0xf];
+        }
+        else
+            out += c;
+    }
+}
+
+// QByteArray::number() would allocate a temporary for every field
+void appendUnsigned(QByteArray& out, quint64 value)
+{
+    char digits[20];
+    char* const end = digits + sizeof(digits);
+    char* begin = end;
+    do
+    {
+        *--begin = static_cast<char>('0' + value % 10);
+        value /= 10;
+    }
+    while (value != 0);
+    out.append(begin, static_cast<int>(end - begin));
+}
+
+void appendSigned(QByteArray& out, qint64 value)
+{
+    if (value < 0)
+    {
+        out += '-';
+        appendUnsigned(out, 0ull - static_cast<quint64>(value));
+    }
+    else
+        appendUnsigned(out, static_cast<quint64>(value));
+}
+
+void appendString(QByteArray& out, const QString& value)
+{
+    out += '"';
+    // Hashes and addresses are ASCII, they are copied over without a UTF-8 temporary
+    const bool ascii = std::all_of(value.cbegin(), value.cend(), [](QChar c) { return c.unicode() < 0x80; });
+    if (ascii)
+        for (const QChar c : value)
+            appendEscaped(out, static_cast<char>(c.unicode()));
+    else
+        for (const char c : value.toUtf8())
+            appendEscaped(out, c);
+    out += '"';
+}
+
+}
+
+JsonWriter::JsonWriter(QByteArray& out)
+    : out_(out)
+    , first_(true)
+{
+    out_ += '{';
+}
+
+JsonWriter::~JsonWriter()
+{
+    out_ += '}';
+}
+
+void JsonWriter::key(const char* name)
+{
+    if (!first_)
+        out_ += ',';
+    first_ = false;
+    out_ += '"';
+    out_ += name; // field names are identifiers, nothing to escape
+    out_ += "\":";
+}
+
+void JsonWriter::field(const char* name, bool value)
+{
+    key(name);
+    out_ += value ? "true" : "false";
+}
+
+void JsonWriter::field(const char* name, qint32 value)
+{
+    key(name);
+    appendSigned(out_, value);
+}
+
+void JsonWriter::field(const char* name, quint32 value)
+{
+    key(name);
+    appendUnsigned(out_, value);
+}
+
+void JsonWriter::field(const char* name, qint64 value)
+{
+    key(name);
+    appendSigned(out_, value);
+}
+
+void JsonWriter::field(const char* name, quint64 value)
+{
+    key(name);
+    appendUnsigned(out_, value);
+}
+
+void JsonWriter::field(const char* name, const QString& value)
+{
+    key(name);
+    appendString(out_, value);
+}
+
+void JsonWriter::field(const char* name, const RpcApi::Hash32& value)
+{
+    static const char hexDigits[] = "0123456789abcdef";
+    key(name);
+    out_ += '"';
+    for (int i = 0; i < RpcApi::Hash32::SIZE && !value.isNull(); ++i) // a null hash goes out empty, as it always did
+    {
+        out_ += hexDigits[value.data()[i] >> 4];
+        out_ += hexDigits[value.data()[i] & 0xf];
+    }
+    out_ += '"';
+}
+
+/*static*/
+QByteArray JsonWriter::requestPrefix(const QString& method)
+{
+    QByteArray prefix("{\"jsonrpc\":\"2.0\",\"method\":");
+    appendString(prefix, method);
+    prefix += ",\"params\":";
+    return prefix;
+}
+
+/*static*/
+void JsonWriter::appendRequestId(QByteArray& out, quint64 id)
+{
+    // Ids go out as strings, as JsonRpcRequest always sent them
+    out += ",\"id\":\"";
+    appendUnsigned(out, id);
+    out += "\"}";
+}
+
+}
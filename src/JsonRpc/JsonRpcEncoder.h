@@ -0,0 +1,59 @@
+// Copyright (c) 2015-2018, The Bytecoin developers.
+// Licensed under the GNU Lesser General Public License. See LICENSE for details.
+
+#pragma once
+
+#include <type_traits>
+#include <utility>
+
+#include <QByteArray>
+#include <QString>
+
+#include "hash32.h"
+
+namespace JsonRpc {
+
+// Writes the fields of one flat JSON object straight into a byte array, in the order given.
+// Used for the params of calls made every few hundred msec, where going through a QVariantMap
+// and a QJsonDocument costs far more than the call itself.
+class JsonWriter
+{
+    Q_DISABLE_COPY(JsonWriter)
+
+public:
+    explicit JsonWriter(QByteArray& out); // appends '{' to out
+    ~JsonWriter(); // appends '}'
+
+    void field(const char* name, bool value);
+    void field(const char* name, qint32 value);
+    void field(const char* name, quint32 value);
+    void field(const char* name, qint64 value);
+    void field(const char* name, quint64 value);
+    void field(const char* name, const QString& value);
+    void field(const char* name, const RpcApi::Hash32& value); // as hex
+
+    // {"jsonrpc":"2.0","method":"<method>","params": -- a request is this, the params and ,"id":"<id>"}
+    static QByteArray requestPrefix(const QString& method);
+    static void appendRequestId(QByteArray& out, quint64 id);
+
+private:
+    void key(const char* name);
+
+    QByteArray& out_;
+    bool first_;
+};
+
+// True for requests which can write their params through JsonWriter, the rest go through toJson()
+template<typename Request>
+class HasJsonWriter
+{
+    template<typename T>
+    static auto test(int) -> decltype(std::declval<const T&>().writeJson(std::declval<JsonWriter&>()), std::true_type());
+    template<typename>
+    static std::false_type test(...);
+
+public:
+    static constexpr bool value = decltype(test<Request>(0))::value;
+};
+
+}
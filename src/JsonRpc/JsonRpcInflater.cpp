@@ -0,0 +1,101 @@
+// Copyright (c) 2015-2018, The Bytecoin developers.
+// Licensed under the GNU Lesser General Public License. See LICENSE for details.
+
+#include <zlib.h>
+
+#include "JsonRpcInflater.h"
+
+namespace JsonRpc {
+
+namespace {
+
+constexpr int OUTPUT_CHUNK_SIZE = 64 * 1024;
+constexpr int MAX_WINDOW_BITS = 15;
+constexpr int AUTO_DETECT_HEADER = 32; // added to windowBits, takes both gzip and zlib headers
+
+}
+
+struct Inflater::Stream
+{
+    z_stream zs;
+    bool initialized = false;
+    bool finished = false;
+};
+
+Inflater::Inflater()
+    : stream_(new Stream)
+{
+    stream_->zs = z_stream();
+}
+
+Inflater::~Inflater()
+{
+    if (stream_->initialized)
+        inflateEnd(&stream_->zs);
+}
+
+/*static*/
+bool Inflater::isSupported(const QByteArray& contentEncoding)
+{
+    return contentEncoding == "gzip" || contentEncoding == "x-gzip" || contentEncoding == "deflate";
+}
+
+bool Inflater::inflate(const QByteArray& data, QByteArray& out)
+{
+    if (hasError())
+        return false;
+    if (data.isEmpty() || stream_->finished)
+        return true;
+
+    z_stream& zs = stream_->zs;
+    if (!stream_->initialized)
+    {
+        // "deflate" is meant to be zlib wrapped, some servers send it raw. A zlib header has
+        // the deflate method in the low nibble of its first byte, gzip starts with 0x1f.
+        const uchar first = static_cast<uchar>(data.at(0));
+        const bool wrapped = first == 0x1f || (first & 0x0f) == Z_DEFLATED;
+        if (inflateInit2(&zs, wrapped ? MAX_WINDOW_BITS + AUTO_DETECT_HEADER : -MAX_WINDOW_BITS) != Z_OK)
+        {
+            errorString_ = QString::fromLatin1("Cannot initialize the inflater.");
+            return false;
+        }
+        stream_->initialized = true;
+    }
+
+    zs.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data.constData()));
+    zs.avail_in = static_cast<uInt>(data.size());
+    while (zs.avail_in > 0)
+    {
+        const int offset = out.size();
+        out.resize(offset + OUTPUT_CHUNK_SIZE);
+        zs.next_out = reinterpret_cast<Bytef*>(out.data() + offset);
+        zs.avail_out = OUTPUT_CHUNK_SIZE;
+        const int result = ::inflate(&zs, Z_NO_FLUSH);
+        out.resize(out.size() - static_cast<int>(zs.avail_out));
+        if (result == Z_STREAM_END)
+        {
+            stream_->finished = true; // anything after the end of the stream is ignored
+            break;
+        }
+        if (result != Z_OK && result != Z_BUF_ERROR)
+        {
+            errorString_ = QString::fromLatin1("Broken compressed reply: %1").arg(QString::fromLatin1(zs.msg != nullptr ? zs.msg : "unknown error"));
+            return false;
+        }
+        if (result == Z_BUF_ERROR && zs.avail_out != 0)
+            break; // needs more input
+    }
+    return true;
+}
+
+bool Inflater::hasError() const
+{
+    return !errorString_.isEmpty();
+}
+
+const QString& Inflater::errorString() const
+{
+    return errorString_;
+}
+
+}
@@ -0,0 +1,37 @@
+// Copyright (c) 2015-2018, The Bytecoin developers.
+// Licensed under the GNU Lesser General Public License. See LICENSE for details.
+
+#pragma once
+
+#include <memory>
+
+#include <QByteArray>
+#include <QString>
+
+namespace JsonRpc {
+
+// Streaming inflater for gzip and deflate encoded HTTP bodies, fed chunk by chunk as they download.
+// The network stack is asked not to inflate replies itself, so the bytes that came over the wire
+// are known and a streamed reply is still handed on piece by piece.
+class Inflater
+{
+    Q_DISABLE_COPY(Inflater)
+
+public:
+    Inflater();
+    ~Inflater();
+
+    static bool isSupported(const QByteArray& contentEncoding); // gzip, x-gzip or deflate
+
+    bool inflate(const QByteArray& data, QByteArray& out); // appends to out, returns false once the stream is broken
+    bool hasError() const;
+    const QString& errorString() const;
+
+private:
+    struct Stream;
+
+    std::unique_ptr<Stream> stream_;
+    QString errorString_;
+};
+
+}
@@ -30,6 +30,10 @@ QVariantMap JsonRpcResponse::getResultAsObject() const {
   return getValue(resultTagName).toObject().toVariantMap();
 }
 
+QJsonObject JsonRpcResponse::getResultAsJsonObject() const {
+  return getValue(resultTagName).toObject();
+}
+
 bool JsonRpcResponse::isErrorResponse() const {
   return contains(errorTagName);
 }
@@ -23,6 +23,7 @@ public:
   QString getId() const;
   QVariantList getResultAsArray() const;
   QVariantMap getResultAsObject() const;
+  QJsonObject getResultAsJsonObject() const;
   bool isErrorResponse() const;
   int getErrorCode() const;
   QString getErrorMessage() const;
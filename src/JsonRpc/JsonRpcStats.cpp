@@ -0,0 +1,122 @@
+// Copyright (c) 2015-2018, The Bytecoin developers.
+// Licensed under the GNU Lesser General Public License. See LICENSE for details.
+
+#include <algorithm>
+#include <cmath>
+
+#include <QDateTime>
+#include <QStringList>
+
+#include "JsonRpcStats.h"
+
+namespace JsonRpc {
+
+namespace {
+
+const QVector<qint64>& bucketBounds(Histogram::Unit unit)
+{
+    static const QVector<qint64> microseconds{
+        100, 200, 500,
+        1000, 2000, 5000,
+        10000, 20000, 50000,
+        100000, 200000, 500000,
+        1000000, 2000000, 5000000,
+        10000000, 30000000, 60000000, 120000000};
+    static const QVector<qint64> bytes = []()
+    {
+        QVector<qint64> bounds;
+        for (qint64 bound = 256; bound <= 64 * 1024 * 1024; bound *= 2)
+            bounds << bound;
+        return bounds;
+    }();
+    return unit == Histogram::Bytes ? bytes : microseconds;
+}
+
+QString formatValue(Histogram::Unit unit, qint64 value)
+{
+    if (unit == Histogram::Bytes)
+        return value < 1024 ? QString::number(value) : QString("%1K").arg(value / 1024);
+    return value < 1000 ? QString("%1us").arg(value) : QString("%1ms").arg(value / 1000);
+}
+
+QString formatPercentiles(const Histogram& histogram)
+{
+    if (histogram.count() == 0)
+        return QString("-");
+    return QString("%1/%2/%3")
+            .arg(formatValue(histogram.unit(), histogram.percentile(0.5)))
+            .arg(formatValue(histogram.unit(), histogram.percentile(0.9)))
+            .arg(formatValue(histogram.unit(), histogram.percentile(0.99)));
+}
+
+}
+
+Histogram::Histogram(Unit unit)
+    : unit_(unit)
+    , buckets_(bucketBounds(unit).size() + 1, 0)
+    , count_(0)
+    , max_(0)
+{}
+
+void Histogram::add(qint64 value)
+{
+    const QVector<qint64>& bounds = bucketBounds(unit_);
+    const int bucket = static_cast<int>(std::lower_bound(bounds.cbegin(), bounds.cend(), value) - bounds.cbegin());
+    ++buckets_[bucket];
+    ++count_;
+    max_ = qMax(max_, value);
+}
+
+Histogram::Unit Histogram::unit() const
+{
+    return unit_;
+}
+
+quint64 Histogram::count() const
+{
+    return count_;
+}
+
+qint64 Histogram::max() const
+{
+    return max_;
+}
+
+qint64 Histogram::percentile(double fraction) const
+{
+    if (count_ == 0)
+        return 0;
+    const QVector<qint64>& bounds = bucketBounds(unit_);
+    const quint64 rank = qMax<quint64>(1, static_cast<quint64>(std::ceil(fraction * count_)));
+    quint64 seen = 0;
+    for (int i = 0; i < bounds.size(); ++i)
+    {
+        seen += buckets_[i];
+        if (seen >= rank)
+            return qMin(bounds[i], max_);
+    }
+    return max_;
+}
+
+QString formatStats(const StatsSnapshot& stats)
+{
+    QStringList lines;
+    lines << QString("RPC statistics, p50/p90/p99 per method:");
+    for (auto it = stats.cbegin(); it != stats.cend(); ++it)
+    {
+        const MethodStats& method = it.value();
+        lines << QString("%1 calls %2, failed %3, last %4; first byte %5, finish %6, decode %7, sent %8, received %9")
+                 .arg(it.key())
+                 .arg(method.calls)
+                 .arg(method.failures)
+                 .arg(method.lastSent != 0 ? QDateTime::fromMSecsSinceEpoch(method.lastSent).toString(Qt::ISODate) : QString("-"))
+                 .arg(formatPercentiles(method.firstByte))
+                 .arg(formatPercentiles(method.finish))
+                 .arg(formatPercentiles(method.decode))
+                 .arg(formatPercentiles(method.requestBytes))
+                 .arg(formatPercentiles(method.responseBytes));
+    }
+    return lines.join('\n');
+}
+
+}
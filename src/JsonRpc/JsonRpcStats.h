@@ -0,0 +1,54 @@
+// Copyright (c) 2015-2018, The Bytecoin developers.
+// Licensed under the GNU Lesser General Public License. See LICENSE for details.
+
+#pragma once
+
+#include <QMap>
+#include <QString>
+#include <QVector>
+
+namespace JsonRpc {
+
+// Counts values in fixed buckets, so recording is cheap and percentiles are approximate:
+// a percentile is reported as the upper bound of the bucket it falls into.
+class Histogram
+{
+public:
+    enum Unit
+    {
+        Microseconds, Bytes
+    };
+
+    explicit Histogram(Unit unit = Microseconds);
+
+    void add(qint64 value);
+
+    Unit unit() const;
+    quint64 count() const;
+    qint64 max() const;
+    qint64 percentile(double fraction) const; // fraction in (0, 1], 0 if empty
+
+private:
+    Unit unit_;
+    QVector<quint64> buckets_; // one more than bounds, the last one is for overflow
+    quint64 count_;
+    qint64 max_;
+};
+
+struct MethodStats
+{
+    quint64 calls = 0; // answered, a batch reply counts once for each of its calls
+    quint64 failures = 0; // network errors, timeouts are not counted
+    qint64 lastSent = 0; // msec since epoch
+    Histogram firstByte{Histogram::Microseconds}; // from sending to the first byte of the reply
+    Histogram finish{Histogram::Microseconds}; // from sending to the last byte of the reply
+    Histogram decode{Histogram::Microseconds}; // spent on the decoding thread, split like responseBytes
+    Histogram requestBytes{Histogram::Bytes};
+    Histogram responseBytes{Histogram::Bytes}; // a batch reply is split evenly between its calls
+};
+
+typedef QMap<QString, MethodStats> StatsSnapshot; // by method name
+
+QString formatStats(const StatsSnapshot& stats); // p50/p90/p99 per method, one method per line
+
+}
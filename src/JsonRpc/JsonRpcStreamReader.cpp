@@ -0,0 +1,190 @@
+// Copyright (c) 2015-2018, The Bytecoin developers.
+// Licensed under the GNU Lesser General Public License. See LICENSE for details.
+
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonParseError>
+#include <QCoreApplication>
+
+#include "JsonRpcStreamReader.h"
+
+namespace JsonRpc {
+
+namespace {
+
+constexpr int ITEM_RESERVE_SIZE = 64 * 1024;
+
+inline bool isJsonSpace(char c)
+{
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+}
+
+JsonRpcStreamReader::JsonRpcStreamReader(const QList<QByteArray>& arrayPath, ItemHandler&& handler)
+    : arrayPath_(arrayPath)
+    , handler_(std::move(handler))
+    , arrayDepth_(-1)
+    , itemCount_(0)
+    , inItem_(false)
+    , inString_(false)
+    , escape_(false)
+    , captureKey_(false)
+{
+    item_.reserve(ITEM_RESERVE_SIZE); // keeps the buffer allocated between items
+}
+
+bool JsonRpcStreamReader::feed(const QByteArray& data)
+{
+    for (const char c : data)
+    {
+        if (hasError())
+            return false;
+
+        QByteArray& out = inItem_ ? item_ : skeleton_;
+        if (inString_)
+        {
+            out += c;
+            if (escape_)
+                escape_ = false;
+            else if (c == '\\')
+                escape_ = true;
+            else if (c == '"')
+            {
+                inString_ = false;
+                if (captureKey_)
+                {
+                    levels_.last().key = key_;
+                    captureKey_ = false;
+                }
+                continue;
+            }
+            if (captureKey_)
+                key_ += c;
+            continue;
+        }
+
+        if (arrayDepth_ == levels_.size())
+        {
+            // Between items of the streamed array: separators are dropped, only '{' and ']' are valid
+            if (isJsonSpace(c) || c == ',')
+                continue;
+            if (c == '{')
+            {
+                inItem_ = true;
+                item_ += c;
+                levels_.append(Level{c, true, QByteArray()});
+                continue;
+            }
+            if (c != ']')
+            {
+                setError(QCoreApplication::translate("JsonRpcStreamReader", "Streamed array item is not an object."));
+                return false;
+            }
+        }
+
+        out += c;
+        switch (c)
+        {
+        case '"':
+            inString_ = true;
+            if (!inItem_ && !levels_.isEmpty() && levels_.last().type == '{' && levels_.last().expectKey)
+            {
+                captureKey_ = true;
+                key_.clear();
+            }
+            break;
+        case '{':
+        case '[':
+            if (c == '[' && !inItem_ && arrayDepth_ < 0 && isArrayPath())
+                arrayDepth_ = levels_.size() + 1;
+            levels_.append(Level{c, c == '{', QByteArray()});
+            break;
+        case '}':
+        case ']':
+            if (levels_.isEmpty() || levels_.last().type != (c == '}' ? '{' : '['))
+            {
+                setError(QCoreApplication::translate("JsonRpcStreamReader", "Unbalanced brackets."));
+                return false;
+            }
+            if (arrayDepth_ == levels_.size() && !inItem_)
+                arrayDepth_ = -2; // streamed array is closed, do not look for it again
+            levels_.removeLast();
+            if (inItem_ && arrayDepth_ == levels_.size())
+                finishItem();
+            break;
+        case ':':
+            if (!levels_.isEmpty())
+                levels_.last().expectKey = false;
+            break;
+        case ',':
+            if (!levels_.isEmpty() && levels_.last().type == '{')
+                levels_.last().expectKey = true;
+            break;
+        default:
+            break;
+        }
+    }
+
+    return !hasError();
+}
+
+const QByteArray& JsonRpcStreamReader::skeleton() const
+{
+    return skeleton_;
+}
+
+bool JsonRpcStreamReader::hasError() const
+{
+    return !errorString_.isEmpty();
+}
+
+const QString& JsonRpcStreamReader::errorString() const
+{
+    return errorString_;
+}
+
+int JsonRpcStreamReader::itemCount() const
+{
+    return itemCount_;
+}
+
+bool JsonRpcStreamReader::isArrayPath() const
+{
+    // The reply is either a single response object or a batch array of them
+    const int offset = !levels_.isEmpty() && levels_.first().type == '[' ? 1 : 0;
+    if (levels_.size() != arrayPath_.size() + offset)
+        return false;
+    for (int i = 0; i < arrayPath_.size(); ++i)
+    {
+        const Level& level = levels_[i + offset];
+        if (level.type != '{' || level.expectKey || level.key != arrayPath_[i])
+            return false;
+    }
+    return true;
+}
+
+void JsonRpcStreamReader::finishItem()
+{
+    inItem_ = false;
+
+    QJsonParseError parseError;
+    const QJsonDocument document = QJsonDocument::fromJson(item_, &parseError);
+    item_.resize(0);
+    if (parseError.error != QJsonParseError::NoError)
+    {
+        setError(parseError.errorString());
+        return;
+    }
+
+    ++itemCount_;
+    handler_(document.object());
+}
+
+void JsonRpcStreamReader::setError(const QString& errorString)
+{
+    qDebug("[JsonRpcStreamReader] Stream error after %d items. %s", itemCount_, qPrintable(errorString));
+    errorString_ = errorString;
+}
+
+}
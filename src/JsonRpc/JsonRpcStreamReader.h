@@ -0,0 +1,66 @@
+// Copyright (c) 2015-2018, The Bytecoin developers.
+// Licensed under the GNU Lesser General Public License. See LICENSE for details.
+
+#pragma once
+
+#include <functional>
+
+#include <QByteArray>
+#include <QList>
+#include <QVector>
+#include <QString>
+
+class QJsonObject;
+
+namespace JsonRpc {
+
+// Incremental tokenizer for a JSON-RPC reply which is still being downloaded.
+// Elements of one array (addressed by a key path, e.g. result.blocks) are cut out
+// of the stream and handed to ItemHandler as soon as each of them is complete.
+// Everything else is kept in skeleton(), so after the last chunk the skeleton is
+// the original reply with that array emptied and can be parsed as usual.
+// A batch reply is handled too, the path is then looked up in its elements.
+class JsonRpcStreamReader
+{
+    Q_DISABLE_COPY(JsonRpcStreamReader)
+
+public:
+    typedef std::function<void(const QJsonObject&)> ItemHandler;
+
+    JsonRpcStreamReader(const QList<QByteArray>& arrayPath, ItemHandler&& handler);
+
+    bool feed(const QByteArray& data); // returns false once the stream is broken
+
+    const QByteArray& skeleton() const;
+    bool hasError() const;
+    const QString& errorString() const;
+    int itemCount() const;
+
+private:
+    struct Level
+    {
+        char type;
+        bool expectKey;
+        QByteArray key;
+    };
+
+    bool isArrayPath() const;
+    void finishItem();
+    void setError(const QString& errorString);
+
+    const QList<QByteArray> arrayPath_;
+    ItemHandler handler_;
+    QByteArray skeleton_;
+    QByteArray item_;
+    QByteArray key_;
+    QVector<Level> levels_;
+    int arrayDepth_;
+    int itemCount_;
+    bool inItem_;
+    bool inString_;
+    bool escape_;
+    bool captureKey_;
+    QString errorString_;
+};
+
+}
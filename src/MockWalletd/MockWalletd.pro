@@ -0,0 +1,20 @@
+# Stand-in for walletd serving a synthetic wallet, for testing the GUI at scale
+
+QT       += core network
+QT       -= gui
+
+TARGET = mock-walletd
+TEMPLATE = app
+
+CONFIG += c++14 strict_c++ console
+CONFIG -= app_bundle
+!win32: QMAKE_CXXFLAGS += -std=c++14 -Wall -Wextra -pedantic
+
+DESTDIR = $$PWD/../../bin
+
+SOURCES += main.cpp \
+    Server.cpp \
+    SyntheticWallet.cpp
+
+HEADERS += Server.h \
+    SyntheticWallet.h
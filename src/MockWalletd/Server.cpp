@@ -0,0 +1,269 @@
+// Copyright (c) 2015-2018, The Bytecoin developers.
+// Licensed under the GNU Lesser General Public License. See LICENSE for details.
+
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QTcpSocket>
+
+#include <limits>
+
+#include "Server.h"
+
+namespace MockWalletd {
+
+namespace {
+
+constexpr char RPC_PATH[] = "/json_rpc";
+constexpr int MAX_HEADER_SIZE = 64 * 1024;
+
+constexpr int JSON_RPC_PARSE_ERROR = -32700;
+constexpr int JSON_RPC_INVALID_REQUEST = -32600;
+constexpr int JSON_RPC_METHOD_NOT_FOUND = -32601;
+
+QJsonObject errorResponse(const QJsonValue& id, int code, const QString& message)
+{
+    QJsonObject error;
+    error.insert("code", code);
+    error.insert("message", message);
+    QJsonObject response;
+    response.insert("jsonrpc", QString("2.0"));
+    response.insert("id", id);
+    response.insert("error", error);
+    return response;
+}
+
+quint32 heightParam(const QJsonObject& params, const char* name, quint32 defaultValue)
+{
+    const QJsonValue value = params.value(name);
+    if (!value.isDouble())
+        return defaultValue;
+    return static_cast<quint32>(qBound<double>(0, value.toDouble(), std::numeric_limits<quint32>::max()));
+}
+
+}
+
+Server::Server(const SyntheticWallet::Params& params, int blockIntervalMsec, QObject* parent)
+    : QObject(parent)
+    , wallet_(params)
+{
+    connect(&server_, &QTcpServer::newConnection, this, &Server::newConnection);
+    connect(&blockTimer_, &QTimer::timeout, this, [this]()
+    {
+        wallet_.mineBlock();
+        walletChanged();
+    });
+    if (blockIntervalMsec > 0)
+        blockTimer_.start(blockIntervalMsec);
+    qDebug("[MockWalletd] %u transactions in %u blocks", wallet_.transactionCount(), wallet_.topHeight());
+}
+
+Server::~Server()
+{
+    for (QTcpSocket* socket : connections_.keys())
+        socket->disconnect(this);
+}
+
+bool Server::listen(const QHostAddress& address, quint16 port)
+{
+    if (!server_.listen(address, port))
+        return false;
+    qDebug("[MockWalletd] Listening on %s:%u", qPrintable(address.toString()), server_.serverPort());
+    return true;
+}
+
+QString Server::errorString() const
+{
+    return server_.errorString();
+}
+
+void Server::newConnection()
+{
+    while (QTcpSocket* socket = server_.nextPendingConnection())
+    {
+        connections_.insert(socket, Connection{});
+        connect(socket, &QTcpSocket::readyRead, this, [this, socket]() { readyRead(socket); });
+        connect(socket, &QTcpSocket::disconnected, this, [this, socket]() { disconnected(socket); });
+    }
+}
+
+void Server::readyRead(QTcpSocket* socket)
+{
+    connections_[socket].buffer += socket->readAll();
+    processConnection(socket);
+}
+
+void Server::disconnected(QTcpSocket* socket)
+{
+    connections_.remove(socket);
+    socket->deleteLater();
+}
+
+void Server::walletChanged()
+{
+    qDebug("[MockWalletd] Block %u mined", wallet_.topHeight());
+    for (QTcpSocket* socket : connections_.keys())
+    {
+        if (!connections_.contains(socket))
+            continue;
+        Connection& connection = connections_[socket];
+        if (!connection.holding || !answer(socket, connection.heldRequest))
+            continue;
+        connection.holding = false;
+        connection.heldRequest = QJsonDocument();
+        processConnection(socket); // requests pipelined behind the long poll
+    }
+}
+
+void Server::processConnection(QTcpSocket* socket)
+{
+    // Replies go out in request order, so nothing is read past a held long poll
+    while (connections_.contains(socket) && !connections_[socket].holding)
+    {
+        Connection& connection = connections_[socket];
+        const int headerEnd = connection.buffer.indexOf("\r\n\r\n");
+        if (headerEnd < 0)
+        {
+            if (connection.buffer.size() > MAX_HEADER_SIZE)
+            {
+                writeReply(socket, 431, "Request Header Fields Too Large", QByteArray());
+                socket->disconnectFromHost();
+            }
+            return;
+        }
+
+        const QList<QByteArray> lines = connection.buffer.left(headerEnd).split('\n');
+        const QList<QByteArray> requestLine = lines.first().trimmed().split(' ');
+        int contentLength = 0;
+        bool deflated = false;
+        bool acceptsDeflate = false;
+        bool close = false;
+        for (int i = 1; i < lines.size(); ++i)
+        {
+            const int colon = lines[i].indexOf(':');
+            if (colon < 0)
+                continue;
+            const QByteArray name = lines[i].left(colon).trimmed().toLower();
+            const QByteArray value = lines[i].mid(colon + 1).trimmed().toLower();
+            if (name == "content-length")
+                contentLength = value.toInt();
+            else if (name == "content-encoding")
+                deflated = (value == "deflate");
+            else if (name == "accept-encoding")
+                acceptsDeflate = value.contains("deflate");
+            else if (name == "connection")
+                close = (value == "close");
+        }
+        if (connection.buffer.size() < headerEnd + 4 + contentLength)
+            return;
+
+        QByteArray body = connection.buffer.mid(headerEnd + 4, contentLength);
+        connection.buffer.remove(0, headerEnd + 4 + contentLength);
+        connection.deflateReplies = acceptsDeflate;
+
+        if (requestLine.size() < 2 || requestLine[0] != "POST" || !requestLine[1].startsWith(RPC_PATH))
+        {
+            writeReply(socket, 404, "Not Found", QByteArray());
+            continue;
+        }
+        if (deflated)
+            body = qUncompress(QByteArray(4, '\0') + body); // a raw zlib stream, qUncompress wants a size prefix
+
+        QJsonParseError parseError;
+        const QJsonDocument request = QJsonDocument::fromJson(body, &parseError);
+        if (parseError.error != QJsonParseError::NoError)
+        {
+            writeReply(socket, 200, "OK", QJsonDocument(errorResponse(QJsonValue(), JSON_RPC_PARSE_ERROR, parseError.errorString())).toJson(QJsonDocument::Compact));
+            continue;
+        }
+        if (!answer(socket, request))
+        {
+            connection.holding = true;
+            connection.heldRequest = request;
+        }
+        if (close && !connection.holding)
+        {
+            socket->disconnectFromHost();
+            return;
+        }
+    }
+}
+
+bool Server::answer(QTcpSocket* socket, const QJsonDocument& request)
+{
+    QJsonArray responses;
+    const QJsonArray calls = request.isArray() ? request.array() : QJsonArray{request.object()};
+    for (const QJsonValue& call : calls)
+    {
+        QJsonObject response;
+        if (!handleCall(call.toObject(), response))
+            return false;
+        responses << response;
+    }
+
+    const QJsonDocument reply = request.isArray() ? QJsonDocument(responses) : QJsonDocument(responses.first().toObject());
+    writeReply(socket, 200, "OK", reply.toJson(QJsonDocument::Compact));
+    return true;
+}
+
+bool Server::handleCall(const QJsonObject& call, QJsonObject& response) const
+{
+    const QJsonValue id = call.value("id");
+    const QString method = call.value("method").toString();
+    const QJsonObject params = call.value("params").toObject();
+    if (method.isEmpty())
+    {
+        response = errorResponse(id, JSON_RPC_INVALID_REQUEST, QString("Invalid request"));
+        return true;
+    }
+
+    QJsonObject result;
+    if (method == "get_status")
+    {
+        if (!wallet_.statusDiffers(params))
+            return false;
+        result = wallet_.status();
+    }
+    else if (method == "get_wallet_info")
+        result = wallet_.walletInfo();
+    else if (method == "get_balance")
+        result = wallet_.balance();
+    else if (method == "get_transfers")
+        result = wallet_.transfers(
+                    heightParam(params, "from_height", 0),
+                    heightParam(params, "to_height", std::numeric_limits<quint32>::max()),
+                    params.value("forward").toBool(true),
+                    heightParam(params, "desired_transactions_count", std::numeric_limits<quint32>::max()));
+    else if (method == "get_wallet_records")
+        result = wallet_.walletRecords(
+                    heightParam(params, "index", 0),
+                    heightParam(params, "count", std::numeric_limits<quint32>::max()));
+    else
+    {
+        response = errorResponse(id, JSON_RPC_METHOD_NOT_FOUND, QString("Method '%1' is not supported by the mock").arg(method));
+        return true;
+    }
+
+    response.insert("jsonrpc", QString("2.0"));
+    response.insert("id", id);
+    response.insert("result", result);
+    return true;
+}
+
+void Server::writeReply(QTcpSocket* socket, int statusCode, const QByteArray& statusText, const QByteArray& body)
+{
+    // Sent as a zlib stream, which is what HTTP calls deflate; qCompress prepends a size to it
+    const bool deflate = !body.isEmpty() && connections_.value(socket).deflateReplies;
+    const QByteArray payload = deflate ? qCompress(body).mid(4) : body;
+
+    QByteArray head;
+    head += "HTTP/1.1 " + QByteArray::number(statusCode) + ' ' + statusText + "\r\n";
+    head += "Content-Type: application/json; charset=utf-8\r\n";
+    if (deflate)
+        head += "Content-Encoding: deflate\r\n";
+    head += "Content-Length: " + QByteArray::number(payload.size()) + "\r\n";
+    head += "\r\n";
+    socket->write(head);
+    socket->write(payload);
+}
+
+}
@@ -0,0 +1,58 @@
+// Copyright (c) 2015-2018, The Bytecoin developers.
+// Licensed under the GNU Lesser General Public License. See LICENSE for details.
+
+#pragma once
+
+#include <QByteArray>
+#include <QHash>
+#include <QHostAddress>
+#include <QJsonDocument>
+#include <QTcpServer>
+#include <QTimer>
+
+#include "SyntheticWallet.h"
+
+class QTcpSocket;
+
+namespace MockWalletd {
+
+// Speaks just enough HTTP/1.1 and JSON-RPC to stand in for walletd behind the GUI's remote wallet
+// option: keep-alive connections, batches, deflated request and reply bodies and the get_status long poll.
+class Server : public QObject
+{
+    Q_OBJECT
+    Q_DISABLE_COPY(Server)
+
+public:
+    Server(const SyntheticWallet::Params& params, int blockIntervalMsec, QObject* parent = nullptr);
+    ~Server();
+
+    bool listen(const QHostAddress& address, quint16 port);
+    QString errorString() const;
+
+private:
+    struct Connection
+    {
+        QByteArray buffer;
+        bool holding = false; // a get_status long poll waits for the wallet to change
+        QJsonDocument heldRequest;
+        bool deflateReplies = false; // the request being answered sent Accept-Encoding: deflate
+    };
+
+    void newConnection();
+    void readyRead(QTcpSocket* socket);
+    void disconnected(QTcpSocket* socket);
+    void walletChanged();
+
+    void processConnection(QTcpSocket* socket);
+    bool answer(QTcpSocket* socket, const QJsonDocument& request); // false while a long poll has to wait
+    bool handleCall(const QJsonObject& call, QJsonObject& response) const;
+    void writeReply(QTcpSocket* socket, int statusCode, const QByteArray& statusText, const QByteArray& body);
+
+    SyntheticWallet wallet_;
+    QTcpServer server_;
+    QTimer blockTimer_;
+    QHash<QTcpSocket*, Connection> connections_;
+};
+
+}
@@ -0,0 +1,374 @@
+// Copyright (c) 2015-2018, The Bytecoin developers.
+// Licensed under the GNU Lesser General Public License. See LICENSE for details.
+
+#include <QDateTime>
+#include <QJsonArray>
+
+#include <algorithm>
+#include <limits>
+
+#include "SyntheticWallet.h"
+
+namespace MockWalletd {
+
+namespace {
+
+constexpr quint64 TAG_BLOCK_SIZE = 1;
+constexpr quint64 TAG_BLOCK_HASH = 2;
+constexpr quint64 TAG_TRANSACTION = 3;
+constexpr quint64 TAG_TRANSACTION_HASH = 4;
+constexpr quint64 TAG_PREFIX_HASH = 5;
+constexpr quint64 TAG_INPUTS_HASH = 6;
+constexpr quint64 TAG_PUBLIC_KEY = 7;
+constexpr quint64 TAG_OUR_ADDRESS = 8;
+constexpr quint64 TAG_FOREIGN_ADDRESS = 9;
+
+constexpr quint32 LOCKED_DEPTH = 5; // same as CONFIRMATIONS in the GUI
+constexpr qint64 FEE = 1000000;
+constexpr qint64 BLOCK_REWARD = 1000000000;
+constexpr quint64 DIFFICULTY = 100000000000;
+constexpr char BASE58_ALPHABET[] = "123456789ABCDEFGHJKLMNPQRSTUVWXYZabcdefghijkmnopqrstuvwxyz";
+constexpr int ADDRESS_LENGTH = 95;
+
+// splitmix64, good enough to make unrelated positions look unrelated
+quint64 mix(quint64 value)
+{
+    value += 0x9e3779b97f4a7c15ull;
+    value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ull;
+    value = (value ^ (value >> 27)) * 0x94d049bb133111ebull;
+    return value ^ (value >> 31);
+}
+
+quint64 mix(quint64 seed, quint64 tag, quint64 height, quint64 index = 0)
+{
+    return mix(mix(mix(seed ^ mix(tag)) ^ height) ^ index);
+}
+
+bool isIncoming(quint64 random)
+{
+    return random % 4 != 0;
+}
+
+bool isCoinbase(quint64 random)
+{
+    return random % 16 == 1;
+}
+
+}
+
+SyntheticWallet::SyntheticWallet(const Params& params)
+    : params_(params)
+    , total_(0)
+    , poolVersion_(1)
+{
+    const quint32 maxPerBlock = 2 * qMax<quint32>(params_.transactionsPerBlock, 1);
+    firstTransaction_.reserve(params_.transactionCount / qMax<quint32>(params_.transactionsPerBlock, 1) + 16);
+    firstTransaction_ << 0 << 0; // genesis has no wallet transactions
+    quint32 generated = 0;
+    for (quint32 height = 1; generated < params_.transactionCount; ++height)
+    {
+        const quint32 count = qMin<quint32>(mix(params_.seed, TAG_BLOCK_SIZE, height) % (maxPerBlock + 1), params_.transactionCount - generated);
+        generated += count;
+        firstTransaction_ << generated;
+        total_ += blockAmount(height);
+    }
+    genesisTimestamp_ = QDateTime::currentDateTimeUtc().toTime_t() - static_cast<qint64>(topHeight()) * params_.blockInterval;
+}
+
+quint32 SyntheticWallet::topHeight() const
+{
+    return static_cast<quint32>(firstTransaction_.size() - 2);
+}
+
+quint32 SyntheticWallet::transactionCount() const
+{
+    return firstTransaction_.last();
+}
+
+quint64 SyntheticWallet::poolVersion() const
+{
+    return poolVersion_;
+}
+
+void SyntheticWallet::mineBlock()
+{
+    const quint32 height = topHeight() + 1;
+    const quint32 maxPerBlock = 2 * qMax<quint32>(params_.transactionsPerBlock, 1);
+    firstTransaction_ << firstTransaction_.last() + static_cast<quint32>(mix(params_.seed, TAG_BLOCK_SIZE, height) % (maxPerBlock + 1));
+    total_ += blockAmount(height);
+    ++poolVersion_;
+}
+
+quint32 SyntheticWallet::blockTransactionCount(quint32 height) const
+{
+    return firstTransaction_[height + 1] - firstTransaction_[height];
+}
+
+qint64 SyntheticWallet::transactionAmount(quint32 height, quint32 index) const
+{
+    const quint64 random = mix(params_.seed, TAG_TRANSACTION, height, index);
+    // Kept small enough for the total to stay exact in a JSON double
+    if (isCoinbase(random))
+        return BLOCK_REWARD;
+    if (isIncoming(random))
+        return FEE + static_cast<qint64>((random >> 16) % 2000000000);
+    return -FEE - static_cast<qint64>((random >> 16) % 500000000);
+}
+
+qint64 SyntheticWallet::blockAmount(quint32 height) const
+{
+    qint64 amount = 0;
+    for (quint32 i = 0; i < blockTransactionCount(height); ++i)
+        amount += transactionAmount(height, i);
+    return amount;
+}
+
+qint64 SyntheticWallet::blockTimestamp(quint32 height) const
+{
+    return genesisTimestamp_ + static_cast<qint64>(height) * params_.blockInterval;
+}
+
+QString SyntheticWallet::hash(quint64 tag, quint32 height, quint32 index) const
+{
+    QString result;
+    result.reserve(64);
+    for (quint64 word = 0; word < 4; ++word)
+        result += QString("%1").arg(mix(params_.seed, tag, height, (static_cast<quint64>(index) << 2) | word), 16, 16, QChar('0'));
+    return result;
+}
+
+QString SyntheticWallet::blockHash(quint32 height) const
+{
+    return hash(TAG_BLOCK_HASH, height, 0);
+}
+
+QString SyntheticWallet::address(quint64 tag, quint64 index) const
+{
+    QString result;
+    result.reserve(ADDRESS_LENGTH);
+    result += QChar('2');
+    quint64 random = 0;
+    for (int i = 1; i < ADDRESS_LENGTH; ++i)
+    {
+        if (i % 8 == 1)
+            random = mix(params_.seed, tag, index, i);
+        result += QChar(BASE58_ALPHABET[random % 58]);
+        random /= 58;
+    }
+    return result;
+}
+
+QJsonObject SyntheticWallet::blockHeader(quint32 height) const
+{
+    const qint64 timestamp = blockTimestamp(height);
+    QJsonObject header;
+    header.insert("major_version", 4);
+    header.insert("minor_version", 0);
+    header.insert("timestamp", timestamp);
+    header.insert("previous_block_hash", height > 0 ? blockHash(height - 1) : QString(64, QChar('0')));
+    header.insert("binary_nonce", QString("%1").arg(height, 8, 16, QChar('0')));
+    header.insert("height", static_cast<qint64>(height));
+    header.insert("hash", blockHash(height));
+    header.insert("reward", BLOCK_REWARD);
+    header.insert("cumulative_difficulty", static_cast<double>(DIFFICULTY) * (height + 1));
+    header.insert("difficulty", static_cast<double>(DIFFICULTY));
+    header.insert("base_reward", BLOCK_REWARD);
+    header.insert("block_size", 400 + 300 * static_cast<qint64>(blockTransactionCount(height)));
+    header.insert("transactions_size", 300 * static_cast<qint64>(blockTransactionCount(height)));
+    header.insert("already_generated_coins", static_cast<double>(BLOCK_REWARD) * height);
+    header.insert("already_generated_transactions", static_cast<qint64>(height) * 10);
+    header.insert("already_generated_key_outputs", static_cast<qint64>(height) * 30);
+    header.insert("size_median", 10000);
+    header.insert("effective_size_median", 100000);
+    header.insert("block_capacity_vote", 100000);
+    header.insert("block_capacity_vote_median", 100000);
+    header.insert("timestamp_median", timestamp - 6 * static_cast<qint64>(params_.blockInterval));
+    header.insert("transactions_fee", FEE * static_cast<qint64>(blockTransactionCount(height)));
+    return header;
+}
+
+QJsonObject SyntheticWallet::transaction(quint32 height, quint32 index) const
+{
+    const quint64 random = mix(params_.seed, TAG_TRANSACTION, height, index);
+    const qint64 amount = transactionAmount(height, index);
+    const QString transactionHash = hash(TAG_TRANSACTION_HASH, height, index);
+    const bool locked = height + LOCKED_DEPTH > topHeight();
+
+    QJsonArray transfers;
+    QJsonObject ours;
+    ours.insert("address", address(TAG_OUR_ADDRESS, (random >> 40) % qMax<quint32>(params_.addressCount, 1)));
+    ours.insert("amount", amount);
+    ours.insert("ours", true);
+    ours.insert("locked", locked && amount > 0);
+    ours.insert("transaction_hash", transactionHash);
+    transfers << ours;
+    if (amount < 0)
+    {
+        QJsonObject recipient;
+        recipient.insert("address", address(TAG_FOREIGN_ADDRESS, random));
+        recipient.insert("amount", -amount - FEE);
+        recipient.insert("ours", false);
+        recipient.insert("locked", false);
+        recipient.insert("transaction_hash", transactionHash);
+        transfers << recipient;
+    }
+
+    QJsonObject json;
+    json.insert("unlock_block_or_timestamp", 0);
+    json.insert("anonymity", isCoinbase(random) ? 0 : 3);
+    json.insert("hash", transactionHash);
+    json.insert("prefix_hash", hash(TAG_PREFIX_HASH, height, index));
+    json.insert("inputs_hash", hash(TAG_INPUTS_HASH, height, index));
+    json.insert("fee", isCoinbase(random) ? 0 : FEE);
+    json.insert("public_key", hash(TAG_PUBLIC_KEY, height, index));
+    json.insert("extra", QString());
+    json.insert("coinbase", isCoinbase(random));
+    json.insert("amount", amount);
+    json.insert("block_height", static_cast<qint64>(height));
+    json.insert("block_hash", blockHash(height));
+    json.insert("size", 300);
+    json.insert("transfers", transfers);
+    json.insert("timestamp", blockTimestamp(height));
+    return json;
+}
+
+QJsonObject SyntheticWallet::block(quint32 height) const
+{
+    QJsonArray transactions;
+    for (quint32 i = 0; i < blockTransactionCount(height); ++i)
+        transactions << transaction(height, i);
+    QJsonObject json;
+    json.insert("header", blockHeader(height));
+    json.insert("transactions", transactions);
+    return json;
+}
+
+QJsonObject SyntheticWallet::status() const
+{
+    const quint32 top = topHeight();
+    QJsonObject json;
+    json.insert("top_block_hash", blockHash(top));
+    json.insert("transaction_pool_version", static_cast<double>(poolVersion_));
+    json.insert("outgoing_peer_count", 8);
+    json.insert("incoming_peer_count", 0);
+    json.insert("lower_level_error", QString());
+    json.insert("top_block_height", static_cast<qint64>(top));
+    json.insert("top_known_block_height", static_cast<qint64>(top));
+    json.insert("top_block_difficulty", static_cast<double>(DIFFICULTY));
+    json.insert("top_block_cumulative_difficulty", static_cast<double>(DIFFICULTY) * (top + 1));
+    json.insert("top_block_timestamp", blockTimestamp(top));
+    json.insert("top_block_timestamp_median", blockTimestamp(top) - 6 * static_cast<qint64>(params_.blockInterval));
+    json.insert("recommended_max_transaction_size", 100000);
+    json.insert("recommended_fee_per_byte", 100);
+    return json;
+}
+
+bool SyntheticWallet::statusDiffers(const QJsonObject& knownStatus) const
+{
+    // Like walletd, only the fields the caller passed are compared
+    const QJsonObject current = status();
+    for (const char* key : {"top_block_hash", "transaction_pool_version", "outgoing_peer_count", "incoming_peer_count", "lower_level_error"})
+    {
+        const QJsonObject::const_iterator it = knownStatus.constFind(key);
+        if (it != knownStatus.constEnd() && it.value().toVariant() != current.value(key).toVariant())
+            return true;
+    }
+    return false;
+}
+
+QJsonObject SyntheticWallet::walletInfo() const
+{
+    QJsonObject json;
+    json.insert("view_only", false);
+    json.insert("wallet_type", QString("amethyst"));
+    json.insert("can_view_outgoing_addresses", true);
+    json.insert("has_view_secret_key", true);
+    json.insert("wallet_creation_timestamp", genesisTimestamp_);
+    json.insert("first_address", address(TAG_OUR_ADDRESS, 0));
+    json.insert("total_address_count", static_cast<qint64>(params_.addressCount));
+    json.insert("net", QString("main"));
+    return json;
+}
+
+QJsonObject SyntheticWallet::balance() const
+{
+    qint64 locked = 0;
+    quint32 lockedOutputs = 0;
+    for (quint32 height = topHeight() + 1 > LOCKED_DEPTH ? topHeight() + 1 - LOCKED_DEPTH : 0; height <= topHeight(); ++height)
+        for (quint32 i = 0; i < blockTransactionCount(height); ++i)
+        {
+            const qint64 amount = transactionAmount(height, i);
+            if (amount > 0)
+            {
+                locked += amount;
+                ++lockedOutputs;
+            }
+        }
+
+    QJsonObject json;
+    json.insert("spendable", qMax<qint64>(total_ - locked, 0));
+    json.insert("spendable_dust", 0);
+    json.insert("locked_or_unconfirmed", locked);
+    json.insert("spendable_outputs", static_cast<qint64>(transactionCount()));
+    json.insert("spendable_dust_outputs", 0);
+    json.insert("locked_or_unconfirmed_outputs", static_cast<qint64>(lockedOutputs));
+    return json;
+}
+
+QJsonObject SyntheticWallet::walletRecords(quint32 index, quint32 count) const
+{
+    QJsonArray records;
+    for (quint32 i = index; i < params_.addressCount && i - index < count; ++i)
+    {
+        QJsonObject record;
+        record.insert("address", address(TAG_OUR_ADDRESS, i));
+        record.insert("label", i == 0 ? QString() : QString("Address %1").arg(i));
+        record.insert("index", static_cast<qint64>(i));
+        records << record;
+    }
+    QJsonObject json;
+    json.insert("records", records);
+    json.insert("total_count", static_cast<qint64>(params_.addressCount));
+    return json;
+}
+
+QJsonObject SyntheticWallet::transfers(quint32 fromHeight, quint32 toHeight, bool forward, quint32 desiredTransactionCount) const
+{
+    // The range is exclusive on both ends, toHeight is usually the maximum value
+    const quint32 end = static_cast<quint32>(qMin<quint64>(toHeight, static_cast<quint64>(topHeight()) + 1));
+    QJsonArray blocks;
+    quint32 collected = 0;
+    quint32 nextFrom = fromHeight;
+    quint32 nextTo = end;
+    if (forward)
+    {
+        quint32 height = fromHeight + 1;
+        for (; height < end && collected < desiredTransactionCount; ++height)
+            if (blockTransactionCount(height) != 0)
+            {
+                blocks << block(height);
+                collected += blockTransactionCount(height);
+            }
+        nextFrom = height < end ? height - 1 : end;
+    }
+    else
+    {
+        quint32 height = end;
+        for (; height > fromHeight + 1 && collected < desiredTransactionCount; --height)
+            if (blockTransactionCount(height - 1) != 0)
+            {
+                blocks << block(height - 1);
+                collected += blockTransactionCount(height - 1);
+            }
+        nextTo = height > fromHeight + 1 ? height : fromHeight;
+    }
+
+    QJsonObject json;
+    json.insert("blocks", blocks);
+    json.insert("unlocked_transfers", QJsonArray{});
+    json.insert("next_from_height", static_cast<qint64>(nextFrom));
+    json.insert("next_to_height", static_cast<qint64>(nextTo));
+    return json;
+}
+
+}
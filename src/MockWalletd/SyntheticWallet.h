@@ -0,0 +1,65 @@
+// Copyright (c) 2015-2018, The Bytecoin developers.
+// Licensed under the GNU Lesser General Public License. See LICENSE for details.
+
+#pragma once
+
+#include <QJsonObject>
+#include <QString>
+#include <QVector>
+
+namespace MockWalletd {
+
+// A wallet history which is never stored: every block and transaction is derived from
+// the seed and its position, so two runs with the same parameters serve identical data
+// and a million transactions cost only a per-block index in memory.
+class SyntheticWallet
+{
+public:
+    struct Params
+    {
+        quint64 seed = 1;
+        quint32 transactionCount = 10000;
+        quint32 transactionsPerBlock = 2; // on average, some blocks are empty
+        quint32 addressCount = 10;
+        quint32 blockInterval = 120; // seconds between block timestamps
+    };
+
+    explicit SyntheticWallet(const Params& params);
+
+    quint32 topHeight() const;
+    quint32 transactionCount() const;
+    quint64 poolVersion() const;
+
+    void mineBlock(); // appends a block with a few transactions, the pool is emptied into it
+
+    QJsonObject status() const;
+    QJsonObject walletInfo() const;
+    QJsonObject balance() const;
+    QJsonObject walletRecords(quint32 index, quint32 count) const;
+
+    // Blocks strictly between fromHeight and toHeight, walked from toHeight down unless forward.
+    // Stops after the block which brings the count to desiredTransactionCount.
+    QJsonObject transfers(quint32 fromHeight, quint32 toHeight, bool forward, quint32 desiredTransactionCount) const;
+
+    bool statusDiffers(const QJsonObject& knownStatus) const; // the get_status long poll may return
+
+private:
+    quint32 blockTransactionCount(quint32 height) const;
+    qint64 transactionAmount(quint32 height, quint32 index) const;
+    qint64 blockAmount(quint32 height) const;
+    qint64 blockTimestamp(quint32 height) const;
+    QString blockHash(quint32 height) const;
+    QString hash(quint64 tag, quint32 height, quint32 index) const;
+    QString address(quint64 tag, quint64 index) const;
+    QJsonObject blockHeader(quint32 height) const;
+    QJsonObject transaction(quint32 height, quint32 index) const;
+    QJsonObject block(quint32 height) const;
+
+    const Params params_;
+    QVector<quint32> firstTransaction_; // by height, one more entry than blocks
+    qint64 total_; // sum of all transaction amounts
+    quint64 poolVersion_;
+    qint64 genesisTimestamp_;
+};
+
+}
@@ -0,0 +1,50 @@
+// Copyright (c) 2015-2018, The Bytecoin developers.
+// Licensed under the GNU Lesser General Public License. See LICENSE for details.
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+
+#include "Server.h"
+
+namespace {
+
+constexpr quint16 DEFAULT_PORT = 8070; // walletd's own default
+constexpr int DEFAULT_BLOCK_INTERVAL_SEC = 120;
+
+}
+
+int main(int argc, char* argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("mock-walletd");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Serves a synthetic wallet over walletd's JSON-RPC API, for testing the GUI at scale.");
+    parser.addHelpOption();
+    const QCommandLineOption bindOption("bind", "Address to listen on.", "address", "127.0.0.1");
+    const QCommandLineOption portOption("port", "Port to listen on.", "port", QString::number(DEFAULT_PORT));
+    const QCommandLineOption transactionsOption("transactions", "Number of transactions in the history.", "count", "10000");
+    const QCommandLineOption perBlockOption("transactions-per-block", "Average number of transactions in a block.", "count", "2");
+    const QCommandLineOption addressesOption("addresses", "Number of wallet addresses.", "count", "10");
+    const QCommandLineOption seedOption("seed", "Seed of the generator, the same seed gives the same wallet.", "seed", "1");
+    const QCommandLineOption blockIntervalOption("block-interval", "Seconds between new blocks, 0 stops the chain.", "seconds", QString::number(DEFAULT_BLOCK_INTERVAL_SEC));
+    parser.addOptions({bindOption, portOption, transactionsOption, perBlockOption, addressesOption, seedOption, blockIntervalOption});
+    parser.process(app);
+
+    MockWalletd::SyntheticWallet::Params params;
+    params.seed = parser.value(seedOption).toULongLong();
+    params.transactionCount = parser.value(transactionsOption).toUInt();
+    params.transactionsPerBlock = qMax(parser.value(perBlockOption).toUInt(), 1u);
+    params.addressCount = qMax(parser.value(addressesOption).toUInt(), 1u);
+    const int blockIntervalSec = parser.value(blockIntervalOption).toInt();
+    if (blockIntervalSec > 0)
+        params.blockInterval = static_cast<quint32>(blockIntervalSec);
+
+    MockWalletd::Server server(params, blockIntervalSec * 1000);
+    if (!server.listen(QHostAddress(parser.value(bindOption)), static_cast<quint16>(parser.value(portOption).toUInt())))
+    {
+        qCritical("Cannot listen: %s", qPrintable(server.errorString()));
+        return 1;
+    }
+    return app.exec();
+}
@@ -0,0 +1,20 @@
+# Tests of WalletModel over mock-walletd's synthetic wallet
+
+QT       += core gui network widgets testlib
+
+TARGET = walletmodel-test
+TEMPLATE = app
+
+CONFIG += c++14 strict_c++ console testcase
+CONFIG -= app_bundle
+!win32: QMAKE_CXXFLAGS += -std=c++14 -Wall -Wextra -pedantic
+DEFINES += QT_FORCE_ASSERTS
+
+DESTDIR = $$PWD/../../bin
+
+include(../bytecoin-gui.pri)
+
+SOURCES += WalletModelTest.cpp \
+    ../MockWalletd/SyntheticWallet.cpp
+
+HEADERS += ../MockWalletd/SyntheticWallet.h
@@ -0,0 +1,304 @@
+// Copyright (c) 2015-2018, The Bytecoin developers.
+// Licensed under the GNU Lesser General Public License. See LICENSE for details.
+
+#include <algorithm>
+#include <limits>
+#include <memory>
+
+#include <QIdentityProxyModel>
+#include <QStandardPaths>
+#include <QTemporaryDir>
+#include <QtTest>
+
+#include "MockWalletd/SyntheticWallet.h"
+#include "walletmodel.h"
+#include "walletstatemodel.h"
+
+namespace WalletGUI
+{
+
+namespace
+{
+
+constexpr quint32 HISTORY_TRANSACTIONS = 200; // all of it comes with the first reply of 300
+
+// Stands in for a view over WalletModel: reads back once every cell the model reports changed or inserted,
+// as a table repaints them, counts the reads and keeps the spans they came from
+class CountingView : public QIdentityProxyModel
+{
+public:
+    struct Span
+    {
+        enum Kind { CHANGED, INSERTED, REMOVED };
+
+        Kind kind;
+        int firstRow;
+        int lastRow;
+        int firstColumn;
+        int lastColumn;
+
+        int rows() const { return lastRow - firstRow + 1; }
+        bool isHistoryOnly() const { return firstColumn >= WalletModel::COLUMN_UNLOCK_TIME && lastColumn <= WalletModel::COLUMN_PROOF; }
+    };
+
+    explicit CountingView(QAbstractItemModel* model)
+    {
+        setSourceModel(model);
+        connect(this, &QAbstractItemModel::dataChanged, [this](const QModelIndex& topLeft, const QModelIndex& bottomRight)
+        {
+            spans << Span{Span::CHANGED, topLeft.row(), bottomRight.row(), topLeft.column(), bottomRight.column()};
+            repaint(topLeft.row(), bottomRight.row(), topLeft.column(), bottomRight.column());
+        });
+        connect(this, &QAbstractItemModel::rowsInserted, [this](const QModelIndex& /*parent*/, int first, int last)
+        {
+            spans << Span{Span::INSERTED, first, last, WalletModel::COLUMN_UNLOCK_TIME, WalletModel::COLUMN_PROOF};
+            repaint(first, last, WalletModel::COLUMN_UNLOCK_TIME, WalletModel::COLUMN_PROOF);
+        });
+        connect(this, &QAbstractItemModel::rowsRemoved, [this](const QModelIndex& /*parent*/, int first, int last)
+        {
+            spans << Span{Span::REMOVED, first, last, WalletModel::COLUMN_UNLOCK_TIME, WalletModel::COLUMN_PROOF};
+        });
+    }
+
+    virtual QVariant data(const QModelIndex& index, int role) const override
+    {
+        ++reads;
+        return QIdentityProxyModel::data(index, role);
+    }
+
+    void clear()
+    {
+        reads = 0;
+        spans.clear();
+    }
+
+    int count(Span::Kind kind) const
+    {
+        return std::count_if(spans.begin(), spans.end(), [kind](const Span& span) { return span.kind == kind; });
+    }
+
+    mutable int reads = 0;
+    QVector<Span> spans;
+
+private:
+    void repaint(int firstRow, int lastRow, int firstColumn, int lastColumn)
+    {
+        for (int row = firstRow; row <= lastRow; ++row)
+            for (int column = firstColumn; column <= lastColumn; ++column)
+                index(row, column).data(Qt::DisplayRole);
+    }
+};
+
+}
+
+// WalletModel fed by a synthetic wallet the way RemoteWalletd feeds it: every getTransfersSignal is answered
+// at once, block by block through transferBlockReceived() and then the rest of the reply through transfersReceived().
+// Updates are flushed as they come, so each one is seen by the view on its own.
+class WalletModelTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void init();
+    void cleanup();
+
+    void statusTickLeavesHistoryAlone();
+    void repeatedReplyIsQuiet();
+    void newBlockInsertsItsRows();
+    void changedTransactionRepaintsItsRow();
+    void droppedTransactionRemovesItsRow();
+
+private:
+    void answer(const RpcApi::GetTransfers::Request& req, RpcApi::Height topHeight);
+    void reply(const RpcApi::Transfers& transfers, RpcApi::Height fromHeight, RpcApi::Height toHeight);
+    RpcApi::Status status() const;
+    RpcApi::Block blockWithTransactions(int count) const; // the highest one with at least count
+    static int historyCells(int rows) { return rows * (WalletModel::COLUMN_PROOF - WalletModel::COLUMN_UNLOCK_TIME + 1); }
+
+    QTemporaryDir home_;
+    std::unique_ptr<MockWalletd::SyntheticWallet> wallet_;
+    std::unique_ptr<WalletModel> model_;
+    std::unique_ptr<CountingView> view_;
+};
+
+void WalletModelTest::initTestCase()
+{
+    // Nothing the model may save is to end up in the real work directory
+    QVERIFY(home_.isValid());
+    qputenv("HOME", QFile::encodeName(home_.path()));
+    QStandardPaths::setTestModeEnabled(true);
+}
+
+void WalletModelTest::init()
+{
+    MockWalletd::SyntheticWallet::Params params;
+    params.transactionCount = HISTORY_TRANSACTIONS;
+    wallet_.reset(new MockWalletd::SyntheticWallet(params));
+
+    model_.reset(new WalletModel(nullptr));
+    model_->setUpdateInterval(0);
+    connect(model_.get(), &WalletModel::getTransfersSignal, this, &WalletModelTest::answer);
+    view_.reset(new CountingView(model_.get()));
+
+    model_->statusReceived(status());
+    QCOMPARE(model_->rowCount(), static_cast<int>(wallet_->transactionCount()));
+    view_->clear();
+}
+
+void WalletModelTest::cleanup()
+{
+    view_.reset();
+    model_.reset();
+    wallet_.reset();
+}
+
+void WalletModelTest::answer(const RpcApi::GetTransfers::Request& req, RpcApi::Height /*topHeight*/)
+{
+    const quint32 desired = static_cast<quint32>(qMin<quint64>(req.desired_transactions_count, std::numeric_limits<quint32>::max()));
+    const RpcApi::Transfers transfers = RpcApi::Transfers::fromJson(wallet_->transfers(req.from_height, req.to_height, req.forward, desired));
+    reply(transfers, req.from_height, req.to_height);
+}
+
+void WalletModelTest::reply(const RpcApi::Transfers& transfers, RpcApi::Height fromHeight, RpcApi::Height toHeight)
+{
+    const RpcApi::Height topHeight = wallet_->topHeight();
+    for (const RpcApi::Block& block : transfers.blocks)
+        model_->transferBlockReceived(block, topHeight, fromHeight, toHeight);
+    RpcApi::Transfers rest = transfers;
+    rest.blocks.clear();
+    model_->transfersReceived(rest, topHeight, fromHeight, toHeight);
+}
+
+RpcApi::Status WalletModelTest::status() const
+{
+    return RpcApi::Status::fromJson(wallet_->status());
+}
+
+RpcApi::Block WalletModelTest::blockWithTransactions(int count) const
+{
+    const RpcApi::Transfers transfers = RpcApi::Transfers::fromJson(
+                wallet_->transfers(0, wallet_->topHeight() + 1, false, std::numeric_limits<quint32>::max()));
+    for (const RpcApi::Block& block : transfers.blocks)
+        if (block.transactions.size() >= count)
+            return block;
+    return RpcApi::Block();
+}
+
+// A status which only tells of another peer: the status cells of row 0 change, the history is asked for
+// and comes back the same, and no history cell is read again
+void WalletModelTest::statusTickLeavesHistoryAlone()
+{
+    RpcApi::Status tick = status();
+    ++tick.incoming_peer_count;
+    model_->statusReceived(tick);
+
+    QCOMPARE(view_->count(CountingView::Span::INSERTED), 0);
+    QCOMPARE(view_->count(CountingView::Span::REMOVED), 0);
+    QCOMPARE(view_->spans.size(), 1);
+    const CountingView::Span& span = view_->spans.first();
+    QCOMPARE(span.firstRow, 0);
+    QCOMPARE(span.lastRow, 0);
+    QCOMPARE(span.firstColumn, static_cast<int>(WalletModel::COLUMN_TOP_BLOCK_HEIGHT));
+    QCOMPARE(span.lastColumn, static_cast<int>(WalletModel::COLUMN_PEER_COUNT_SUM));
+    QCOMPARE(view_->reads, span.lastColumn - span.firstColumn + 1);
+}
+
+void WalletModelTest::repeatedReplyIsQuiet()
+{
+    const RpcApi::Block block = blockWithTransactions(1);
+    QVERIFY(!block.transactions.isEmpty());
+    RpcApi::Transfers transfers;
+    transfers.blocks << block;
+    reply(transfers, block.header.height - 1, block.header.height + 1);
+
+    QVERIFY(view_->spans.isEmpty());
+    QCOMPARE(view_->reads, 0);
+}
+
+// The rows of a new block go in at the top. Besides them only the status cells of row 0 and the unlock
+// time column, which follows the top block, are repainted. The state model the widget mappers are on
+// keeps its one row and is told of the new top block.
+void WalletModelTest::newBlockInsertsItsRows()
+{
+    const quint32 before = wallet_->transactionCount();
+    while (wallet_->transactionCount() == before)
+        wallet_->mineBlock();
+    const int added = static_cast<int>(wallet_->transactionCount() - before);
+    WalletStateModel* state = model_->getStateModel();
+    int stateChanges = 0;
+    connect(state, &QAbstractItemModel::dataChanged, [&stateChanges](const QModelIndex& topLeft)
+    {
+        QCOMPARE(topLeft.row(), 0);
+        ++stateChanges;
+    });
+    model_->statusReceived(status());
+
+    QCOMPARE(model_->rowCount(), static_cast<int>(wallet_->transactionCount()));
+    QCOMPARE(view_->count(CountingView::Span::REMOVED), 0);
+    QCOMPARE(view_->count(CountingView::Span::INSERTED), 1);
+    int cells = 0;
+    for (const CountingView::Span& span : view_->spans)
+    {
+        if (span.kind == CountingView::Span::INSERTED)
+        {
+            QCOMPARE(span.firstRow, 0);
+            QCOMPARE(span.rows(), added);
+        }
+        else
+        {
+            const bool unlockColumn = span.firstColumn == WalletModel::COLUMN_UNLOCK_TIME && span.lastColumn == WalletModel::COLUMN_UNLOCK_TIME;
+            QVERIFY2(span.lastRow == 0 || unlockColumn, qPrintable(QString("rows %1-%2, columns %3-%4")
+                     .arg(span.firstRow).arg(span.lastRow).arg(span.firstColumn).arg(span.lastColumn)));
+        }
+        cells += span.rows() * (span.lastColumn - span.firstColumn + 1);
+    }
+    QCOMPARE(view_->reads, cells);
+    QVERIFY(view_->reads < historyCells(model_->rowCount()));
+
+    QCOMPARE(state->rowCount(), 1);
+    QVERIFY(stateChanges > 0);
+    QCOMPARE(state->index(0, WalletModel::COLUMN_TOP_BLOCK_HEIGHT).data(WalletModel::ROLE_TOP_BLOCK_HEIGHT).toUInt(), wallet_->topHeight());
+}
+
+// Same hash, new timestamp: one dataChanged on its row and nothing else
+void WalletModelTest::changedTransactionRepaintsItsRow()
+{
+    RpcApi::Block block = blockWithTransactions(1);
+    QVERIFY(!block.transactions.isEmpty());
+    block.transactions.first().timestamp = block.transactions.first().timestamp.addSecs(1);
+    RpcApi::Transfers transfers;
+    transfers.blocks << block;
+    reply(transfers, block.header.height - 1, block.header.height + 1);
+
+    QCOMPARE(view_->spans.size(), 1);
+    const CountingView::Span& span = view_->spans.first();
+    QCOMPARE(span.kind, CountingView::Span::CHANGED);
+    QCOMPARE(span.rows(), 1);
+    QVERIFY(span.isHistoryOnly());
+    QCOMPARE(view_->reads, span.lastColumn - span.firstColumn + 1);
+}
+
+// A transaction gone from its block is one removed row and nothing else, the others in the block are not touched
+void WalletModelTest::droppedTransactionRemovesItsRow()
+{
+    RpcApi::Block block = blockWithTransactions(2);
+    QVERIFY(block.transactions.size() >= 2);
+    block.transactions.removeLast();
+    RpcApi::Transfers transfers;
+    transfers.blocks << block;
+    const int rows = model_->rowCount();
+    reply(transfers, block.header.height - 1, block.header.height + 1);
+
+    QCOMPARE(model_->rowCount(), rows - 1);
+    QCOMPARE(view_->spans.size(), 1);
+    QCOMPARE(view_->spans.first().kind, CountingView::Span::REMOVED);
+    QCOMPARE(view_->spans.first().rows(), 1);
+    QCOMPARE(view_->reads, 0);
+}
+
+}
+
+QTEST_GUILESS_MAIN(WalletGUI::WalletModelTest)
+
+#include "WalletModelTest.moc"
@@ -170,6 +170,7 @@ void MyAddressesManager::connectedToWalletd()
     WalletLogger::debug(tr("[WalletAddressBook] Connected to walletd."));
     firstTime_ = true;
     addressBook_.clear();
+    addressIndexes_.clear();
     requestAddresses();
 }
 
@@ -200,7 +201,7 @@ void MyAddressesManager::walletRecordsReceived(const RpcApi::WalletRecords& reco
     {
         addressBook_ << AddressItem{rec.label, rec.address};
         const AddressIndex index = addressBook_.size() - 1;
-        addressIndexes_[rec.address] = index;
+        addressIndexes_[RpcApi::Address::intern(rec.address)] = index;
 //        WalletLogger::debug(tr("[WalletAddressBook] Wallet record indexed."));
         if (!firstTime_)
             emit addressAddedSignal(index);
@@ -273,7 +274,13 @@ void MyAddressesManager::removeAddress(AddressIndex /*addressIndex*/)
 
 AddressIndex MyAddressesManager::findAddressByAddress(const QString& address) const
 {
-  return addressIndexes_.value(address, INVALID_ADDRESS_INDEX);
+  // An address never interned cannot be among ours, looking it up does not grow the pool
+  return findAddressByAddress(RpcApi::Address::find(address));
+}
+
+AddressIndex MyAddressesManager::findAddressByAddress(RpcApi::Address address) const
+{
+  return address.isEmpty() ? INVALID_ADDRESS_INDEX : addressIndexes_.value(address, INVALID_ADDRESS_INDEX);
 }
 
 
@@ -101,6 +101,7 @@ public:
     virtual void removeAddress(AddressIndex _addressIndex) override;
 
     /*virtual*/ AddressIndex findAddressByAddress(const QString& _address) const /*override*/;
+    AddressIndex findAddressByAddress(RpcApi::Address _address) const; // for addresses taken from transfers
 
     void requestAddresses(quint32 index = 0, quint32 count = std::numeric_limits<quint32>::max());
     void createAddress(const QString& label);
@@ -120,7 +121,7 @@ signals:
 
 private:
     QList<AddressItem> addressBook_;
-    QHash<QString, AddressIndex> addressIndexes_;
+    QHash<RpcApi::Address, AddressIndex> addressIndexes_; // keyed by the same handles the transfers hold
     bool firstTime_;
 
 //    void buildIndexes();
@@ -0,0 +1,83 @@
+// Copyright (c) 2015-2018, The Bytecoin developers.
+// Licensed under the GNU Lesser General Public License. See LICENSE for details.
+
+#include <QHash>
+#include <QReadLocker>
+#include <QReadWriteLock>
+#include <QVector>
+#include <QWriteLocker>
+
+#include "addresspool.h"
+
+namespace RpcApi
+{
+
+namespace
+{
+
+// Addresses are never dropped, a session sees too few of them for that to matter
+struct AddressPool
+{
+    QReadWriteLock lock;
+    QHash<QString, quint32> ids;
+    QVector<QString> addresses{QString()}; // by id, id 0 is the empty address
+};
+
+AddressPool& pool()
+{
+    static AddressPool instance;
+    return instance;
+}
+
+}
+
+/*static*/
+Address Address::intern(const QString& address)
+{
+    if (address.isEmpty())
+        return Address();
+
+    AddressPool& p = pool();
+    {
+        QReadLocker lock(&p.lock);
+        const auto it = p.ids.constFind(address);
+        if (it != p.ids.constEnd())
+            return Address(it.value());
+    }
+
+    QWriteLocker lock(&p.lock);
+    const auto it = p.ids.constFind(address); // may have been added since the read lock was dropped
+    if (it != p.ids.constEnd())
+        return Address(it.value());
+    const quint32 id = static_cast<quint32>(p.addresses.size());
+    p.addresses.append(address);
+    p.ids.insert(address, id);
+    return Address(id);
+}
+
+/*static*/
+Address Address::find(const QString& address)
+{
+    AddressPool& p = pool();
+    QReadLocker lock(&p.lock);
+    return Address(p.ids.value(address, 0));
+}
+
+QString Address::toString() const
+{
+    if (id_ == 0)
+        return QString();
+    AddressPool& p = pool();
+    QReadLocker lock(&p.lock);
+    return p.addresses.at(static_cast<int>(id_));
+}
+
+/*static*/
+int Address::poolSize()
+{
+    AddressPool& p = pool();
+    QReadLocker lock(&p.lock);
+    return p.addresses.size() - 1;
+}
+
+}
@@ -0,0 +1,50 @@
+// Copyright (c) 2015-2018, The Bytecoin developers.
+// Licensed under the GNU Lesser General Public License. See LICENSE for details.
+
+#ifndef ADDRESSPOOL_H
+#define ADDRESSPOOL_H
+
+#include <QMetaType>
+#include <QString>
+
+namespace RpcApi
+{
+
+// Handle of an address in the process-wide intern pool. A wallet sees the same few hundred
+// addresses in every transfer, so each of them is kept once and transfers hold 4 bytes;
+// handles of one address are equal, and comparing them compares integers.
+// Interning may happen on the decoding threads, the pool is locked for that.
+class Address
+{
+public:
+    Address() : id_(0) {} // the empty address
+
+    static Address intern(const QString& address);
+    static Address find(const QString& address); // the empty address unless already interned, never grows the pool
+
+    QString toString() const;
+    bool isEmpty() const { return id_ == 0; }
+    quint32 id() const { return id_; }
+
+    bool operator==(const Address& other) const { return id_ == other.id_; }
+    bool operator!=(const Address& other) const { return id_ != other.id_; }
+    bool operator<(const Address& other) const { return id_ < other.id_; } // pool order, not alphabetical
+
+    static int poolSize();
+
+private:
+    explicit Address(quint32 id) : id_(id) {}
+
+    quint32 id_;
+};
+
+inline uint qHash(const Address& address, uint seed = 0)
+{
+    return address.id() ^ seed;
+}
+
+}
+
+Q_DECLARE_METATYPE(RpcApi::Address)
+
+#endif // ADDRESSPOOL_H
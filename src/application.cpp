@@ -9,6 +9,7 @@
 #include <QMetaEnum>
 #include <QMessageBox>
 #include <QAuthenticator>
+#include <QCommandLineParser>
 
 #include "application.h"
 #include "signalhandler.h"
@@ -19,6 +20,7 @@
 #include "connectselectiondialog.h"
 #include "settings.h"
 #include "JsonRpc/JsonRpcClient.h"
+#include "walletdcapture.h"
 #include "MiningManager.h"
 #include "addressbookmanager.h"
 
@@ -47,6 +49,8 @@ WalletApplication::WalletApplication(int& argc, char** argv)
     , walletModel_(new WalletModel(this))
     , downloader_(new FileDownloader(this))
     , tryToOpenWithEmptyPassword_(false)
+    , recorder_(nullptr)
+    , replayFast_(false)
     , crashDialog_(new CrashDialog())
     , m_isAboutToQuit(false)
 {
@@ -87,6 +91,28 @@ void WalletApplication::loadFonts()
     QApplication::setFont(font);
 }
 
+void WalletApplication::parseCommandLine()
+{
+    QCommandLineParser parser;
+    const QCommandLineOption recordOption("record-walletd", tr("Record walletd traffic to <file>."), "file");
+    const QCommandLineOption replayOption("replay-walletd", tr("Replay walletd traffic recorded in <file> instead of connecting to walletd."), "file");
+    const QCommandLineOption replayFastOption("replay-fast", tr("Replay as fast as possible instead of at the recorded speed."));
+    parser.addOptions({recordOption, replayOption, replayFastOption});
+    parser.parse(arguments()); // unknown options are passed by some platforms, they are not an error
+
+    if (parser.isSet(recordOption))
+    {
+        recorder_ = new WalletdRecorder(parser.value(recordOption), this);
+        if (!recorder_->isOpen())
+        {
+            delete recorder_;
+            recorder_ = nullptr;
+        }
+    }
+    replayFileName_ = parser.value(replayOption);
+    replayFast_ = parser.isSet(replayFastOption);
+}
+
 bool WalletApplication::init()
 {
     const QDir dataDir = Settings::instance().getDefaultWorkDir();
@@ -107,6 +133,8 @@ bool WalletApplication::init()
 
     QObject::connect(&SignalHandler::instance(), &SignalHandler::quitSignal, this, &WalletApplication::quit);
 
+    parseCommandLine();
+
     const bool connectionSelected = Settings::instance().walletdConnectionMethodSet();
     const bool walletFileSet = !Settings::instance().getWalletFile().isEmpty();
     const bool isFirstRun = !connectionSelected || (Settings::instance().getWalletdConnectionMethod() == ConnectionMethod::BUILTIN && !walletFileSet);
@@ -130,6 +158,7 @@ bool WalletApplication::init()
     connect(m_mainWindow, &MainWindow::createProofSignal, this, &WalletApplication::createProof);
     connect(m_mainWindow, &MainWindow::checkProofSignal, this, &WalletApplication::checkProof);
     connect(m_mainWindow, &MainWindow::showWalletdParamsSignal, this, &WalletApplication::showWalletdParams);
+    connect(m_mainWindow, &MainWindow::showRpcStatisticsSignal, this, &WalletApplication::showRpcStatistics);
     connect(m_mainWindow, &MainWindow::exportViewOnlyKeysSignal, this, &WalletApplication::exportViewOnlyKeys);
     connect(m_mainWindow, &MainWindow::exportKeysSignal, this, &WalletApplication::exportKeys);
 
@@ -147,7 +176,7 @@ bool WalletApplication::init()
     connect(downloader_, &FileDownloader::downloaded, this, &WalletApplication::updateReceived);
     connect(this, &WalletApplication::updateIsReadySignal, m_mainWindow, &MainWindow::updateIsReady);
 
-    if(isFirstRun)
+    if(isFirstRun && replayFileName_.isEmpty())
         firstRun();
     else
     {
@@ -178,6 +207,7 @@ void WalletApplication::subscribeToWalletd()
 
     connect(walletd_, &RemoteWalletd::statusReceivedSignal, walletModel_, &WalletModel::statusReceived);
     connect(walletd_, &RemoteWalletd::transfersReceivedSignal, walletModel_, &WalletModel::transfersReceived);
+    connect(walletd_, &RemoteWalletd::transferBlockReceivedSignal, walletModel_, &WalletModel::transferBlockReceived);
     connect(walletd_, &RemoteWalletd::walletInfoReceivedSignal, walletModel_, &WalletModel::walletInfoReceived);
     connect(walletd_, &RemoteWalletd::balanceReceivedSignal, walletModel_, &WalletModel::balanceReceived);
 //    connect(walletd_, &RemoteWalletd::sendTxReceivedSignal, walletModel_, &WalletModel::transactionSent);
@@ -196,6 +226,13 @@ void WalletApplication::subscribeToWalletd()
     connect(walletd_, &RemoteWalletd::packetReceived, m_mainWindow, &MainWindow::packetReceived);
 
     connect(walletd_, &RemoteWalletd::authRequiredSignal, this, &WalletApplication::requestWalletdAuth);
+
+    if (recorder_)
+    {
+        walletd_->setPacketCapture(true);
+        connect(walletd_, &RemoteWalletd::packetSent, recorder_, &WalletdRecorder::packetSent);
+        connect(walletd_, &RemoteWalletd::packetReceived, recorder_, &WalletdRecorder::packetReceived);
+    }
 }
 
 /* static */
@@ -244,7 +281,7 @@ void WalletApplication::sendTx(const RpcApi::SendTransaction::Request& req)
 
 void WalletApplication::sendCreateProof(const QString& txHash, const QString& message, const QStringList& addresses)
 {
-    const RpcApi::CreateSendProof::Request req{txHash, message, addresses};
+    const RpcApi::CreateSendProof::Request req{RpcApi::Hash::fromHex(txHash), message, addresses};
     walletd_->createProof(req);
 }
 
@@ -256,7 +293,9 @@ void WalletApplication::sendCheckProof(const QString& proof)
 
 void WalletApplication::createWalletd()
 {
-    if (Settings::instance().getWalletdConnectionMethod() == ConnectionMethod::BUILTIN)
+    if (!replayFileName_.isEmpty())
+        replayWalletd();
+    else if (Settings::instance().getWalletdConnectionMethod() == ConnectionMethod::BUILTIN)
     {
         const QString& walletFile = Settings::instance().getWalletFile();
         Q_ASSERT(!walletFile.isEmpty());
@@ -399,6 +438,28 @@ void WalletApplication::connectToRemoteWalletd()
     walletd_->run();
 }
 
+void WalletApplication::replayWalletd()
+{
+    if (walletd_)
+    {
+        delete walletd_;
+        walletd_ = nullptr;
+    }
+
+    splashMsg(tr("Replaying walletd traffic..."));
+    ReplayWalletd* walletd = new ReplayWalletd(replayFileName_, replayFast_, this);
+    walletd_ = walletd;
+    subscribeToWalletd();
+
+    connect(walletd, &ReplayWalletd::replayFinishedSignal,
+            [](int packetCount, qint64 msec)
+            {
+                WalletLogger::info(tr("[Application] Replayed %1 walletd packets in %2 msec").arg(packetCount).arg(msec));
+            });
+
+    walletd_->run();
+}
+
 void WalletApplication::createLegacyWallet(QWidget* parent)
 {
     const QString fileName = QFileDialog::getSaveFileName(
@@ -638,6 +699,14 @@ void WalletApplication::showWalletdParams()
     dlg.exec();
 }
 
+void WalletApplication::showRpcStatistics()
+{
+    if (walletd_ == nullptr)
+        return;
+    m_mainWindow->addRpcStatistics(JsonRpc::formatStats(walletd_->getRpcStatistics()) +
+                                   QString("\nCompression saved %1 bytes").arg(walletd_->getRpcBytesSaved()));
+}
+
 void WalletApplication::exportViewOnlyKeys(bool isAmethyst)
 {
     emit exportViewOnlyKeysSignal(m_mainWindow, isAmethyst, QPrivateSignal{});
@@ -28,6 +28,7 @@ class CrashDialog;
 
 class MainWindow;
 class FileDownloader;
+class WalletdRecorder;
 
 class WalletApplication: public QApplication
 {
@@ -52,11 +53,15 @@ private:
     FileDownloader* downloader_;
     QTimer checkForUpdateTimer_;
     bool tryToOpenWithEmptyPassword_;
+    WalletdRecorder* recorder_; // --record-walletd
+    QString replayFileName_; // --replay-walletd
+    bool replayFast_; // --replay-fast
 
     QScopedPointer<CrashDialog> crashDialog_;
     bool m_isAboutToQuit;
 
     void loadFonts();
+    void parseCommandLine();
     static void makeDataDir(const QDir& dataDir);
     void setupTheme();
     void showCoreInitError();
@@ -83,8 +88,10 @@ public slots:
     void sendCheckProof(const QString& proof);
     void restartDaemon();
     void showWalletdParams();
+    void showRpcStatistics();
 
     void connectToRemoteWalletd();
+    void replayWalletd();
 
 
     void createLegacyWallet(QWidget* parent);
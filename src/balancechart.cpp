@@ -0,0 +1,118 @@
+// Copyright (c) 2015-2018, The Bytecoin developers.
+// Licensed under the GNU Lesser General Public License. See LICENSE for details.
+
+#include <algorithm>
+
+#include <QDateTime>
+#include <QPainter>
+#include <QPainterPath>
+
+#include "balancechart.h"
+#include "balanceseries.h"
+#include "walletmodel.h"
+#include "common.h"
+
+namespace WalletGUI {
+
+namespace {
+
+constexpr int CHART_DAYS = 90;
+constexpr qreal VOLUME_SHARE = 0.3; // of the height, at the bottom
+constexpr int MARGIN = 4;
+
+}
+
+BalanceChart::BalanceChart(QWidget* parent)
+    : QWidget(parent)
+    , walletModel_(nullptr)
+{
+    setMinimumSize(200, 80);
+}
+
+BalanceChart::~BalanceChart()
+{}
+
+void BalanceChart::setWalletModel(WalletModel* model)
+{
+    if (walletModel_ != nullptr)
+        disconnect(walletModel_, 0, this, 0);
+    walletModel_ = model;
+    // A repaint is cheap and update() folds them together
+    const auto repaint = [this]() { update(); };
+    connect(walletModel_, &QAbstractItemModel::rowsInserted, this, repaint);
+    connect(walletModel_, &QAbstractItemModel::rowsRemoved, this, repaint);
+    connect(walletModel_, &QAbstractItemModel::dataChanged, this, repaint);
+    connect(walletModel_, &QAbstractItemModel::modelReset, this, repaint);
+    connect(walletModel_, &WalletModel::statusUpdatedSignal, this, repaint);
+    update();
+}
+
+/*virtual*/ void BalanceChart::paintEvent(QPaintEvent* /*event*/)
+{
+    const QRectF area = QRectF(rect()).adjusted(MARGIN, MARGIN, -MARGIN, -MARGIN);
+    if (walletModel_ == nullptr || area.width() <= 0 || area.height() <= 0)
+        return;
+
+    const BalanceSeries& series = walletModel_->getBalanceSeries();
+    const QDate today = QDateTime::currentDateTimeUtc().date();
+    const QDate first = today.addDays(1 - CHART_DAYS);
+    const RpcApi::SignedAmount current = walletModel_->getTotalBalance();
+    const RpcApi::SignedAmount fetched = series.total().net;
+
+    // Balance at the end of a day is the current one less what came after it
+    QVector<RpcApi::SignedAmount> balances(CHART_DAYS);
+    QVector<RpcApi::Amount> volumes(CHART_DAYS, 0);
+    RpcApi::SignedAmount balance = current - (fetched - series.throughDay(first.addDays(-1)).net);
+    const QVector<BalanceSeries::Bucket> days = series.days(first, today);
+    for (int i = 0, b = 0; i < CHART_DAYS; ++i)
+    {
+        if (b < days.size() && days[b].date == first.addDays(i))
+        {
+            balance = current - (fetched - days[b].through.net);
+            volumes[i] = days[b].totals.volume;
+            ++b;
+        }
+        balances[i] = balance;
+    }
+
+    const auto minmax = std::minmax_element(balances.constBegin(), balances.constEnd());
+    const RpcApi::SignedAmount low = *minmax.first;
+    const RpcApi::SignedAmount high = qMax(*minmax.second, low + 1);
+    const RpcApi::Amount maxVolume = qMax<RpcApi::Amount>(*std::max_element(volumes.constBegin(), volumes.constEnd()), 1);
+
+    QPainter painter(this);
+    painter.setRenderHint(QPainter::Antialiasing);
+    const qreal step = area.width() / CHART_DAYS;
+    const qreal volumeHeight = area.height() * VOLUME_SHARE;
+    const qreal balanceHeight = area.height() - volumeHeight;
+
+    painter.setPen(Qt::NoPen);
+    painter.setBrush(palette().color(QPalette::Mid));
+    for (int i = 0; i < CHART_DAYS; ++i)
+    {
+        if (volumes[i] == 0)
+            continue;
+        const qreal height = volumeHeight * volumes[i] / maxVolume;
+        painter.drawRect(QRectF(area.left() + i * step, area.bottom() - height, qMax<qreal>(step - 1, 1), height));
+    }
+
+    QPainterPath path;
+    for (int i = 0; i < CHART_DAYS; ++i)
+    {
+        const qreal y = area.top() + balanceHeight * (high - balances[i]) / (high - low);
+        if (i == 0)
+            path.moveTo(area.left(), y);
+        else
+            path.lineTo(area.left() + i * step, y);
+        path.lineTo(area.left() + (i + 1) * step, y);
+    }
+    painter.setBrush(Qt::NoBrush);
+    painter.setPen(QPen(QColor(MAIN_NET_COLOR), 2));
+    painter.drawPath(path);
+
+    painter.setPen(palette().color(QPalette::Text));
+    painter.drawText(area, Qt::AlignLeft | Qt::AlignTop, formatAmount(*minmax.second));
+    painter.drawText(area.adjusted(0, 0, 0, -volumeHeight), Qt::AlignLeft | Qt::AlignBottom, formatAmount(low));
+}
+
+}
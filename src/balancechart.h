@@ -0,0 +1,35 @@
+// Copyright (c) 2015-2018, The Bytecoin developers.
+// Licensed under the GNU Lesser General Public License. See LICENSE for details.
+
+#ifndef BALANCECHART_H
+#define BALANCECHART_H
+
+#include <QWidget>
+
+namespace WalletGUI {
+
+class WalletModel;
+
+// Balance at the end of each of the last days, with the volume of each day under it.
+// Drawn from the model's BalanceSeries, so a repaint costs one lookup per day with transactions.
+class BalanceChart : public QWidget
+{
+    Q_OBJECT
+    Q_DISABLE_COPY(BalanceChart)
+
+public:
+    explicit BalanceChart(QWidget* parent);
+    virtual ~BalanceChart();
+
+    void setWalletModel(WalletModel* model);
+
+protected:
+    virtual void paintEvent(QPaintEvent* event) override;
+
+private:
+    WalletModel* walletModel_;
+};
+
+}
+
+#endif // BALANCECHART_H
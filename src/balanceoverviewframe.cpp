@@ -9,6 +9,7 @@
 #include "balanceoverviewframe.h"
 #include "ui_balanceoverviewframe.h"
 #include "walletmodel.h"
+#include "walletstatemodel.h"
 #include "popup.h"
 #include "common.h"
 
@@ -70,13 +71,13 @@ void BalanceOverviewFrame::setWalletModel(WalletModel* walletModel)
      if (needToDisconnect)
          disconnect(walletModel_, 0, this, 0); // disconnect all signals from walletModel_ to all our slots
     walletModel_ = walletModel;
-    stateMapper_->setModel(walletModel_); // clears all previously set mappings
+    stateMapper_->setModel(walletModel_->getStateModel()); // clears all previously set mappings
     stateMapper_->addMapping(ui->m_overviewSpendableBalanceLabel, WalletModel::COLUMN_SPENDABLE, "text");
 //    stateMapper_->addMapping(ui->m_overviewSpendableDustBalanceLabel, WalletModel::COLUMN_SPENDABLE_DUST, "text");
     stateMapper_->addMapping(ui->m_overviewLockedOrUnconfirmedBalanceLabel, WalletModel::COLUMN_LOCKED_OR_UNCONFIRMED, "text");
     stateMapper_->addMapping(ui->m_overviewTotalBalanceLabel, WalletModel::COLUMN_TOTAL, "text");
     stateMapper_->toFirst();
-    connect(walletModel_, &QAbstractItemModel::modelReset, stateMapper_, &QDataWidgetMapper::toFirst);
+    connect(walletModel_->getStateModel(), &QAbstractItemModel::modelReset, stateMapper_, &QDataWidgetMapper::toFirst);
     connect(walletModel_, &QAbstractItemModel::dataChanged, this, &BalanceOverviewFrame::balanceChanged);
 }
 
@@ -145,22 +146,22 @@ void BalanceOverviewFrame::copyBalanceString(QString&& balanceString)
 
 void BalanceOverviewFrame::copySpendableBalance()
 {
-    copyBalanceString(walletModel_->index(0, WalletModel::COLUMN_SPENDABLE).data().toString());
+    copyBalanceString(walletModel_->getStateModel()->index(0, WalletModel::COLUMN_SPENDABLE).data().toString());
 }
 
 void BalanceOverviewFrame::copySpendableDustBalance()
 {
-    copyBalanceString(walletModel_->index(0, WalletModel::COLUMN_SPENDABLE_DUST).data().toString());
+    copyBalanceString(walletModel_->getStateModel()->index(0, WalletModel::COLUMN_SPENDABLE_DUST).data().toString());
 }
 
 void BalanceOverviewFrame::copyLockedOrUnconfirmedBalance()
 {
-    copyBalanceString(walletModel_->index(0, WalletModel::COLUMN_LOCKED_OR_UNCONFIRMED).data().toString());
+    copyBalanceString(walletModel_->getStateModel()->index(0, WalletModel::COLUMN_LOCKED_OR_UNCONFIRMED).data().toString());
 }
 
 void BalanceOverviewFrame::copyTotalBalance()
 {
-    copyBalanceString(walletModel_->index(0, WalletModel::COLUMN_TOTAL).data().toString());
+    copyBalanceString(walletModel_->getStateModel()->index(0, WalletModel::COLUMN_TOTAL).data().toString());
 }
 
 
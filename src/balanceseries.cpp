@@ -0,0 +1,232 @@
+// Copyright (c) 2015-2018, The Bytecoin developers.
+// Licensed under the GNU Lesser General Public License. See LICENSE for details.
+
+#include <algorithm>
+
+#include "balanceseries.h"
+#include "txcolumnstore.h"
+#include "txindex.h"
+
+namespace WalletGUI
+{
+
+BalanceSeries::Totals& BalanceSeries::Totals::operator+=(const Totals& other)
+{
+    net += other.net;
+    volume += other.volume;
+    fees += other.fees;
+    count += other.count;
+    return *this;
+}
+
+BalanceSeries::Totals& BalanceSeries::Totals::operator-=(const Totals& other)
+{
+    net -= other.net;
+    volume -= other.volume;
+    fees -= other.fees;
+    count -= other.count;
+    return *this;
+}
+
+void BalanceSeries::Series::add(quint32 key, const Totals& delta)
+{
+    auto it = std::lower_bound(keys_.begin(), keys_.end(), key);
+    const size_t i = it - keys_.begin();
+    if (it == keys_.end() || *it != key)
+    {
+        // Empty yet, its totals are those of the key before it
+        keys_.insert(it, key);
+        sums_.insert(sums_.begin() + i, i > 0 ? sums_[i - 1] : Totals() - base_);
+    }
+
+    // Everything from i on grows by delta
+    if (i < keys_.size() - i)
+    {
+        base_ += delta;
+        for (size_t j = 0; j < i; ++j)
+            sums_[j] -= delta;
+    }
+    else
+        for (size_t j = i; j < sums_.size(); ++j)
+            sums_[j] += delta;
+
+    // Nothing left in it: the totals around it do not change with it gone
+    if (at(i).count == (i > 0 ? at(i - 1).count : 0))
+    {
+        keys_.erase(keys_.begin() + i);
+        sums_.erase(sums_.begin() + i);
+    }
+}
+
+BalanceSeries::Totals BalanceSeries::Series::through(quint32 key) const
+{
+    const size_t i = std::upper_bound(keys_.begin(), keys_.end(), key) - keys_.begin();
+    return i > 0 ? at(i - 1) : Totals();
+}
+
+BalanceSeries::Totals BalanceSeries::Series::total() const
+{
+    return sums_.empty() ? Totals() : at(sums_.size() - 1);
+}
+
+QVector<QPair<quint32, BalanceSeries::Bucket>> BalanceSeries::Series::range(quint32 from, quint32 to) const
+{
+    QVector<QPair<quint32, Bucket>> result;
+    for (size_t i = std::lower_bound(keys_.begin(), keys_.end(), from) - keys_.begin(); i < keys_.size() && keys_[i] <= to; ++i)
+    {
+        Bucket bucket;
+        bucket.through = at(i);
+        bucket.totals = i > 0 ? bucket.through - at(i - 1) : bucket.through;
+        result << qMakePair(keys_[i], bucket);
+    }
+    return result;
+}
+
+void BalanceSeries::Series::clear()
+{
+    keys_.clear();
+    sums_.clear();
+    base_ = Totals();
+}
+
+/*static*/ BalanceSeries::Totals BalanceSeries::totalsOf(RpcApi::SignedAmount net, RpcApi::Amount fee)
+{
+    Totals totals;
+    totals.net = net;
+    totals.volume = net < 0 ? -net : net;
+    totals.fees = net < 0 ? fee : 0;
+    totals.count = 1;
+    return totals;
+}
+
+void BalanceSeries::setStored(const TxColumnStore* store)
+{
+    stored_ = store;
+}
+
+void BalanceSeries::apply(const Contribution& contribution, const Totals& delta)
+{
+    heights_.add(contribution.height, delta);
+    if (contribution.day == 0)
+        return;
+    const QDate date = QDate::fromJulianDay(contribution.day);
+    days_.add(static_cast<quint32>(contribution.day), delta);
+    months_.add(monthKey(date), delta);
+}
+
+void BalanceSeries::add(const RpcApi::Transaction& tx)
+{
+    remove(tx.hash);
+
+    Contribution contribution;
+    contribution.height = tx.block_height;
+    contribution.day = tx.timestamp.isValid() ? tx.timestamp.toUTC().date().toJulianDay() : 0;
+    contribution.totals = totalsOf(TxIndex::amountOf(tx), tx.fee);
+
+    apply(contribution, contribution.totals);
+    contributions_.insert(tx.hash, contribution);
+}
+
+void BalanceSeries::remove(const RpcApi::Hash& hash)
+{
+    const auto it = contributions_.constFind(hash);
+    if (it == contributions_.constEnd())
+        return;
+    apply(*it, Totals() - it->totals);
+    contributions_.erase(it);
+}
+
+void BalanceSeries::clear()
+{
+    heights_.clear();
+    days_.clear();
+    months_.clear();
+    contributions_.clear();
+}
+
+BalanceSeries::Totals BalanceSeries::through(Height height) const
+{
+    return stored_ ? stored_->through(height) + heights_.through(height) : heights_.through(height);
+}
+
+BalanceSeries::Totals BalanceSeries::total() const
+{
+    return stored_ ? stored_->total() + heights_.total() : heights_.total();
+}
+
+BalanceSeries::Totals BalanceSeries::throughDay(const QDate& date) const
+{
+    const Totals added = days_.through(static_cast<quint32>(date.toJulianDay()));
+    return stored_ ? stored_->throughDay(date) + added : added;
+}
+
+// Buckets of the same date are summed, a "through" adds the last one seen on each side
+/*static*/ QVector<BalanceSeries::Bucket> BalanceSeries::merged(const QVector<Bucket>& stored, Totals storedBefore, const QVector<Bucket>& added, Totals addedBefore)
+{
+    QVector<Bucket> result;
+    result.reserve(stored.size() + added.size());
+    int i = 0;
+    int j = 0;
+    while (i < stored.size() || j < added.size())
+    {
+        const bool takeStored = j == added.size() || (i < stored.size() && !(added[j].date < stored[i].date));
+        const bool takeAdded = i == stored.size() || (j < added.size() && !(stored[i].date < added[j].date));
+        Bucket bucket;
+        bucket.date = takeStored ? stored[i].date : added[j].date;
+        if (takeStored)
+        {
+            bucket.totals += stored[i].totals;
+            storedBefore = stored[i++].through;
+        }
+        if (takeAdded)
+        {
+            bucket.totals += added[j].totals;
+            addedBefore = added[j++].through;
+        }
+        bucket.through = storedBefore + addedBefore;
+        result << bucket;
+    }
+    return result;
+}
+
+QVector<BalanceSeries::Bucket> BalanceSeries::days(const QDate& from, const QDate& to) const
+{
+    QVector<Bucket> result;
+    for (auto& day : days_.range(static_cast<quint32>(from.toJulianDay()), static_cast<quint32>(to.toJulianDay())))
+    {
+        day.second.date = QDate::fromJulianDay(day.first);
+        result << day.second;
+    }
+    if (!stored_)
+        return result;
+    const QDate before = from.addDays(-1);
+    return merged(stored_->days(from, to), stored_->throughDay(before), result, days_.through(static_cast<quint32>(before.toJulianDay())));
+}
+
+QVector<BalanceSeries::Bucket> BalanceSeries::months(const QDate& from, const QDate& to) const
+{
+    QVector<Bucket> result;
+    for (auto& month : months_.range(monthKey(from), monthKey(to)))
+    {
+        month.second.date = QDate(month.first / 12, month.first % 12 + 1, 1);
+        result << month.second;
+    }
+    if (!stored_)
+        return result;
+
+    // The store keeps days only, they are summed up by month here
+    const QDate first(from.year(), from.month(), 1);
+    const QDate last = QDate(to.year(), to.month(), 1).addMonths(1).addDays(-1);
+    QVector<Bucket> stored;
+    for (const Bucket& day : stored_->days(first, last))
+    {
+        const QDate month(day.date.year(), day.date.month(), 1);
+        if (stored.isEmpty() || stored.last().date != month)
+            stored << Bucket{month, Totals(), Totals()};
+        stored.last().totals += day.totals;
+        stored.last().through = day.through;
+    }
+    return merged(stored, stored_->throughDay(first.addDays(-1)), result, months_.through(monthKey(first) - 1));
+}
+
+}
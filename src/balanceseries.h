@@ -0,0 +1,104 @@
+// Copyright (c) 2015-2018, The Bytecoin developers.
+// Licensed under the GNU Lesser General Public License. See LICENSE for details.
+
+#ifndef BALANCESERIES_H
+#define BALANCESERIES_H
+
+#include <deque>
+
+#include <QDate>
+#include <QHash>
+#include <QPair>
+#include <QVector>
+
+#include "rpcapi.h"
+
+namespace WalletGUI
+{
+
+class TxColumnStore;
+
+// Running totals of the history by block height, by day and by month, kept up to date by TxList
+// as rows come and go. "Through" totals cover everything fetched up to a point, so a balance at
+// some height is the current balance less what came after it.
+// Rows in a TxColumnStore are summed up by the store, the series adds its own on top of them.
+class BalanceSeries
+{
+public:
+    using Height = RpcApi::Height;
+
+    struct Totals
+    {
+        RpcApi::SignedAmount net = 0; // our transfers, as the history shows them
+        RpcApi::Amount volume = 0; // net amounts regardless of their sign
+        RpcApi::Amount fees = 0; // of the transactions we sent
+        qint64 count = 0;
+
+        Totals& operator+=(const Totals& other);
+        Totals& operator-=(const Totals& other);
+        Totals operator+(const Totals& other) const { Totals result = *this; return result += other; }
+        Totals operator-(const Totals& other) const { Totals result = *this; return result -= other; }
+    };
+
+    struct Bucket
+    {
+        QDate date; // the day, or the first day of the month
+        Totals totals; // within the bucket
+        Totals through; // everything up to the end of the bucket
+    };
+
+    static Totals totalsOf(RpcApi::SignedAmount net, RpcApi::Amount fee); // of one transaction
+
+    void setStored(const TxColumnStore* store); // the rows below those added, null for none
+    void add(const RpcApi::Transaction& tx);
+    void remove(const RpcApi::Hash& hash);
+    void clear();
+
+    // O(log n), and one step per bucket returned
+    Totals through(Height height) const;
+    Totals total() const;
+    Totals throughDay(const QDate& date) const;
+    QVector<Bucket> days(const QDate& from, const QDate& to) const; // days with transactions only
+    QVector<Bucket> months(const QDate& from, const QDate& to) const;
+
+private:
+    // Totals through each of ascending keys. They are kept less base_, so a key below all others is taken
+    // by changing base_ alone; a change in the middle patches whichever side of it is shorter.
+    class Series
+    {
+    public:
+        void add(quint32 key, const Totals& delta); // a key left with no transactions goes
+        Totals through(quint32 key) const;
+        Totals total() const;
+        QVector<QPair<quint32, Bucket>> range(quint32 from, quint32 to) const; // date is left for the caller
+        void clear();
+
+    private:
+        Totals at(size_t i) const { return sums_[i] + base_; }
+
+        std::deque<quint32> keys_;
+        std::deque<Totals> sums_;
+        Totals base_;
+    };
+
+    struct Contribution
+    {
+        Height height;
+        qint64 day; // julian day, 0 for no timestamp
+        Totals totals;
+    };
+
+    static quint32 monthKey(const QDate& date) { return date.year() * 12 + date.month() - 1; }
+    static QVector<Bucket> merged(const QVector<Bucket>& stored, Totals storedBefore, const QVector<Bucket>& added, Totals addedBefore);
+    void apply(const Contribution& contribution, const Totals& delta);
+
+    const TxColumnStore* stored_ = nullptr;
+    Series heights_;
+    Series days_;
+    Series months_;
+    QHash<RpcApi::Hash, Contribution> contributions_; // what each transaction added, to take it back
+};
+
+}
+
+#endif // BALANCESERIES_H
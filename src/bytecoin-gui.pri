@@ -0,0 +1,213 @@
+# The GUI's classes, everything but main(). Included by bytecoin-gui.pro and by the
+# benchmarks and tests, which link the same classes into their own executables.
+
+INCLUDEPATH += $$PWD
+DEPENDPATH += $$PWD
+
+SOURCES += \
+    $$PWD/mainwindow.cpp \
+    $$PWD/signalhandler.cpp \
+    $$PWD/overviewframe.cpp \
+    $$PWD/aboutdialog.cpp \
+    $$PWD/JsonRpc/JsonRpcClient.cpp \
+    $$PWD/JsonRpc/JsonRpcDecodeQueue.cpp \
+    $$PWD/JsonRpc/JsonRpcEncoder.cpp \
+    $$PWD/JsonRpc/JsonRpcInflater.cpp \
+    $$PWD/JsonRpc/JsonRpcNotification.cpp \
+    $$PWD/JsonRpc/JsonRpcObject.cpp \
+    $$PWD/JsonRpc/JsonRpcObjectFactory.cpp \
+    $$PWD/JsonRpc/JsonRpcRequest.cpp \
+    $$PWD/JsonRpc/JsonRpcResponse.cpp \
+    $$PWD/JsonRpc/JsonRpcStats.cpp \
+    $$PWD/JsonRpc/JsonRpcStreamReader.cpp \
+    $$PWD/application.cpp \
+    $$PWD/logger.cpp \
+    $$PWD/okbutton.cpp \
+    $$PWD/statusbar.cpp \
+    $$PWD/windoweditemmodel.cpp \
+    $$PWD/walletmodel.cpp \
+    $$PWD/walletstatemodel.cpp \
+    $$PWD/txlist.cpp \
+    $$PWD/historycache.cpp \
+    $$PWD/txcolumnstore.cpp \
+    $$PWD/historyplanner.cpp \
+    $$PWD/txindex.cpp \
+    $$PWD/balanceseries.cpp \
+    $$PWD/balancechart.cpp \
+    $$PWD/confirmationwindow.cpp \
+    $$PWD/historysortedmodel.cpp \
+    $$PWD/updatescheduler.cpp \
+    $$PWD/sendframe.cpp \
+    $$PWD/transferframe.cpp \
+    $$PWD/resizablescrollarea.cpp \
+    $$PWD/common.cpp \
+    $$PWD/connectionoptionsframe.cpp \
+    $$PWD/settings.cpp \
+    $$PWD/Miner/Miner.cpp \
+    $$PWD/Miner/StratumClient.cpp \
+    $$PWD/Miner/Worker.cpp \
+    $$PWD/MinerDelegate.cpp \
+    $$PWD/MinerModel.cpp \
+    $$PWD/MiningFrame.cpp \
+    $$PWD/MiningManager.cpp \
+    $$PWD/connectselectiondialog.cpp \
+    $$PWD/walletd.cpp \
+    $$PWD/rpcapi.cpp \
+    $$PWD/hash32.cpp \
+    $$PWD/addresspool.cpp \
+    $$PWD/progressbar.cpp \
+    $$PWD/addressbookframe.cpp \
+    $$PWD/addressbookmodel.cpp \
+    $$PWD/addressbooksortedmodel.cpp \
+    $$PWD/newaddressdialog.cpp \
+    $$PWD/addressbookmanager.cpp \
+    $$PWD/balanceoverviewframe.cpp \
+    $$PWD/miningoverviewframe.cpp \
+    $$PWD/crashdialog.cpp \
+    $$PWD/changepassworddialog.cpp \
+    $$PWD/sendconfirmationdialog.cpp \
+    $$PWD/addressbookdialog.cpp \
+    $$PWD/popup.cpp \
+    $$PWD/logframe.cpp \
+    $$PWD/askpassworddialog.cpp \
+    $$PWD/importkeydialog.cpp \
+    $$PWD/questiondialog.cpp \
+    $$PWD/PoolTreeView.cpp \
+    $$PWD/createproofdialog.cpp \
+    $$PWD/checkproofdialog.cpp \
+    $$PWD/walletdparamsdialog.cpp \
+    $$PWD/exportkeydialog.cpp \
+    $$PWD/filedownloader.cpp \
+    $$PWD/version.cpp \
+    $$PWD/mnemonicdialog.cpp \
+    $$PWD/elidedlabel.cpp \
+    $$PWD/walletdcapture.cpp \
+    $$PWD/myaddressesframe.cpp \
+    $$PWD/newmyaddressdialog.cpp
+
+HEADERS  += $$PWD/mainwindow.h \
+    $$PWD/signalhandler.h \
+    $$PWD/overviewframe.h \
+    $$PWD/aboutdialog.h \
+    $$PWD/JsonRpc/JsonRpcClient.h \
+    $$PWD/JsonRpc/JsonRpcDecodeQueue.h \
+    $$PWD/JsonRpc/JsonRpcEncoder.h \
+    $$PWD/JsonRpc/JsonRpcInflater.h \
+    $$PWD/JsonRpc/JsonRpcNotification.h \
+    $$PWD/JsonRpc/JsonRpcObject.h \
+    $$PWD/JsonRpc/JsonRpcObjectFactory.h \
+    $$PWD/JsonRpc/JsonRpcRequest.h \
+    $$PWD/JsonRpc/JsonRpcResponse.h \
+    $$PWD/JsonRpc/JsonRpcStats.h \
+    $$PWD/JsonRpc/JsonRpcStreamReader.h \
+    $$PWD/application.h \
+    $$PWD/logger.h \
+    $$PWD/okbutton.h \
+    $$PWD/statusbar.h \
+    $$PWD/windoweditemmodel.h \
+    $$PWD/walletmodel.h \
+    $$PWD/walletstatemodel.h \
+    $$PWD/txlist.h \
+    $$PWD/historycache.h \
+    $$PWD/txcolumnstore.h \
+    $$PWD/historyplanner.h \
+    $$PWD/txindex.h \
+    $$PWD/balanceseries.h \
+    $$PWD/balancechart.h \
+    $$PWD/confirmationwindow.h \
+    $$PWD/historysortedmodel.h \
+    $$PWD/updatescheduler.h \
+    $$PWD/sendframe.h \
+    $$PWD/transferframe.h \
+    $$PWD/resizablescrollarea.h \
+    $$PWD/common.h \
+    $$PWD/connectionoptionsframe.h \
+    $$PWD/settings.h \
+    $$PWD/Miner/Miner.h \
+    $$PWD/Miner/StratumClient.h \
+    $$PWD/Miner/Worker.h \
+    $$PWD/MinerDelegate.h \
+    $$PWD/MinerModel.h \
+    $$PWD/MiningFrame.h \
+    $$PWD/MiningManager.h \
+    $$PWD/IMinerWorker.h \
+    $$PWD/IMiningManager.h \
+    $$PWD/IPoolClient.h \
+    $$PWD/IPoolMiner.h \
+    $$PWD/connectselectiondialog.h \
+    $$PWD/walletd.h \
+    $$PWD/rpcapi.h \
+    $$PWD/hash32.h \
+    $$PWD/addresspool.h \
+    $$PWD/progressbar.h \
+    $$PWD/addressbookframe.h \
+    $$PWD/addressbookmodel.h \
+    $$PWD/addressbooksortedmodel.h \
+    $$PWD/newaddressdialog.h \
+    $$PWD/addressbookmanager.h \
+    $$PWD/balanceoverviewframe.h \
+    $$PWD/miningoverviewframe.h \
+    $$PWD/crashdialog.h \
+    $$PWD/changepassworddialog.h \
+    $$PWD/sendconfirmationdialog.h \
+    $$PWD/addressbookdialog.h \
+    $$PWD/popup.h \
+    $$PWD/logframe.h \
+    $$PWD/askpassworddialog.h \
+    $$PWD/importkeydialog.h \
+    $$PWD/questiondialog.h \
+    $$PWD/PoolTreeView.h \
+    $$PWD/createproofdialog.h \
+    $$PWD/checkproofdialog.h \
+    $$PWD/walletdparamsdialog.h \
+    $$PWD/exportkeydialog.h \
+    $$PWD/version.h \
+    $$PWD/filedownloader.h \
+    $$PWD/mnemonicdialog.h \
+    $$PWD/elidedlabel.h \
+    $$PWD/walletdcapture.h \
+    $$PWD/myaddressesframe.h \
+    $$PWD/newmyaddressdialog.h
+
+FORMS    += $$PWD/mainwindow.ui \
+    $$PWD/overviewframe.ui \
+    $$PWD/aboutdialog.ui \
+    $$PWD/sendframe.ui \
+    $$PWD/transferframe.ui \
+    $$PWD/connectionoptionsframe.ui \
+    $$PWD/optionsdialog.ui \
+    $$PWD/MiningFrame.ui \
+    $$PWD/connectselectiondialog.ui \
+    $$PWD/addressbookframe.ui \
+    $$PWD/newaddressdialog.ui \
+    $$PWD/balanceoverviewframe.ui \
+    $$PWD/miningoverviewframe.ui \
+    $$PWD/crashdialog.ui \
+    $$PWD/changepassworddialog.ui \
+    $$PWD/addressbookdialog.ui \
+    $$PWD/logframe.ui \
+    $$PWD/askpassworddialog.ui \
+    $$PWD/importkeydialog.ui \
+    $$PWD/questiondialog.ui \
+    $$PWD/createproofdialog.ui \
+    $$PWD/checkproofdialog.ui \
+    $$PWD/walletdparamsdialog.ui \
+    $$PWD/exportkeydialog.ui \
+    $$PWD/mnemonicdialog.ui \
+    $$PWD/myaddressesframe.ui \
+    $$PWD/newmyaddressdialog.ui
+
+RESOURCES += \
+    $$PWD/resources.qrc
+
+unix|win32: LIBS += -L$$PWD/../../bytecoin/libs/ -lbytecoin-crypto
+
+INCLUDEPATH += $$PWD/../../bytecoin/src
+DEPENDPATH += $$PWD/../../bytecoin/src
+
+# zlib for compressed walletd replies; Windows builds of Qt carry it in QtCore
+win32: INCLUDEPATH += $$[QT_INSTALL_HEADERS]/QtZlib
+else: LIBS += -lz
+
+win32:!win32-g++: PRE_TARGETDEPS += $$PWD/../../bytecoin/libs/bytecoin-crypto.lib
+else:unix|win32-g++: PRE_TARGETDEPS += $$PWD/../../bytecoin/libs/libbytecoin-crypto.a
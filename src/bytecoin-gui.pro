@@ -56,172 +56,10 @@ QMAKE_EXTRA_TARGETS += first copywalletd copybytecoind
 #export(copywalletd.commands)
 #export(copybytecoind.commands)
 
-SOURCES += main.cpp\
-    mainwindow.cpp \
-    signalhandler.cpp \
-    overviewframe.cpp \
-    aboutdialog.cpp \
-    JsonRpc/JsonRpcClient.cpp \
-    JsonRpc/JsonRpcNotification.cpp \
-    JsonRpc/JsonRpcObject.cpp \
-    JsonRpc/JsonRpcObjectFactory.cpp \
-    JsonRpc/JsonRpcRequest.cpp \
-    JsonRpc/JsonRpcResponse.cpp \
-    application.cpp \
-    logger.cpp \
-    okbutton.cpp \
-    statusbar.cpp \
-    windoweditemmodel.cpp \
-    walletmodel.cpp \
-    sendframe.cpp \
-    transferframe.cpp \
-    resizablescrollarea.cpp \
-    common.cpp \
-    connectionoptionsframe.cpp \
-    settings.cpp \
-    Miner/Miner.cpp \
-    Miner/StratumClient.cpp \
-    Miner/Worker.cpp \
-    MinerDelegate.cpp \
-    MinerModel.cpp \
-    MiningFrame.cpp \
-    MiningManager.cpp \
-    connectselectiondialog.cpp \
-    walletd.cpp \
-    rpcapi.cpp \
-    progressbar.cpp \
-    addressbookframe.cpp \
-    addressbookmodel.cpp \
-    addressbooksortedmodel.cpp \
-    newaddressdialog.cpp \
-    addressbookmanager.cpp \
-    balanceoverviewframe.cpp \
-    miningoverviewframe.cpp \
-    crashdialog.cpp \
-    changepassworddialog.cpp \
-    sendconfirmationdialog.cpp \
-    addressbookdialog.cpp \
-    popup.cpp \
-    logframe.cpp \
-    askpassworddialog.cpp \
-    importkeydialog.cpp \
-    questiondialog.cpp \
-    PoolTreeView.cpp \
-    createproofdialog.cpp \
-    checkproofdialog.cpp \
-    walletdparamsdialog.cpp \
-    exportkeydialog.cpp \
-    filedownloader.cpp \
-    version.cpp \
-    mnemonicdialog.cpp \
-    elidedlabel.cpp \
-    myaddressesframe.cpp \
-    newmyaddressdialog.cpp
+SOURCES += main.cpp
 
-HEADERS  += mainwindow.h \
-    signalhandler.h \
-    overviewframe.h \
-    aboutdialog.h \
-    JsonRpc/JsonRpcClient.h \
-    JsonRpc/JsonRpcNotification.h \
-    JsonRpc/JsonRpcObject.h \
-    JsonRpc/JsonRpcObjectFactory.h \
-    JsonRpc/JsonRpcRequest.h \
-    JsonRpc/JsonRpcResponse.h \
-    application.h \
-    logger.h \
-    okbutton.h \
-    statusbar.h \
-    windoweditemmodel.h \
-    walletmodel.h \
-    sendframe.h \
-    transferframe.h \
-    resizablescrollarea.h \
-    common.h \
-    connectionoptionsframe.h \
-    settings.h \
-    Miner/Miner.h \
-    Miner/StratumClient.h \
-    Miner/Worker.h \
-    MinerDelegate.h \
-    MinerModel.h \
-    MiningFrame.h \
-    MiningManager.h \
-    IMinerWorker.h \
-    IMiningManager.h \
-    IPoolClient.h \
-    IPoolMiner.h \
-    connectselectiondialog.h \
-    walletd.h \
-    rpcapi.h \
-    progressbar.h \
-    addressbookframe.h \
-    addressbookmodel.h \
-    addressbooksortedmodel.h \
-    newaddressdialog.h \
-    addressbookmanager.h \
-    balanceoverviewframe.h \
-    miningoverviewframe.h \
-    crashdialog.h \
-    changepassworddialog.h \
-    sendconfirmationdialog.h \
-    addressbookdialog.h \
-    popup.h \
-    logframe.h \
-    askpassworddialog.h \
-    importkeydialog.h \
-    questiondialog.h \
-    PoolTreeView.h \
-    createproofdialog.h \
-    checkproofdialog.h \
-    walletdparamsdialog.h \
-    exportkeydialog.h \
-    version.h \
-    filedownloader.h \
-    mnemonicdialog.h \
-    elidedlabel.h \
-    myaddressesframe.h \
-    newmyaddressdialog.h
-
-FORMS    += mainwindow.ui \
-    overviewframe.ui \
-    aboutdialog.ui \
-    sendframe.ui \
-    transferframe.ui \
-    connectionoptionsframe.ui \
-    optionsdialog.ui \
-    MiningFrame.ui \
-    connectselectiondialog.ui \
-    addressbookframe.ui \
-    newaddressdialog.ui \
-    balanceoverviewframe.ui \
-    miningoverviewframe.ui \
-    crashdialog.ui \
-    changepassworddialog.ui \
-    addressbookdialog.ui \
-    logframe.ui \
-    askpassworddialog.ui \
-    importkeydialog.ui \
-    questiondialog.ui \
-    createproofdialog.ui \
-    checkproofdialog.ui \
-    walletdparamsdialog.ui \
-    exportkeydialog.ui \
-    mnemonicdialog.ui \
-    myaddressesframe.ui \
-    newmyaddressdialog.ui
-
-RESOURCES += \
-    resources.qrc \
-
-
-unix|win32: LIBS += -L$$PWD/../../bytecoin/libs/ -lbytecoin-crypto
-
-INCLUDEPATH += $$PWD/../../bytecoin/src
-DEPENDPATH += $$PWD/../../bytecoin/src
-
-win32:!win32-g++: PRE_TARGETDEPS += $$PWD/../../bytecoin/libs/bytecoin-crypto.lib
-else:unix|win32-g++: PRE_TARGETDEPS += $$PWD/../../bytecoin/libs/libbytecoin-crypto.a
+# Everything else is shared with the benchmarks and tests
+include(bytecoin-gui.pri)
 
 # to add necessary dependencies,
 # 1. delete built bytecoin-gui.app to delete old dependencies (dylibs and frameworks)
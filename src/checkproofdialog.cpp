@@ -84,7 +84,7 @@ void CheckProofDialog::showCheckResult(const RpcApi::ProofCheck& result)
         ui->messageLabel->setText(result.message);
         ui->amountLabel->setText(formatAmount(result.amount));
         ui->addressLabel->setText(result.address);
-        ui->txHashLabel->setText(result.transaction_hash);
+        ui->txHashLabel->setText(result.transaction_hash.toHex());
     }
 }
 
@@ -0,0 +1,126 @@
+// Copyright (c) 2015-2018, The Bytecoin developers.
+// Licensed under the GNU Lesser General Public License. See LICENSE for details.
+
+#include <limits>
+
+#include "confirmationwindow.h"
+#include "txlist.h"
+
+namespace WalletGUI
+{
+
+namespace
+{
+
+constexpr RpcApi::Height MIN_WALK_BACK_BLOCKS = 16;
+
+}
+
+void ConfirmationWindow::remember(Height height, const RpcApi::Hash& hash)
+{
+    if (height > TxList::confirmationThreshold(topHeight_) && !hash.isNull())
+        hashes_.insert(height, hash);
+}
+
+ConfirmationWindow::Height ConfirmationWindow::statusChanged(Height topHeight, const RpcApi::Hash& topHash, Height fallback)
+{
+    // Another hash at a known height, or a lower top: the chain switched at or below it
+    const auto it = hashes_.constFind(topHeight);
+    if (it != hashes_.constEnd() && *it != topHash)
+        forkFound(topHeight);
+    else if (topHeight < topHeight_)
+        forkFound(topHeight + 1);
+
+    topHeight_ = topHeight;
+    while (!hashes_.isEmpty() && hashes_.lastKey() > topHeight) // of the chain left behind
+        hashes_.remove(hashes_.lastKey());
+    const Height threshold = TxList::confirmationThreshold(topHeight);
+    while (!hashes_.isEmpty() && hashes_.firstKey() <= threshold)
+        hashes_.erase(hashes_.begin());
+    remember(topHeight, topHash);
+
+    if (goodHeight_ == 0)
+        return fallback;
+    // The block the history was good at is asked for again, a switch right at it shows there
+    return goodHeight_ - 1;
+}
+
+void ConfirmationWindow::blockReceived(const RpcApi::BlockHeader& header)
+{
+    if (header.hash.isNull() || header.height == 0)
+        return;
+    auto it = hashes_.constFind(header.height);
+    if (it != hashes_.constEnd() && *it != header.hash)
+        forkFound(header.height);
+    it = hashes_.constFind(header.height - 1);
+    if (it != hashes_.constEnd() && *it != header.previous_block_hash)
+        forkFound(header.height - 1);
+    remember(header.height, header.hash);
+    remember(header.height - 1, header.previous_block_hash);
+}
+
+void ConfirmationWindow::forkFound(Height height)
+{
+    if (height == 0)
+        return;
+    if (forkHeight_ == 0 || height < forkHeight_)
+        forkHeight_ = height;
+    forkTop_ = qMax(forkTop_, topHeight_);
+    if (goodHeight_ >= height)
+        goodHeight_ = height - 1;
+}
+
+void ConfirmationWindow::reset()
+{
+    hashes_.clear();
+    topHeight_ = 0;
+    goodHeight_ = 0;
+    forkHeight_ = 0;
+    forkTop_ = 0;
+    walkBack_ = Range(0, 0);
+    walkBlocks_ = 0;
+}
+
+bool ConfirmationWindow::owns(Height from_height, Height to_height) const
+{
+    return to_height == std::numeric_limits<Height>::max() ||
+        (walkBack_.second != 0 && walkBack_ == Range(from_height, to_height));
+}
+
+bool ConfirmationWindow::replyReceived(Height from_height, Height to_height, Height topHeight, Range& next)
+{
+    const bool walk = walkBack_.second != 0 && walkBack_ == Range(from_height, to_height);
+    if (walk)
+        walkBack_ = Range(0, 0);
+    if (forkHeight_ == 0)
+    {
+        // A walk back reply says nothing about the heights above it
+        if (!walk)
+            goodHeight_ = topHeight;
+        return false;
+    }
+    if (walkBack_.second != 0)
+        return false; // the walk in flight goes on from there
+
+    if (forkHeight_ > from_height + 1 || from_height == 0)
+    {
+        // Nothing changed at the lowest height asked for, the fork is above it
+        lastReorgDepth_ = forkTop_ >= forkHeight_ ? forkTop_ - forkHeight_ + 1 : 1;
+        maxReorgDepth_ = qMax(maxReorgDepth_, lastReorgDepth_);
+        ++reorgCount_;
+        qDebug("[ConfirmationWindow] Reorganization %u blocks deep, the history changed from height %u on.", lastReorgDepth_, forkHeight_);
+        forkHeight_ = 0;
+        forkTop_ = 0;
+        walkBlocks_ = 0;
+        goodHeight_ = topHeight;
+        return false;
+    }
+
+    walkBlocks_ = walkBlocks_ == 0 ? MIN_WALK_BACK_BLOCKS : 2 * walkBlocks_;
+    const Height below = from_height > walkBlocks_ ? from_height - walkBlocks_ : 0;
+    walkBack_ = Range(qMin(below, forkHeight_ > 2 ? forkHeight_ - 2 : 0), from_height + 1);
+    next = walkBack_;
+    return true;
+}
+
+}
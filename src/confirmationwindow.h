@@ -0,0 +1,57 @@
+// Copyright (c) 2015-2018, The Bytecoin developers.
+// Licensed under the GNU Lesser General Public License. See LICENSE for details.
+
+#ifndef CONFIRMATIONWINDOW_H
+#define CONFIRMATIONWINDOW_H
+
+#include <QMap>
+#include <QPair>
+
+#include "rpcapi.h"
+
+namespace WalletGUI
+{
+
+// Block hashes by height above the confirmed history, as status updates and transfer replies show them.
+// A new top needs the history again only above the height it was last known good at. When a block turns
+// out to be replaced, the history is asked for further back, twice as far each time, until the lowest
+// height of a reply comes back unchanged. Heights are exclusive on both ends, as in get_transfers.
+class ConfirmationWindow
+{
+public:
+    using Height = RpcApi::Height;
+    using Range = QPair<Height, Height>; // (from_height, to_height)
+
+    // from_height to ask (from_height, max) with, fallback while nothing is known good yet
+    Height statusChanged(Height topHeight, const RpcApi::Hash& topHash, Height fallback);
+    void blockReceived(const RpcApi::BlockHeader& header);
+    void forkFound(Height height); // a block of the history at height got replaced or dropped
+    void reset();
+
+    bool owns(Height from_height, Height to_height) const; // a window or walk back request
+    // A reply for the top at topHeight is in. True if the fork may go below from_height, with the range to ask next.
+    bool replyReceived(Height from_height, Height to_height, Height topHeight, Range& next);
+
+    Height lastReorgDepth() const { return lastReorgDepth_; }
+    Height maxReorgDepth() const { return maxReorgDepth_; }
+    int reorgCount() const { return reorgCount_; }
+
+private:
+    void remember(Height height, const RpcApi::Hash& hash);
+
+    QMap<Height, RpcApi::Hash> hashes_; // above the confirmation threshold only
+    Height topHeight_ = 0;
+    Height goodHeight_ = 0; // the history matched walletd up to it, 0 for not known
+    Height forkHeight_ = 0; // lowest height found replaced since, 0 for none
+    Height forkTop_ = 0; // the top when it was found
+    Range walkBack_{0, 0}; // in flight, to_height 0 for none
+    Height walkBlocks_ = 0;
+
+    Height lastReorgDepth_ = 0;
+    Height maxReorgDepth_ = 0;
+    int reorgCount_ = 0;
+};
+
+}
+
+#endif // CONFIRMATIONWINDOW_H
@@ -67,6 +67,9 @@ void ConnectionOptionsFrame::load()
         m_ui->m_remoteHostEdit->setText(remoteUrl.host());
         m_ui->m_remotePortSpin->setValue(remoteUrl.port());
     }
+    // Combo items follow RpcCompression
+    m_ui->m_compressionCombo->setCurrentIndex(static_cast<int>(Settings::instance().getWalletdCompression(
+            QString("%1:%2").arg(m_ui->m_remoteHostEdit->text()).arg(m_ui->m_remotePortSpin->value()))));
     remoteHostNameChanged(m_ui->m_remoteHostEdit->text());
 }
 
@@ -74,6 +77,9 @@ void ConnectionOptionsFrame::save()
 {
     Settings::instance().setWalletdConnectionMethod(ConnectionMethod::REMOTE);
     Settings::instance().setRemoteWalletdEndPoint(m_ui->m_remoteHostEdit->text(), m_ui->m_remotePortSpin->value());
+    Settings::instance().setWalletdCompression(
+            QString("%1:%2").arg(m_ui->m_remoteHostEdit->text()).arg(m_ui->m_remotePortSpin->value()),
+            static_cast<RpcCompression>(m_ui->m_compressionCombo->currentIndex()));
 
     switch (Settings::instance().getWalletdConnectionMethod())
     {
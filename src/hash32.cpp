@@ -0,0 +1,87 @@
+// Copyright (c) 2015-2018, The Bytecoin developers.
+// Licensed under the GNU Lesser General Public License. See LICENSE for details.
+
+#include "hash32.h"
+
+namespace RpcApi
+{
+
+namespace
+{
+
+int hexDigitValue(ushort c)
+{
+    if (c >= '0' && c <= '9')
+        return c - '0';
+    if (c >= 'a' && c <= 'f')
+        return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F')
+        return c - 'A' + 10;
+    return -1;
+}
+
+}
+
+constexpr int Hash32::SIZE;
+
+/*static*/
+Hash32 Hash32::fromHex(const QString& hex, bool* ok)
+{
+    Hash32 result;
+    if (ok)
+        *ok = hex.isEmpty();
+    if (hex.size() != 2 * SIZE)
+        return result;
+
+    const QChar* digits = hex.constData();
+    for (int i = 0; i < SIZE; ++i)
+    {
+        const int high = hexDigitValue(digits[2 * i].unicode());
+        const int low = hexDigitValue(digits[2 * i + 1].unicode());
+        if (high < 0 || low < 0)
+            return Hash32();
+        result.bytes_[i] = static_cast<uchar>((high << 4) | low);
+    }
+    if (ok)
+        *ok = true;
+    return result;
+}
+
+/*static*/
+Hash32 Hash32::fromBytes(const uchar* bytes)
+{
+    Hash32 result;
+    std::memcpy(result.bytes_.data(), bytes, SIZE);
+    return result;
+}
+
+QString Hash32::toHex() const
+{
+    static const char hexDigits[] = "0123456789abcdef";
+    QString result(2 * SIZE, Qt::Uninitialized);
+    QChar* out = result.data();
+    for (const uchar byte : bytes_)
+    {
+        *out++ = QLatin1Char(hexDigits[byte >> 4]);
+        *out++ = QLatin1Char(hexDigits[byte & 0xf]);
+    }
+    return result;
+}
+
+bool Hash32::isNull() const
+{
+    for (const uchar byte : bytes_)
+        if (byte != 0)
+            return false;
+    return true;
+}
+
+uint qHash(const Hash32& hash, uint seed)
+{
+    // The bytes are a hash already, any word of them is spread well enough
+    uint value;
+    std::memcpy(&value, hash.data(), sizeof(value));
+    return value ^ seed;
+}
+
+}
@@ -0,0 +1,51 @@
+// Copyright (c) 2015-2018, The Bytecoin developers.
+// Licensed under the GNU Lesser General Public License. See LICENSE for details.
+
+#ifndef HASH32_H
+#define HASH32_H
+
+#include <array>
+#include <cstring>
+
+#include <QMetaType>
+#include <QString>
+
+namespace RpcApi
+{
+
+// 32 raw bytes of a hash or a public key, as walletd sends them in 64 hex digits.
+// Parsed once when a reply is decoded and turned back into hex only for display,
+// a history entry keeps 32 bytes per hash instead of a 64-character QString.
+class Hash32
+{
+public:
+    static constexpr int SIZE = 32;
+
+    Hash32() // all zeroes, which is also what an empty string parses to
+    {
+        bytes_.fill(0);
+    }
+
+    // 64 hex digits in either case, or empty. Anything else gives a null hash and ok == false.
+    static Hash32 fromHex(const QString& hex, bool* ok = nullptr);
+    static Hash32 fromBytes(const uchar* bytes); // SIZE raw bytes, as data() gives them
+    QString toHex() const;
+
+    bool isNull() const;
+    const uchar* data() const { return bytes_.data(); }
+
+    bool operator==(const Hash32& other) const { return std::memcmp(bytes_.data(), other.bytes_.data(), SIZE) == 0; }
+    bool operator!=(const Hash32& other) const { return !(*this == other); }
+    bool operator<(const Hash32& other) const { return std::memcmp(bytes_.data(), other.bytes_.data(), SIZE) < 0; }
+
+private:
+    std::array<uchar, SIZE> bytes_;
+};
+
+uint qHash(const Hash32& hash, uint seed = 0);
+
+}
+
+Q_DECLARE_METATYPE(RpcApi::Hash32)
+
+#endif // HASH32_H
@@ -0,0 +1,160 @@
+// Copyright (c) 2015-2018, The Bytecoin developers.
+// Licensed under the GNU Lesser General Public License. See LICENSE for details.
+
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+
+#include "historycache.h"
+#include "settings.h"
+
+namespace WalletGUI
+{
+
+namespace
+{
+
+constexpr quint32 HISTORY_MAGIC = 0x42434e48; // "BCNH"
+constexpr quint16 HISTORY_VERSION = 1;
+constexpr QDataStream::Version HISTORY_STREAM_VERSION = QDataStream::Qt_5_6;
+constexpr char HISTORY_DIR[] = "history";
+constexpr quint32 MAX_RESERVE = 1 << 20; // counts come from the file, a broken one must not make us allocate gigabytes
+
+void writeHash(QDataStream& stream, const RpcApi::Hash& hash)
+{
+    stream.writeRawData(reinterpret_cast<const char*>(hash.data()), RpcApi::Hash::SIZE);
+}
+
+RpcApi::Hash readHash(QDataStream& stream)
+{
+    uchar bytes[RpcApi::Hash::SIZE];
+    if (stream.readRawData(reinterpret_cast<char*>(bytes), RpcApi::Hash::SIZE) != RpcApi::Hash::SIZE)
+    {
+        stream.setStatus(QDataStream::ReadPastEnd);
+        return RpcApi::Hash();
+    }
+    return RpcApi::Hash::fromBytes(bytes);
+}
+
+void writeTransaction(QDataStream& stream, const RpcApi::Transaction& tx)
+{
+    stream << tx.unlock_block_or_timestamp << static_cast<quint32>(tx.transfers.size());
+    for (const RpcApi::Transfer& tr : tx.transfers)
+    {
+        stream << tr.address.toString() << tr.amount << tr.ours << tr.locked;
+        writeHash(stream, tr.transaction_hash);
+    }
+    stream << tx.payment_id << tx.anonymity;
+    writeHash(stream, tx.hash);
+    writeHash(stream, tx.prefix_hash);
+    writeHash(stream, tx.inputs_hash);
+    stream << tx.fee;
+    writeHash(stream, tx.public_key);
+    stream << tx.extra << tx.coinbase << tx.amount << tx.block_height;
+    writeHash(stream, tx.block_hash);
+    stream << tx.timestamp << tx.size;
+}
+
+bool readTransaction(QDataStream& stream, RpcApi::Transaction& tx)
+{
+    quint32 transferCount = 0;
+    stream >> tx.unlock_block_or_timestamp >> transferCount;
+    tx.transfers.reserve(qMin(transferCount, MAX_RESERVE));
+    for (quint32 i = 0; i < transferCount && stream.status() == QDataStream::Ok; ++i)
+    {
+        RpcApi::Transfer tr;
+        QString address;
+        stream >> address >> tr.amount >> tr.ours >> tr.locked;
+        tr.address = RpcApi::Address::intern(address);
+        tr.transaction_hash = readHash(stream);
+        tx.transfers << tr;
+    }
+    stream >> tx.payment_id >> tx.anonymity;
+    tx.hash = readHash(stream);
+    tx.prefix_hash = readHash(stream);
+    tx.inputs_hash = readHash(stream);
+    stream >> tx.fee;
+    tx.public_key = readHash(stream);
+    stream >> tx.extra >> tx.coinbase >> tx.amount >> tx.block_height;
+    tx.block_hash = readHash(stream);
+    stream >> tx.timestamp >> tx.size;
+    return stream.status() == QDataStream::Ok;
+}
+
+}
+
+HistoryCache::HistoryCache(const QString& firstAddress, const QString& net)
+    : firstAddress_(firstAddress)
+    , net_(net)
+{
+    // The address is long and may grow new prefixes, its hash makes a safe file name
+    const QByteArray key = QCryptographicHash::hash((net + QLatin1Char(':') + firstAddress).toUtf8(), QCryptographicHash::Sha256).toHex().left(32);
+    const QDir dir = Settings::instance().getDefaultWorkDir().absoluteFilePath(HISTORY_DIR);
+    fileName_ = dir.absoluteFilePath(QString::fromLatin1(key) + QStringLiteral(".history"));
+}
+
+bool HistoryCache::load(Snapshot& snapshot) const
+{
+    QFile file(fileName_);
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+
+    QDataStream stream(&file);
+    stream.setVersion(HISTORY_STREAM_VERSION);
+    quint32 magic = 0;
+    quint16 version = 0;
+    QString firstAddress;
+    QString net;
+    quint32 count = 0;
+    stream >> magic >> version;
+    if (magic != HISTORY_MAGIC || version != HISTORY_VERSION)
+        return false;
+    stream >> firstAddress >> net >> snapshot.confirmedHeight >> snapshot.complete >> count;
+    if (stream.status() != QDataStream::Ok || firstAddress != firstAddress_ || net != net_)
+        return false;
+
+    snapshot.transactions.clear();
+    snapshot.transactions.reserve(qMin(count, MAX_RESERVE));
+    for (quint32 i = 0; i < count; ++i)
+    {
+        RpcApi::Transaction tx;
+        if (!readTransaction(stream, tx))
+            return false; // a cut off file is no good, the range it covers would have a hole
+        snapshot.transactions << tx;
+    }
+    return true;
+}
+
+bool HistoryCache::save(const Snapshot& snapshot) const
+{
+    QDir().mkpath(QFileInfo(fileName_).absolutePath());
+    QSaveFile file(fileName_); // the old file stays until the new one is complete
+    if (!file.open(QIODevice::WriteOnly))
+        return false;
+
+    QDataStream stream(&file);
+    stream.setVersion(HISTORY_STREAM_VERSION);
+    stream << HISTORY_MAGIC << HISTORY_VERSION
+           << firstAddress_ << net_ << snapshot.confirmedHeight << snapshot.complete
+           << static_cast<quint32>(snapshot.transactions.size());
+    for (const RpcApi::Transaction& tx : snapshot.transactions)
+        writeTransaction(stream, tx);
+    return stream.status() == QDataStream::Ok && file.commit();
+}
+
+QString HistoryCache::storeDirName() const
+{
+    QString dirName = fileName_;
+    dirName.chop(QStringLiteral(".history").size());
+    return dirName + QStringLiteral(".store");
+}
+
+void HistoryCache::remove() const
+{
+    QFile::remove(fileName_);
+}
+
+}
@@ -0,0 +1,45 @@
+// Copyright (c) 2015-2018, The Bytecoin developers.
+// Licensed under the GNU Lesser General Public License. See LICENSE for details.
+
+#ifndef HISTORYCACHE_H
+#define HISTORYCACHE_H
+
+#include <QString>
+#include <QVector>
+
+#include "rpcapi.h"
+
+namespace WalletGUI
+{
+
+// Confirmed part of a wallet's history kept on disk between runs, one file per wallet and net.
+// Only transactions at or below confirmedHeight are stored, those are not expected to change;
+// the history above it is asked from walletd again.
+class HistoryCache
+{
+public:
+    struct Snapshot
+    {
+        QVector<RpcApi::Transaction> transactions; // ascending block height
+        RpcApi::Height confirmedHeight = 0;
+        bool complete = false; // the history goes down to the genesis, nothing left to fetch below it
+    };
+
+    HistoryCache(const QString& firstAddress, const QString& net);
+
+    bool load(Snapshot& snapshot) const;
+    bool save(const Snapshot& snapshot) const;
+    void remove() const;
+
+    const QString& fileName() const { return fileName_; }
+    QString storeDirName() const; // for the TxColumnStore the history moves to once it is complete
+
+private:
+    QString firstAddress_;
+    QString net_;
+    QString fileName_;
+};
+
+}
+
+#endif // HISTORYCACHE_H
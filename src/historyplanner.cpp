@@ -0,0 +1,146 @@
+// Copyright (c) 2015-2018, The Bytecoin developers.
+// Licensed under the GNU Lesser General Public License. See LICENSE for details.
+
+#include "historyplanner.h"
+
+namespace WalletGUI
+{
+
+namespace
+{
+
+constexpr int MAX_IN_FLIGHT = 4;
+constexpr double TARGET_TRANSACTIONS = 300; // per window, as much as one get_transfers used to bring
+constexpr HistoryPlanner::Height MIN_WINDOW_BLOCKS = 100;
+constexpr HistoryPlanner::Height MAX_WINDOW_BLOCKS = 1 << 20;
+
+}
+
+void HistoryPlanner::start(Height to_height, double transactionsPerBlock)
+{
+    reset();
+    next_ = to_height;
+    transactionsPerBlock_ = transactionsPerBlock;
+    active_ = next_ > 1;
+    complete_ = !active_;
+}
+
+void HistoryPlanner::reset()
+{
+    windows_.clear();
+    next_ = 0;
+    transactionsPerBlock_ = 0;
+    active_ = false;
+    complete_ = false;
+}
+
+HistoryPlanner::Height HistoryPlanner::windowBlocks() const
+{
+    if (transactionsPerBlock_ <= 0)
+        return MAX_WINDOW_BLOCKS;
+    const double blocks = TARGET_TRANSACTIONS / transactionsPerBlock_;
+    return blocks >= MAX_WINDOW_BLOCKS ? MAX_WINDOW_BLOCKS : qMax(static_cast<Height>(blocks), MIN_WINDOW_BLOCKS);
+}
+
+QVector<HistoryPlanner::Range> HistoryPlanner::issue(bool extend)
+{
+    QVector<Range> result;
+    if (!active_)
+        return result;
+
+    int inFlight = 0;
+    for (const Window& window : windows_)
+        if (window.state == Window::IN_FLIGHT)
+            ++inFlight;
+
+    // The rest of windows cut short goes first, it is above anything new
+    for (Window& window : windows_)
+        if (inFlight < MAX_IN_FLIGHT && window.state == Window::PLANNED)
+        {
+            window.state = Window::IN_FLIGHT;
+            result << qMakePair(window.from_height, window.to_height);
+            ++inFlight;
+        }
+
+    // Heights from 1 to next_ - 1 are left
+    for (; extend && inFlight < MAX_IN_FLIGHT && next_ > 1; ++inFlight)
+    {
+        const Height blocks = windowBlocks();
+        Window window;
+        window.to_height = next_;
+        window.from_height = next_ > blocks + 1 ? next_ - blocks - 1 : 0;
+        window.state = Window::IN_FLIGHT;
+        windows_ << window;
+        result << qMakePair(window.from_height, window.to_height);
+        next_ = window.from_height + 1;
+    }
+    return result;
+}
+
+int HistoryPlanner::findInFlight(Height from_height, Height to_height) const
+{
+    for (int i = 0; i < windows_.size(); ++i)
+        if (windows_[i].state == Window::IN_FLIGHT && windows_[i].from_height == from_height && windows_[i].to_height == to_height)
+            return i;
+    return -1;
+}
+
+bool HistoryPlanner::owns(Height from_height, Height to_height) const
+{
+    return findInFlight(from_height, to_height) >= 0;
+}
+
+bool HistoryPlanner::accept(const RpcApi::Block& block)
+{
+    const Height height = block.header.height;
+    for (Window& window : windows_)
+        if (window.state == Window::IN_FLIGHT && height > window.from_height && height < window.to_height)
+        {
+            window.transactions << block.transactions.toVector();
+            return true;
+        }
+    return false;
+}
+
+void HistoryPlanner::received(Height from_height, Height to_height, Height next_to_height)
+{
+    const int index = findInFlight(from_height, to_height);
+    if (index < 0)
+        return;
+
+    Window& window = windows_[index];
+    window.state = Window::DONE;
+
+    // A reply cut short by walletd covers heights from next_to_height on, the rest is a window of its own
+    if (next_to_height > from_height + 1 && next_to_height < to_height)
+    {
+        window.from_height = next_to_height - 1;
+        Window rest;
+        rest.from_height = from_height;
+        rest.to_height = next_to_height;
+        windows_.insert(index + 1, rest);
+    }
+
+    const Window& done = windows_[index];
+    const Height blocks = done.to_height - done.from_height - 1;
+    if (blocks > 0)
+    {
+        const double observed = static_cast<double>(done.transactions.size()) / blocks;
+        transactionsPerBlock_ = transactionsPerBlock_ > 0 ? (transactionsPerBlock_ + observed) / 2 : observed;
+    }
+}
+
+bool HistoryPlanner::takeMerged(Window& window)
+{
+    if (windows_.isEmpty() || windows_.first().state != Window::DONE)
+        return false;
+    window = windows_.takeFirst();
+    if (windows_.isEmpty() && next_ <= 1)
+    {
+        active_ = false;
+        complete_ = true;
+    }
+    return true;
+}
+
+}
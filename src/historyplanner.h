@@ -0,0 +1,60 @@
+// Copyright (c) 2015-2018, The Bytecoin developers.
+// Licensed under the GNU Lesser General Public License. See LICENSE for details.
+
+#ifndef HISTORYPLANNER_H
+#define HISTORYPLANNER_H
+
+#include <QList>
+#include <QPair>
+#include <QVector>
+
+#include "rpcapi.h"
+
+namespace WalletGUI
+{
+
+// Splits the history below what is fetched into height windows which are asked for at the same time,
+// a few at once. Replies come in any order, windows are handed back strictly top down so the history
+// never has a gap. The window size follows the transactions per block seen so far.
+// Heights are exclusive on both ends, as in get_transfers.
+class HistoryPlanner
+{
+public:
+    using Height = RpcApi::Height;
+    using Range = QPair<Height, Height>; // (from_height, to_height)
+
+    struct Window
+    {
+        enum State { PLANNED, IN_FLIGHT, DONE };
+
+        Height from_height = 0;
+        Height to_height = 0;
+        State state = PLANNED;
+        QVector<RpcApi::Transaction> transactions;
+    };
+
+    void start(Height to_height, double transactionsPerBlock);
+    void reset();
+    bool isActive() const { return active_; }
+    bool isComplete() const { return complete_; } // everything down to the genesis is handed back
+
+    QVector<Range> issue(bool extend); // windows to ask for now, marked in flight; new ones only with extend
+    bool owns(Height from_height, Height to_height) const; // a window in flight
+    bool accept(const RpcApi::Block& block); // a streamed block of a window in flight, kept for its reply
+    void received(Height from_height, Height to_height, Height next_to_height); // its blocks were accepted already
+    bool takeMerged(Window& window); // the topmost window, if it is done
+
+private:
+    int findInFlight(Height from_height, Height to_height) const;
+    Height windowBlocks() const;
+
+    QList<Window> windows_; // top down, next to each other
+    Height next_ = 0; // to_height of the window planned next
+    double transactionsPerBlock_ = 0;
+    bool active_ = false;
+    bool complete_ = false;
+};
+
+}
+
+#endif // HISTORYPLANNER_H
@@ -0,0 +1,299 @@
+// Copyright (c) 2015-2018, The Bytecoin developers.
+// Licensed under the GNU Lesser General Public License. See LICENSE for details.
+
+#include <algorithm>
+#include <array>
+#include <iterator>
+#include <limits>
+
+#include "historysortedmodel.h"
+#include "walletmodel.h"
+
+namespace WalletGUI
+{
+
+namespace
+{
+
+constexpr quint64 SIGN_BIT = quint64(1) << 63;
+constexpr int RADIX_BITS = 8;
+constexpr int RADIX_SIZE = 1 << RADIX_BITS;
+constexpr int RADIX_PASSES = 64 / RADIX_BITS;
+
+// Stable, a byte a pass from the lowest one. A byte all the keys share is skipped, so heights take three passes at most.
+template<typename Entry>
+void radixSort(std::vector<Entry>& entries)
+{
+    if (entries.size() < 2)
+        return;
+    std::array<std::array<int, RADIX_SIZE>, RADIX_PASSES> offsets{};
+    for (const Entry& entry : entries)
+        for (int pass = 0; pass < RADIX_PASSES; ++pass)
+            ++offsets[pass][(entry.key >> (pass * RADIX_BITS)) & (RADIX_SIZE - 1)];
+
+    std::vector<Entry> buffer(entries.size());
+    for (int pass = 0; pass < RADIX_PASSES; ++pass)
+    {
+        const int shift = pass * RADIX_BITS;
+        std::array<int, RADIX_SIZE>& passOffsets = offsets[pass];
+        if (passOffsets[(entries.front().key >> shift) & (RADIX_SIZE - 1)] == static_cast<int>(entries.size()))
+            continue;
+        int sum = 0;
+        for (int& offset : passOffsets)
+        {
+            const int count = offset;
+            offset = sum;
+            sum += count;
+        }
+        for (const Entry& entry : entries)
+            buffer[passOffsets[(entry.key >> shift) & (RADIX_SIZE - 1)]++] = entry;
+        entries.swap(buffer);
+    }
+}
+
+// Equal keys keep the source order
+template<typename Entry>
+bool entryLess(const Entry& lhs, const Entry& rhs)
+{
+    return lhs.key < rhs.key || (lhs.key == rhs.key && lhs.row < rhs.row);
+}
+
+}
+
+SortedHistoryModel::SortedHistoryModel(QAbstractItemModel* sourceModel, QObject* parent)
+    : QAbstractProxyModel(parent)
+    , column_(-1)
+    , order_(Qt::AscendingOrder)
+{
+    setSourceModel(sourceModel);
+    connect(sourceModel, &QAbstractItemModel::rowsInserted, this, &SortedHistoryModel::sourceRowsInserted);
+    connect(sourceModel, &QAbstractItemModel::rowsAboutToBeRemoved, this, &SortedHistoryModel::sourceRowsAboutToBeRemoved);
+    connect(sourceModel, &QAbstractItemModel::rowsRemoved, this, &SortedHistoryModel::sourceRowsRemoved);
+    connect(sourceModel, &QAbstractItemModel::dataChanged, this, &SortedHistoryModel::sourceDataChanged);
+    connect(sourceModel, &QAbstractItemModel::modelAboutToBeReset, this, &SortedHistoryModel::sourceAboutToBeReset);
+    connect(sourceModel, &QAbstractItemModel::modelReset, this, &SortedHistoryModel::sourceReset);
+    rebuild();
+    updatePositions();
+}
+
+SortedHistoryModel::~SortedHistoryModel()
+{}
+
+/*virtual*/ QModelIndex SortedHistoryModel::index(int row, int column, const QModelIndex& parent /*= QModelIndex()*/) const
+{
+    if (parent.isValid() || row < 0 || row >= rowCount() || column < 0 || column >= columnCount())
+        return QModelIndex();
+    return createIndex(row, column);
+}
+
+/*virtual*/ QModelIndex SortedHistoryModel::parent(const QModelIndex& /*index*/) const
+{
+    return QModelIndex();
+}
+
+/*virtual*/ int SortedHistoryModel::rowCount(const QModelIndex& parent /*= QModelIndex()*/) const
+{
+    return parent.isValid() ? 0 : static_cast<int>(entries_.size());
+}
+
+/*virtual*/ int SortedHistoryModel::columnCount(const QModelIndex& parent /*= QModelIndex()*/) const
+{
+    return parent.isValid() ? 0 : sourceModel()->columnCount();
+}
+
+/*virtual*/ QModelIndex SortedHistoryModel::mapToSource(const QModelIndex& proxyIndex) const
+{
+    if (!proxyIndex.isValid() || proxyIndex.row() >= rowCount())
+        return QModelIndex();
+    return sourceModel()->index(entries_[proxyIndex.row()].row, proxyIndex.column());
+}
+
+/*virtual*/ QModelIndex SortedHistoryModel::mapFromSource(const QModelIndex& sourceIndex) const
+{
+    if (!sourceIndex.isValid() || sourceIndex.row() >= static_cast<int>(positions_.size()))
+        return QModelIndex();
+    return index(positions_[sourceIndex.row()], sourceIndex.column());
+}
+
+// Signed keys get their sign bit flipped and descending ones all their bits, so one unsigned order serves all
+quint64 SortedHistoryModel::keyOf(int row) const
+{
+    if (column_ < 0)
+        return 0;
+    const QVariant value = sourceModel()->index(row, column_).data(WalletModel::ROLE_SORT_KEY);
+    quint64 key = 0;
+    switch (value.userType())
+    {
+    case QMetaType::LongLong:
+    case QMetaType::Int:
+        key = static_cast<quint64>(value.toLongLong()) ^ SIGN_BIT;
+        break;
+    case QMetaType::ULongLong:
+    case QMetaType::UInt:
+        key = value.toULongLong();
+        break;
+    default:
+        return std::numeric_limits<quint64>::max();
+    }
+    return order_ == Qt::AscendingOrder ? key : ~key;
+}
+
+void SortedHistoryModel::rebuild()
+{
+    const int count = sourceModel()->rowCount();
+    entries_.clear();
+    entries_.reserve(count);
+    for (int row = 0; row < count; ++row)
+        entries_.push_back(Entry{keyOf(row), row});
+    radixSort(entries_);
+}
+
+// entries come in source order, entries_ is in order already
+void SortedHistoryModel::mergeIn(std::vector<Entry> entries)
+{
+    radixSort(entries);
+    std::vector<Entry> merged;
+    merged.reserve(entries_.size() + entries.size());
+    std::merge(entries_.begin(), entries_.end(), entries.begin(), entries.end(), std::back_inserter(merged), entryLess<Entry>);
+    entries_.swap(merged);
+}
+
+void SortedHistoryModel::updatePositions()
+{
+    positions_.resize(entries_.size());
+    for (size_t i = 0; i < entries_.size(); ++i)
+        positions_[entries_[i].row] = static_cast<int>(i);
+}
+
+// The row count stays, persistent indexes follow their source rows
+template<typename Change>
+void SortedHistoryModel::relayout(Change change)
+{
+    emit layoutAboutToBeChanged(QList<QPersistentModelIndex>(), QAbstractItemModel::VerticalSortHint);
+    const QModelIndexList before = persistentIndexList();
+    QVector<QPair<int, int>> sources;
+    sources.reserve(before.size());
+    for (const QModelIndex& index : before)
+        sources << qMakePair(entries_[index.row()].row, index.column());
+
+    change();
+    updatePositions();
+
+    QModelIndexList after;
+    after.reserve(sources.size());
+    for (const auto& source : sources)
+        after << index(positions_[source.first], source.second);
+    changePersistentIndexList(before, after);
+    emit layoutChanged(QList<QPersistentModelIndex>(), QAbstractItemModel::VerticalSortHint);
+}
+
+/*virtual*/ void SortedHistoryModel::sort(int column, Qt::SortOrder order /*= Qt::AscendingOrder*/)
+{
+    column_ = column;
+    order_ = order;
+    relayout([this]() { rebuild(); });
+}
+
+// Appended as the source has them, then moved into place
+void SortedHistoryModel::sourceRowsInserted(const QModelIndex& parent, int first, int last)
+{
+    if (parent.isValid())
+        return;
+    const int count = last - first + 1;
+    const int size = static_cast<int>(entries_.size());
+    beginInsertRows(QModelIndex(), size, size + count - 1);
+    for (Entry& entry : entries_)
+        if (entry.row >= first)
+            entry.row += count;
+    for (int row = first; row <= last; ++row)
+        entries_.push_back(Entry{keyOf(row), row});
+    updatePositions();
+    endInsertRows();
+
+    relayout([this, size]()
+    {
+        std::vector<Entry> inserted(entries_.begin() + size, entries_.end());
+        entries_.resize(size);
+        mergeIn(std::move(inserted));
+    });
+}
+
+// Moved to the end first, then removed there as one run
+void SortedHistoryModel::sourceRowsAboutToBeRemoved(const QModelIndex& parent, int first, int last)
+{
+    if (parent.isValid())
+        return;
+    relayout([this, first, last]()
+    {
+        std::stable_partition(entries_.begin(), entries_.end(), [first, last](const Entry& entry) { return entry.row < first || entry.row > last; });
+    });
+    const int size = static_cast<int>(entries_.size());
+    beginRemoveRows(QModelIndex(), size - (last - first + 1), size - 1);
+}
+
+void SortedHistoryModel::sourceRowsRemoved(const QModelIndex& parent, int first, int last)
+{
+    if (parent.isValid())
+        return;
+    const int count = last - first + 1;
+    entries_.resize(entries_.size() - count);
+    for (Entry& entry : entries_)
+        if (entry.row > last)
+            entry.row -= count;
+    updatePositions();
+    endRemoveRows();
+}
+
+void SortedHistoryModel::sourceDataChanged(const QModelIndex& topLeft, const QModelIndex& bottomRight, const QVector<int>& roles)
+{
+    if (!topLeft.isValid() || !bottomRight.isValid())
+        return;
+    const int first = topLeft.row();
+    const int last = bottomRight.row();
+
+    // Keys are read again only when the sort column is in the change, the rows whose key moved are merged in again
+    if (column_ >= topLeft.column() && column_ <= bottomRight.column() &&
+            (roles.isEmpty() || roles.contains(Qt::DisplayRole) || roles.contains(WalletModel::ROLE_SORT_KEY)))
+    {
+        std::vector<Entry> changed;
+        for (int row = first; row <= last; ++row)
+        {
+            const quint64 key = keyOf(row);
+            if (entries_[positions_[row]].key != key)
+                changed.push_back(Entry{key, row});
+        }
+        if (!changed.empty())
+            relayout([this, &changed]()
+            {
+                for (const Entry& entry : changed)
+                    entries_[positions_[entry.row]].row = -1;
+                entries_.erase(std::remove_if(entries_.begin(), entries_.end(), [](const Entry& entry) { return entry.row < 0; }), entries_.end());
+                mergeIn(std::move(changed));
+            });
+    }
+
+    // One span over wherever the rows went, views repaint only what they show of it
+    int top = rowCount();
+    int bottom = -1;
+    for (int row = first; row <= last; ++row)
+    {
+        top = qMin(top, positions_[row]);
+        bottom = qMax(bottom, positions_[row]);
+    }
+    if (top <= bottom)
+        emit dataChanged(index(top, topLeft.column()), index(bottom, bottomRight.column()), roles);
+}
+
+void SortedHistoryModel::sourceAboutToBeReset()
+{
+    beginResetModel();
+}
+
+void SortedHistoryModel::sourceReset()
+{
+    rebuild();
+    updatePositions();
+    endResetModel();
+}
+
+}
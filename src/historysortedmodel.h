@@ -0,0 +1,64 @@
+// Copyright (c) 2015-2018, The Bytecoin developers.
+// Licensed under the GNU Lesser General Public License. See LICENSE for details.
+
+#ifndef HISTORYSORTEDMODEL_H
+#define HISTORYSORTEDMODEL_H
+
+#include <vector>
+
+#include <QAbstractProxyModel>
+
+namespace WalletGUI
+{
+
+// History rows in the order of one column, by the typed keys WalletModel gives for ROLE_SORT_KEY.
+// The keys are read once into an array and the rows put in order by a radix sort; rows inserted
+// or changed later are sorted alone and merged in. Rows with no key come last, a column without
+// keys keeps the source order.
+class SortedHistoryModel : public QAbstractProxyModel
+{
+    Q_OBJECT
+    Q_DISABLE_COPY(SortedHistoryModel)
+
+public:
+    SortedHistoryModel(QAbstractItemModel* sourceModel, QObject* parent);
+    virtual ~SortedHistoryModel();
+
+    virtual QModelIndex index(int row, int column, const QModelIndex& parent = QModelIndex()) const override;
+    virtual QModelIndex parent(const QModelIndex& index) const override;
+    virtual int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    virtual int columnCount(const QModelIndex& parent = QModelIndex()) const override;
+    virtual QModelIndex mapToSource(const QModelIndex& proxyIndex) const override;
+    virtual QModelIndex mapFromSource(const QModelIndex& sourceIndex) const override;
+    virtual void sort(int column, Qt::SortOrder order = Qt::AscendingOrder) override;
+
+private:
+    struct Entry
+    {
+        quint64 key; // ordered as unsigned, the sort order applied already
+        int row; // in the source
+    };
+
+    quint64 keyOf(int row) const;
+    void rebuild();
+    void mergeIn(std::vector<Entry> entries);
+    void updatePositions();
+    template<typename Change>
+    void relayout(Change change);
+
+    void sourceRowsInserted(const QModelIndex& parent, int first, int last);
+    void sourceRowsAboutToBeRemoved(const QModelIndex& parent, int first, int last);
+    void sourceRowsRemoved(const QModelIndex& parent, int first, int last);
+    void sourceDataChanged(const QModelIndex& topLeft, const QModelIndex& bottomRight, const QVector<int>& roles);
+    void sourceAboutToBeReset();
+    void sourceReset();
+
+    std::vector<Entry> entries_; // in proxy order
+    std::vector<int> positions_; // the proxy row of each source row
+    int column_;
+    Qt::SortOrder order_;
+};
+
+}
+
+#endif // HISTORYSORTEDMODEL_H
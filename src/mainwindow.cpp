@@ -23,6 +23,7 @@
 #include "logger.h"
 #include "aboutdialog.h"
 #include "walletmodel.h"
+#include "walletstatemodel.h"
 #include "settings.h"
 #include "common.h"
 #include "JsonRpc/JsonRpcClient.h"
@@ -158,18 +159,18 @@ MainWindow::MainWindow(
 
 //    m_ui->m_addressesCountLabel->hide();
 //    m_ui->m_creationTimestampLabel->hide();
-    m_addressesMapper->setModel(walletModel_);
+    m_addressesMapper->setModel(walletModel_->getStateModel());
     m_addressesMapper->addMapping(m_ui->m_addressLabel, WalletModel::COLUMN_FIRST_ADDRESS, "text");
 //    m_addressesMapper->addMapping(m_ui->m_addressesCountLabel, WalletModel::COLUMN_TOTAL_ADDRESS_COUNT, "text");
 //    m_addressesMapper->addMapping(m_ui->m_creationTimestampLabel, WalletModel::COLUMN_WALLET_CREATION_TIMESTAMP, "text");
 //    m_addressesMapper->addMapping(m_ui->m_viewOnlyLabel, WalletModel::COLUMN_VIEW_ONLY, "text");
     m_addressesMapper->toFirst();
-    connect(walletModel_, &QAbstractItemModel::modelReset, m_addressesMapper, &QDataWidgetMapper::toFirst);
+    connect(walletModel_->getStateModel(), &QAbstractItemModel::modelReset, m_addressesMapper, &QDataWidgetMapper::toFirst);
 
-    m_balanceMapper->setModel(walletModel_);
+    m_balanceMapper->setModel(walletModel_->getStateModel());
     m_balanceMapper->addMapping(m_ui->m_balanceLabel, WalletModel::COLUMN_TOTAL, "text");
     m_balanceMapper->toFirst();
-    connect(walletModel_, &QAbstractItemModel::modelReset, m_balanceMapper, &QDataWidgetMapper::toFirst);
+    connect(walletModel_->getStateModel(), &QAbstractItemModel::modelReset, m_balanceMapper, &QDataWidgetMapper::toFirst);
 
 //    QFont font = m_ui->m_balanceLabel->font();
 //    font.setBold(true);
@@ -340,7 +341,7 @@ void MainWindow::showSendConfirmation(const RpcApi::CreatedTx& tx)
             continue;
         }
         const QString& amountStr = formatAmount(tf.amount);
-        const QString& addressStr = tf.address;
+        const QString addressStr = tf.address.toString();
         msg.append(tr("%1 to %2\n").arg(amountStr).arg(addressStr));
     }
     msg.append(tr("Fee: %1\n").arg(formatAmount(tx.transaction.fee)));
@@ -411,13 +412,13 @@ void MainWindow::copyAddress()
 {
     if (!walletModel_->isConnected())
         return;
-    QApplication::clipboard()->setText(walletModel_->index(0, WalletModel::COLUMN_FIRST_ADDRESS).data(WalletModel::ROLE_FIRST_ADDRESS).toString());
+    QApplication::clipboard()->setText(walletModel_->getStateModel()->index(0, WalletModel::COLUMN_FIRST_ADDRESS).data(WalletModel::ROLE_FIRST_ADDRESS).toString());
     copiedToClipboard();
 }
 
 void MainWindow::copyBalance()
 {
-    QString balanceString = walletModel_->index(0, WalletModel::COLUMN_TOTAL).data().toString();
+    QString balanceString = walletModel_->getStateModel()->index(0, WalletModel::COLUMN_TOTAL).data().toString();
     balanceString.remove(',');
     QApplication::clipboard()->setText(balanceString);
     copiedToClipboard();
@@ -494,6 +495,12 @@ void MainWindow::addDaemonError(const QString& msg)
     m_ui->m_logFrame->addDaemonError(msg);
 }
 
+void MainWindow::addRpcStatistics(const QString& text)
+{
+    m_ui->m_logFrame->addGuiMessage(text + '\n');
+    showLog();
+}
+
 void MainWindow::showLog()
 {
     m_ui->m_logButton->setChecked(true);
@@ -635,6 +642,11 @@ void MainWindow::showWalletdParams()
     emit showWalletdParamsSignal();
 }
 
+void MainWindow::showRpcStatistics()
+{
+    emit showRpcStatisticsSignal();
+}
+
 void MainWindow::exportViewOnlyKeys()
 {
     emit exportViewOnlyKeysSignal(walletModel_->isAmethyst());
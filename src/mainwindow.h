@@ -72,6 +72,7 @@ public:
     Q_SLOT void addDaemonOutput(const QString& msg);
     Q_SLOT void addDaemonError(const QString& msg);
     Q_SLOT void showLog();
+    void addRpcStatistics(const QString& text);
 
     Q_SLOT void packetSent(const QByteArray& data);
     Q_SLOT void packetReceived(const QByteArray& data);
@@ -131,6 +132,7 @@ private:
     Q_SLOT void createProof(const QString& txHash, const QStringList& addresses, bool needToFind);
     Q_SLOT void checkProof();
     Q_SLOT void showWalletdParams();
+    Q_SLOT void showRpcStatistics();
 
 signals:
     void createTxSignal(const RpcApi::CreateTransaction::Request& req, QPrivateSignal);
@@ -138,6 +140,7 @@ signals:
     void createProofSignal(const QString& txHash, const QStringList& addresses, bool needToFind);
     void checkProofSignal();
     void showWalletdParamsSignal();
+    void showRpcStatisticsSignal();
     void exportViewOnlyKeysSignal(bool isAmethyst);
     void exportKeysSignal(bool isAmethyst);
     void restartDaemon(QPrivateSignal);
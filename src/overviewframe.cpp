@@ -10,10 +10,13 @@
 #include <QMessageBox>
 #include <QProgressDialog>
 #include <QDesktopServices>
+#include <QScrollBar>
 
 
 #include "overviewframe.h"
 #include "walletmodel.h"
+#include "walletstatemodel.h"
+#include "historysortedmodel.h"
 #include "rpcapi.h"
 
 #include "ui_overviewframe.h"
@@ -78,6 +81,7 @@ OverviewFrame::OverviewFrame(QWidget* parent)
     : QFrame(parent)
     , m_ui(new Ui::OverviewFrame)
     , m_mainWindow(nullptr)
+    , m_sortedModel(nullptr)
     , m_csvExporter(nullptr)
 {
     m_ui->setupUi(this);
@@ -94,7 +98,9 @@ OverviewFrame::~OverviewFrame()
 void OverviewFrame::setTransactionsModel(WalletModel* model)
 {
     m_transactionsModel = model;
-    m_ui->m_recentTransactionsView->setModel(model);
+    delete m_sortedModel;
+    m_sortedModel = new SortedHistoryModel(model, this);
+    m_ui->m_recentTransactionsView->setModel(m_sortedModel);
 
     const int columns = m_transactionsModel->columnCount();
     // hide all columns
@@ -102,7 +108,7 @@ void OverviewFrame::setTransactionsModel(WalletModel* model)
         m_ui->m_recentTransactionsView->setColumnHidden(i, true);
 
     QHeaderView& header = *m_ui->m_recentTransactionsView->horizontalHeader();
-    header.setResizeContentsPrecision(-1);
+    header.setResizeContentsPrecision(0); // the rows shown only, the paged out ones have nothing to measure
 
     for (int i = 0; i < columns_order.size(); ++i)
     {
@@ -114,14 +120,41 @@ void OverviewFrame::setTransactionsModel(WalletModel* model)
         m_ui->m_recentTransactionsView->setColumnHidden(column, false);
     }
 
+    // Newest first until a header is clicked
+    header.setSortIndicator(-1, Qt::DescendingOrder);
+    m_ui->m_recentTransactionsView->setSortingEnabled(true);
+
+    // The model keeps the rows around the shown ones in memory
+    const QScrollBar* scrollBar = m_ui->m_recentTransactionsView->verticalScrollBar();
+    connect(scrollBar, &QScrollBar::valueChanged, this, &OverviewFrame::updateVisibleRows);
+    connect(scrollBar, &QScrollBar::rangeChanged, this, &OverviewFrame::updateVisibleRows);
+    connect(m_sortedModel, &QAbstractItemModel::layoutChanged, this, &OverviewFrame::updateVisibleRows);
+    m_transactionsModel->setPaging(true);
+    updateVisibleRows();
+
     delete m_csvExporter;
     m_csvExporter = new CSVTransactionsExporter(model, this);
 }
 
+// Sorted, the rows shown come from all over the history
+void OverviewFrame::updateVisibleRows()
+{
+    const QTableView* view = m_ui->m_recentTransactionsView;
+    const int firstRow = qMax(view->rowAt(0), 0);
+    int lastRow = view->rowAt(view->viewport()->height() - 1);
+    if (lastRow < 0)
+        lastRow = m_sortedModel->rowCount() - 1;
+    QVector<int> rows;
+    for (int row = firstRow; row <= lastRow; ++row)
+        rows << m_sortedModel->mapToSource(m_sortedModel->index(row, 0)).row();
+    m_transactionsModel->setVisibleRows(rows);
+}
+
 void OverviewFrame::setWalletModel(WalletModel* walletModel)
 {
     m_ui->m_balanceOverviewFrame->setWalletModel(walletModel);
-    m_ui->m_miningOverviewFrame->setWalletModel(walletModel);
+    m_ui->m_miningOverviewFrame->setWalletModel(walletModel->getStateModel());
+    m_ui->m_balanceChart->setWalletModel(walletModel);
 }
 
 void OverviewFrame::setMiningManager(MiningManager* miningManager)
@@ -169,7 +202,7 @@ bool OverviewFrame::eventFilter(QObject* object, QEvent* event)
     if (event->type() == QEvent::MouseButtonRelease)
     {
         QMouseEvent* e = (QMouseEvent*)event;
-        QModelIndex modelIndex = view->indexAt(e->pos());
+        const QModelIndex modelIndex = m_sortedModel->mapToSource(view->indexAt(e->pos()));
         if (!modelIndex.isValid())
             return false;
         const QString net = m_transactionsModel->data(modelIndex, WalletModel::ROLE_NET).toString();
@@ -211,7 +244,7 @@ bool OverviewFrame::eventFilter(QObject* object, QEvent* event)
     else if (event->type() == QEvent::MouseMove)
     {
         QMouseEvent* e = (QMouseEvent*)event;
-        QModelIndex modelIndex = view->indexAt(e->pos());
+        const QModelIndex modelIndex = m_sortedModel->mapToSource(view->indexAt(e->pos()));
 
         const QString net = m_transactionsModel->data(modelIndex, WalletModel::ROLE_NET).toString();
         const bool isTestnet = (net == RpcApi::TEST_NET_NAME);
@@ -269,6 +302,8 @@ void CSVTransactionsExporter::start()
 
     writeHeader();
 
+    // Every row is written, none may be paged out meanwhile
+    transactionsModel_->setPaging(false);
     if (transactionsModel_->canFetchMore())
     {
         connect(transactionsModel_, &WalletModel::fetchedSignal, this, &CSVTransactionsExporter::fetched);
@@ -319,6 +354,7 @@ void CSVTransactionsExporter::close()
     exportProgressDlg_->setValue(exportProgressDlg_->maximum());
     exportProgressDlg_->deleteLater();
     file_.close();
+    transactionsModel_->setPaging(true);
 }
 
 void CSVTransactionsExporter::fetched()
@@ -19,6 +19,7 @@ class OverviewFrame;
 namespace WalletGUI {
 
 class WalletModel;
+class SortedHistoryModel;
 class MiningManager;
 class CopiedToolTip;
 class CSVTransactionsExporter;
@@ -49,9 +50,11 @@ private:
     QScopedPointer<Ui::OverviewFrame> m_ui;
     QWidget* m_mainWindow;
     WalletModel* m_transactionsModel;
+    SortedHistoryModel* m_sortedModel; // what the view shows
     CSVTransactionsExporter* m_csvExporter;
 
     void rowsInserted(const QModelIndex& parent, int first, int last);
+    void updateVisibleRows();
     bool eventFilter(QObject* object, QEvent* event) override;
 };
 
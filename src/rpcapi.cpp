@@ -2,8 +2,11 @@
 // Licensed under the GNU Lesser General Public License. See LICENSE for details.
 
 #include <QVariantMap>
+#include <QJsonArray>
+#include <type_traits>
 
 #include "rpcapi.h"
+#include "JsonRpc/JsonRpcEncoder.h"
 
 namespace RpcApi
 {
@@ -26,10 +29,13 @@ constexpr char CreateAddresses::METHOD[];
 #define RPCAPI_SERIALIZE_FIELD(obj, json, fieldName) \
     do \
     { \
-        json.insert(#fieldName, obj.fieldName); \
+        json.insert(#fieldName, serializable(obj.fieldName)); \
     } \
     while (0)
 
+#define RPCAPI_WRITE_FIELD(obj, json, fieldName) \
+    json.field(#fieldName, obj.fieldName)
+
 #define RPCAPI_SERIALIZE_TIMESTAMP(obj, json, fieldName) \
     do \
     { \
@@ -55,68 +61,304 @@ constexpr char CreateAddresses::METHOD[];
     } \
     while (0)
 
+namespace
+{
+
+// Hashes go out as hex, interned addresses as text, everything else as it is
+template<typename T>
+const T& serializable(const T& value)
+{
+    return value;
+}
+
+QString serializable(const Hash32& value)
+{
+    return value.isNull() ? QString() : value.toHex();
+}
+
+QString serializable(const Address& value)
+{
+    return value.toString();
+}
+
+// QVariantMap decoders, kept for callers still holding converted maps
+
+template<typename T>
+bool deserializeField(const QVariantMap& json, const QString& fieldName, T& field)
+{
+    const QVariantMap::const_iterator it = json.constFind(fieldName);
+    if (it == json.constEnd())
+        qDebug("[RpcApi] Field '%s' not found. Using default.", qPrintable(fieldName));
+    else if (!it.value().canConvert<T>())
+        qDebug("[RpcApi] Cannot convert '%s'.", qPrintable(fieldName));
+    else
+    {
+        field = it.value().value<T>();
+        return true;
+    }
+    return false;
+}
+
+bool deserializeField(const QVariantMap& json, const QString& fieldName, Hash32& field)
+{
+    QString hex;
+    if (!deserializeField(json, fieldName, hex))
+        return false;
+    bool ok = false;
+    field = Hash32::fromHex(hex, &ok);
+    if (!ok)
+        qDebug("[RpcApi] Cannot convert '%s'.", qPrintable(fieldName));
+    return ok;
+}
+
+bool deserializeField(const QVariantMap& json, const QString& fieldName, Address& field)
+{
+    QString address;
+    if (!deserializeField(json, fieldName, address))
+        return false;
+    field = Address::intern(address);
+    return true;
+}
+
+void deserializeTimestamp(const QVariantMap& json, const QString& fieldName, QDateTime& field)
+{
+    quint64 timestamp = 0;
+    if (deserializeField(json, fieldName, timestamp))
+        field = QDateTime::fromTime_t(timestamp).toUTC();
+}
+
+template<typename T>
+void deserializeList(const QVariantMap& json, const QString& fieldName, QList<T>& field)
+{
+    const QVariantMap::const_iterator it = json.constFind(fieldName);
+    if (it == json.constEnd())
+        qDebug("[RpcApi] Field '%s' not found. Using default.", qPrintable(fieldName));
+    else if (!it.value().canConvert<QVariantList>())
+        qDebug("[RpcApi] Cannot convert '%s'.", qPrintable(fieldName));
+    else
+    {
+        const QVariantList vlist = it.value().toList();
+        field.reserve(field.size() + vlist.size());
+        for (const QVariant& var : vlist)
+            field << T::fromJson(var.toMap());
+    }
+}
+
+template<typename T>
+void deserializeStruct(const QVariantMap& json, const QString& fieldName, T& field)
+{
+    const QVariantMap::const_iterator it = json.constFind(fieldName);
+    if (it == json.constEnd())
+        qDebug("[RpcApi] Field '%s' not found. Using default.", qPrintable(fieldName));
+    else
+        field = T::fromJson(it.value().toMap());
+}
+
+// QJsonObject decoders, fill the structs straight from the parsed document.
+// They take what QVariant::value<T>() took on the old path: integers and booleans may come as strings,
+// strings as numbers. An integer string is read in full, a number past 2^53 would lose digits as a double.
+
+template<typename T>
+typename std::enable_if<std::is_integral<T>::value && std::is_signed<T>::value, bool>::type
+fromString(const QString& text, T& field)
+{
+    bool ok = false;
+    const qlonglong value = text.toLongLong(&ok);
+    if (ok)
+        field = static_cast<T>(value);
+    return ok;
+}
+
+template<typename T>
+typename std::enable_if<std::is_integral<T>::value && !std::is_signed<T>::value, bool>::type
+fromString(const QString& text, T& field)
+{
+    bool ok = false;
+    const qulonglong value = text.toULongLong(&ok);
+    if (ok)
+        field = static_cast<T>(value);
+    return ok;
+}
+
+template<typename T>
+typename std::enable_if<std::is_integral<T>::value, bool>::type
+fromJsonValue(const QJsonValue& json, T& field)
+{
+    if (json.isString())
+        return fromString(json.toString(), field);
+    if (json.isBool())
+    {
+        field = json.toBool() ? 1 : 0;
+        return true;
+    }
+    if (!json.isDouble())
+        return false;
+    field = static_cast<T>(json.toDouble());
+    return true;
+}
+
+bool fromJsonValue(const QJsonValue& json, bool& field)
+{
+    if (json.isDouble())
+    {
+        field = json.toDouble() != 0;
+        return true;
+    }
+    if (json.isString())
+    {
+        // As QVariant has it: only empty, "0" and "false" are false
+        const QString text = json.toString();
+        field = !(text.isEmpty() || text == QLatin1String("0") || text.compare(QLatin1String("false"), Qt::CaseInsensitive) == 0);
+        return true;
+    }
+    if (!json.isBool())
+        return false;
+    field = json.toBool();
+    return true;
+}
+
+bool fromJsonValue(const QJsonValue& json, QString& field)
+{
+    if (json.isDouble() || json.isBool())
+    {
+        field = json.toVariant().toString();
+        return true;
+    }
+    if (!json.isString())
+        return false;
+    field = json.toString();
+    return true;
+}
+
+bool fromJsonValue(const QJsonValue& json, Hash32& field)
+{
+    if (!json.isString())
+        return false;
+    bool ok = false;
+    field = Hash32::fromHex(json.toString(), &ok);
+    return ok;
+}
+
+bool fromJsonValue(const QJsonValue& json, Address& field)
+{
+    if (!json.isString())
+        return false;
+    field = Address::intern(json.toString());
+    return true;
+}
+
+bool fromJsonValue(const QJsonValue& json, QStringList& field)
+{
+    if (!json.isArray())
+        return false;
+    const QJsonArray array = json.toArray();
+    field.reserve(array.size());
+    for (const QJsonValue& value : array)
+        field << value.toString();
+    return true;
+}
+
+bool fromJsonValue(const QJsonValue& json, QList<quint64>& field)
+{
+    if (!json.isArray())
+        return false;
+    const QJsonArray array = json.toArray();
+    field.reserve(array.size());
+    for (const QJsonValue& value : array)
+    {
+        quint64 item = 0;
+        if (!fromJsonValue(value, item))
+            return false;
+        field << item;
+    }
+    return true;
+}
+
+template<typename T>
+bool deserializeField(const QJsonObject& json, const QString& fieldName, T& field)
+{
+    const QJsonObject::const_iterator it = json.constFind(fieldName);
+    if (it == json.constEnd())
+        qDebug("[RpcApi] Field '%s' not found. Using default.", qPrintable(fieldName));
+    else if (!fromJsonValue(it.value(), field))
+        qDebug("[RpcApi] Cannot convert '%s'.", qPrintable(fieldName));
+    else
+        return true;
+    return false;
+}
+
+void deserializeTimestamp(const QJsonObject& json, const QString& fieldName, QDateTime& field)
+{
+    quint64 timestamp = 0;
+    if (deserializeField(json, fieldName, timestamp))
+        field = QDateTime::fromTime_t(timestamp).toUTC();
+}
+
+template<typename T>
+void deserializeList(const QJsonObject& json, const QString& fieldName, QList<T>& field)
+{
+    const QJsonObject::const_iterator it = json.constFind(fieldName);
+    if (it == json.constEnd())
+        qDebug("[RpcApi] Field '%s' not found. Using default.", qPrintable(fieldName));
+    else if (!it.value().isArray())
+        qDebug("[RpcApi] Cannot convert '%s'.", qPrintable(fieldName));
+    else
+    {
+        const QJsonArray array = it.value().toArray();
+        field.reserve(field.size() + array.size());
+        for (const QJsonValue& value : array)
+            field << T::fromJson(value.toObject());
+    }
+}
+
+template<typename T>
+void deserializeStruct(const QJsonObject& json, const QString& fieldName, T& field)
+{
+    const QJsonObject::const_iterator it = json.constFind(fieldName);
+    if (it == json.constEnd())
+        qDebug("[RpcApi] Field '%s' not found. Using default.", qPrintable(fieldName));
+    else
+        field = T::fromJson(it.value().toObject());
+}
+
+}
+
 #define RPCAPI_DESERIALIZE_FIELD(obj, json, fieldName) \
-    do \
-    { \
-        using FieldType = decltype(obj.fieldName); \
-        if (!json.contains(#fieldName)) \
-            qDebug("[RpcApi] Field '%s' not found. Using default.", #fieldName); \
-        else if (!json[#fieldName].canConvert<FieldType>()) \
-            qDebug("[RpcApi] Cannot convert '%s'.", #fieldName); \
-        else \
-            obj.fieldName = json[#fieldName].value<FieldType>(); \
-    } \
-    while (0)
+    deserializeField(json, QStringLiteral(#fieldName), obj.fieldName)
 
 #define RPCAPI_DESERIALIZE_TIMESTAMP(obj, json, fieldName) \
-    do \
-    { \
-        using FieldType = quint64; \
-        if (!json.contains(#fieldName)) \
-            qDebug("[RpcApi] Field '%s' not found. Using default.", #fieldName); \
-        else if (!json[#fieldName].canConvert<FieldType>()) \
-            qDebug("[RpcApi] Cannot convert '%s'.", #fieldName); \
-        else \
-            obj.fieldName = QDateTime::fromTime_t(json[#fieldName].value<FieldType>()).toUTC(); \
-    } \
-    while (0)
+    deserializeTimestamp(json, QStringLiteral(#fieldName), obj.fieldName)
 
 #define RPCAPI_DESERIALIZE_LIST(obj, json, fieldName) \
-    do \
-    { \
-        using FieldType = decltype(obj.fieldName); \
-        if (!json.contains(#fieldName)) \
-            qDebug("[RpcApi] Field '%s' not found. Using default.", #fieldName); \
-        else if (!json[#fieldName].canConvert<QVariantList>()) \
-            qDebug("[RpcApi] Cannot convert '%s'.", #fieldName); \
-        else \
-        { \
-            QVariantList vlist = json[#fieldName].toList(); \
-            for (const QVariant& var : vlist) \
-                obj.fieldName << FieldType::value_type::fromJson(var.toMap()); \
-        } \
-    } \
-    while (0)
+    deserializeList(json, QStringLiteral(#fieldName), obj.fieldName)
 
 #define RPCAPI_DESERIALIZE_STRUCT(obj, json, fieldName) \
-    do \
+    deserializeStruct(json, QStringLiteral(#fieldName), obj.fieldName)
+
+// Both decoders share the field tables in deserialize() below
+#define RPCAPI_DEFINE_FROM_JSON(Type) \
+    /*static*/ \
+    Type \
+    Type::fromJson(const QVariantMap& json) \
     { \
-        using FieldType = decltype(obj.fieldName); \
-        if (!json.contains(#fieldName)) \
-            qDebug("[RpcApi] Field '%s' not found. Using default.", #fieldName); \
-        else \
-        { \
-            obj.fieldName = FieldType::fromJson(json[#fieldName].toMap()); \
-        } \
+        Type value; \
+        deserialize(value, json); \
+        return value; \
     } \
-    while (0)
+    \
+    /*static*/ \
+    Type \
+    Type::fromJson(const QJsonObject& json) \
+    { \
+        Type value; \
+        deserialize(value, json); \
+        return value; \
+    }
 
-/*static*/
-GetStatus::Response
-GetStatus::Response::fromJson(const QVariantMap& json)
+template<typename Json>
+static
+void deserialize(GetStatus::Response& value, const Json& json)
 {
-    GetStatus::Response value;
-
     RPCAPI_DESERIALIZE_FIELD(value, json, top_block_hash);
     RPCAPI_DESERIALIZE_FIELD(value, json, transaction_pool_version);
     RPCAPI_DESERIALIZE_FIELD(value, json, outgoing_peer_count);
@@ -133,10 +375,10 @@ GetStatus::Response::fromJson(const QVariantMap& json)
     RPCAPI_DESERIALIZE_FIELD(value, json, recommended_max_transaction_size);
     RPCAPI_DESERIALIZE_FIELD(value, json, recommended_fee_per_byte);
     RPCAPI_DESERIALIZE_FIELD(value, json, top_known_block_height);
-
-    return value;
 }
 
+RPCAPI_DEFINE_FROM_JSON(GetStatus::Response)
+
 QVariantMap
 GetStatus::Request::toJson() const
 {
@@ -152,19 +394,29 @@ GetStatus::Request::toJson() const
     return json;
 }
 
-/*static*/
-GetAddresses::Response
-GetAddresses::Response::fromJson(const QVariantMap& json)
+void
+GetStatus::Request::writeJson(JsonRpc::JsonWriter& json) const
 {
-    GetAddresses::Response value;
+    const GetStatus::Request& value = *this;
+
+    RPCAPI_WRITE_FIELD(value, json, top_block_hash);
+    RPCAPI_WRITE_FIELD(value, json, transaction_pool_version);
+    RPCAPI_WRITE_FIELD(value, json, outgoing_peer_count);
+    RPCAPI_WRITE_FIELD(value, json, incoming_peer_count);
+    RPCAPI_WRITE_FIELD(value, json, lower_level_error);
+}
 
+template<typename Json>
+static
+void deserialize(GetAddresses::Response& value, const Json& json)
+{
     RPCAPI_DESERIALIZE_FIELD(value, json, addresses);
     RPCAPI_DESERIALIZE_FIELD(value, json, secret_spend_keys);
     RPCAPI_DESERIALIZE_FIELD(value, json, total_address_count);
-
-    return value;
 }
 
+RPCAPI_DEFINE_FROM_JSON(GetAddresses::Response)
+
 QVariantMap
 GetAddresses::Request::toJson() const
 {
@@ -178,12 +430,10 @@ GetAddresses::Request::toJson() const
     return json;
 }
 
-/*static*/
-GetWalletInfo::Response
-GetWalletInfo::Response::fromJson(const QVariantMap& json)
+template<typename Json>
+static
+void deserialize(GetWalletInfo::Response& value, const Json& json)
 {
-    GetWalletInfo::Response value;
-
     RPCAPI_DESERIALIZE_FIELD(value, json, view_only);
     RPCAPI_DESERIALIZE_FIELD(value, json, wallet_type);
     RPCAPI_DESERIALIZE_FIELD(value, json, can_view_outgoing_addresses);
@@ -196,10 +446,10 @@ GetWalletInfo::Response::fromJson(const QVariantMap& json)
 //    RPCAPI_DESERIALIZE_FIELD(value, json, public_view_key);
 //    RPCAPI_DESERIALIZE_FIELD(value, json, import_keys);
 //    RPCAPI_DESERIALIZE_FIELD(value, json, mnemonic);
-
-    return value;
 }
 
+RPCAPI_DEFINE_FROM_JSON(GetWalletInfo::Response)
+
 QVariantMap
 GetWalletInfo::Request::toJson() const
 {
@@ -211,22 +461,28 @@ GetWalletInfo::Request::toJson() const
     return json;
 }
 
-/*static*/
-GetBalance::Response
-GetBalance::Response::fromJson(const QVariantMap& json)
+void
+GetWalletInfo::Request::writeJson(JsonRpc::JsonWriter& json) const
 {
-    GetBalance::Response value;
+    const GetWalletInfo::Request& value = *this;
+
+    RPCAPI_WRITE_FIELD(value, json, need_secrets);
+}
 
+template<typename Json>
+static
+void deserialize(GetBalance::Response& value, const Json& json)
+{
     RPCAPI_DESERIALIZE_FIELD(value, json, spendable);
     RPCAPI_DESERIALIZE_FIELD(value, json, spendable_dust);
     RPCAPI_DESERIALIZE_FIELD(value, json, locked_or_unconfirmed);
     RPCAPI_DESERIALIZE_FIELD(value, json, spendable_outputs);
     RPCAPI_DESERIALIZE_FIELD(value, json, spendable_dust_outputs);
     RPCAPI_DESERIALIZE_FIELD(value, json, locked_or_unconfirmed_outputs);
-
-    return value;
 }
 
+RPCAPI_DEFINE_FROM_JSON(GetBalance::Response)
+
 QVariantMap
 GetBalance::Request::toJson() const
 {
@@ -239,20 +495,27 @@ GetBalance::Request::toJson() const
     return json;
 }
 
-/*static*/
-GetTransfers::Response
-GetTransfers::Response::fromJson(const QVariantMap& json)
+void
+GetBalance::Request::writeJson(JsonRpc::JsonWriter& json) const
 {
-    GetTransfers::Response value;
+    const GetBalance::Request& value = *this;
+
+    RPCAPI_WRITE_FIELD(value, json, address);
+    RPCAPI_WRITE_FIELD(value, json, height_or_depth);
+}
 
+template<typename Json>
+static
+void deserialize(GetTransfers::Response& value, const Json& json)
+{
     RPCAPI_DESERIALIZE_LIST(value, json, blocks);
     RPCAPI_DESERIALIZE_LIST(value, json, unlocked_transfers);
     RPCAPI_DESERIALIZE_FIELD(value, json, next_from_height);
     RPCAPI_DESERIALIZE_FIELD(value, json, next_to_height);
-
-    return value;
 }
 
+RPCAPI_DEFINE_FROM_JSON(GetTransfers::Response)
+
 QVariantMap
 GetTransfers::Request::toJson() const
 {
@@ -269,21 +532,32 @@ GetTransfers::Request::toJson() const
     return json;
 }
 
-/*static*/
-CreateTransaction::Response
-CreateTransaction::Response::fromJson(const QVariantMap& json)
+void
+GetTransfers::Request::writeJson(JsonRpc::JsonWriter& json) const
 {
-    CreateTransaction::Response value;
+    const GetTransfers::Request& value = *this;
 
+    RPCAPI_WRITE_FIELD(value, json, address);
+    RPCAPI_WRITE_FIELD(value, json, from_height);
+    RPCAPI_WRITE_FIELD(value, json, to_height);
+    RPCAPI_WRITE_FIELD(value, json, forward);
+    RPCAPI_WRITE_FIELD(value, json, desired_transactions_count);
+    RPCAPI_WRITE_FIELD(value, json, need_outputs);
+}
+
+template<typename Json>
+static
+void deserialize(CreateTransaction::Response& value, const Json& json)
+{
     RPCAPI_DESERIALIZE_FIELD(value, json, binary_transaction);
     RPCAPI_DESERIALIZE_FIELD(value, json, save_history_error);
     RPCAPI_DESERIALIZE_FIELD(value, json, transactions_required);
 
     RPCAPI_DESERIALIZE_STRUCT(value, json, transaction);
-
-    return value;
 }
 
+RPCAPI_DEFINE_FROM_JSON(CreateTransaction::Response)
+
 QVariantMap
 CreateTransaction::Request::toJson() const
 {
@@ -305,17 +579,15 @@ CreateTransaction::Request::toJson() const
     return json;
 }
 
-/*static*/
-SendTransaction::Response
-SendTransaction::Response::fromJson(const QVariantMap& json)
+template<typename Json>
+static
+void deserialize(SendTransaction::Response& value, const Json& json)
 {
-    SendTransaction::Response value;
-
     RPCAPI_DESERIALIZE_FIELD(value, json, send_result);
-
-    return value;
 }
 
+RPCAPI_DEFINE_FROM_JSON(SendTransaction::Response)
+
 QVariantMap
 SendTransaction::Request::toJson() const
 {
@@ -327,12 +599,10 @@ SendTransaction::Request::toJson() const
     return json;
 }
 
-/*static*/
-Output
-Output::fromJson(const QVariantMap& json)
+template<typename Json>
+static
+void deserialize(Output& value, const Json& json)
 {
-    Output value;
-
     RPCAPI_DESERIALIZE_FIELD(value, json, amount);
     RPCAPI_DESERIALIZE_FIELD(value, json, public_key);
     RPCAPI_DESERIALIZE_FIELD(value, json, stack_index);
@@ -344,10 +614,10 @@ Output::fromJson(const QVariantMap& json)
     RPCAPI_DESERIALIZE_FIELD(value, json, key_image);
     RPCAPI_DESERIALIZE_FIELD(value, json, address);
     RPCAPI_DESERIALIZE_FIELD(value, json, dust);
-
-    return value;
 }
 
+RPCAPI_DEFINE_FROM_JSON(Output)
+
 QVariantMap
 Output::toJson() const
 {
@@ -369,12 +639,10 @@ Output::toJson() const
     return json;
 }
 
-/*static*/
-Transfer
-Transfer::fromJson(const QVariantMap& json)
+template<typename Json>
+static
+void deserialize(Transfer& value, const Json& json)
 {
-    Transfer value;
-
     RPCAPI_DESERIALIZE_FIELD(value, json, address);
     RPCAPI_DESERIALIZE_FIELD(value, json, amount);
     RPCAPI_DESERIALIZE_FIELD(value, json, ours);
@@ -382,10 +650,10 @@ Transfer::fromJson(const QVariantMap& json)
     RPCAPI_DESERIALIZE_FIELD(value, json, transaction_hash);
 
 //    RPCAPI_DESERIALIZE_LIST(value, json, outputs);
-
-    return value;
 }
 
+RPCAPI_DEFINE_FROM_JSON(Transfer)
+
 QVariantMap
 Transfer::toJson() const
 {
@@ -403,12 +671,10 @@ Transfer::toJson() const
     return json;
 }
 
-/*static*/
-BlockHeader
-BlockHeader::fromJson(const QVariantMap& json)
+template<typename Json>
+static
+void deserialize(BlockHeader& value, const Json& json)
 {
-    BlockHeader value;
-
     RPCAPI_DESERIALIZE_FIELD(value, json, major_version);
     RPCAPI_DESERIALIZE_FIELD(value, json, minor_version);
     RPCAPI_DESERIALIZE_TIMESTAMP(value, json, timestamp);
@@ -433,43 +699,37 @@ BlockHeader::fromJson(const QVariantMap& json)
     RPCAPI_DESERIALIZE_FIELD(value, json, block_capacity_vote_median);
     RPCAPI_DESERIALIZE_TIMESTAMP(value, json, timestamp_median);
     RPCAPI_DESERIALIZE_FIELD(value, json, transactions_fee);
-
-    return value;
 }
 
-/*static*/
-Block
-Block::fromJson(const QVariantMap& json)
-{
-    Block value;
+RPCAPI_DEFINE_FROM_JSON(BlockHeader)
 
+template<typename Json>
+static
+void deserialize(Block& value, const Json& json)
+{
     RPCAPI_DESERIALIZE_STRUCT(value, json, header);
     RPCAPI_DESERIALIZE_LIST(value, json, transactions);
-
-    return value;
 }
 
-/*static*/
-WalletRecord
-WalletRecord::fromJson(const QVariantMap& json)
-{
-    WalletRecord value;
+RPCAPI_DEFINE_FROM_JSON(Block)
 
+template<typename Json>
+static
+void deserialize(WalletRecord& value, const Json& json)
+{
     RPCAPI_DESERIALIZE_FIELD(value, json, address);
     RPCAPI_DESERIALIZE_FIELD(value, json, label);
     RPCAPI_DESERIALIZE_FIELD(value, json, index);
 //    RPCAPI_DESERIALIZE_FIELD(value, json, secret_spend_key);
 //    RPCAPI_DESERIALIZE_FIELD(value, json, public_spend_key);
-
-    return value;
 }
 
-/*static*/
-Transaction
-Transaction::fromJson(const QVariantMap& json)
-{
-    Transaction value;
+RPCAPI_DEFINE_FROM_JSON(WalletRecord)
 
+template<typename Json>
+static
+void deserialize(Transaction& value, const Json& json)
+{
     RPCAPI_DESERIALIZE_FIELD(value, json, unlock_block_or_timestamp);
 //    RPCAPI_DESERIALIZE_FIELD(value, json, payment_id);
     RPCAPI_DESERIALIZE_FIELD(value, json, anonymity);
@@ -487,10 +747,10 @@ Transaction::fromJson(const QVariantMap& json)
 
     RPCAPI_DESERIALIZE_LIST(value, json, transfers);
     RPCAPI_DESERIALIZE_TIMESTAMP(value, json, timestamp);
-
-    return value;
 }
 
+RPCAPI_DEFINE_FROM_JSON(Transaction)
+
 QVariantMap
 Transaction::toJson() const
 {
@@ -534,17 +794,15 @@ Transaction::toJson() const
 //}
 
 
-/*static*/
-CreateSendProof::Response
-CreateSendProof::Response::fromJson(const QVariantMap& json)
+template<typename Json>
+static
+void deserialize(CreateSendProof::Response& value, const Json& json)
 {
-    CreateSendProof::Response value;
-
     RPCAPI_DESERIALIZE_FIELD(value, json, sendproofs);
-
-    return value;
 }
 
+RPCAPI_DEFINE_FROM_JSON(CreateSendProof::Response)
+
 QVariantMap
 CreateSendProof::Request::toJson() const
 {
@@ -558,22 +816,20 @@ CreateSendProof::Request::toJson() const
     return json;
 }
 
-/*static*/
-CheckSendProof::Response
-CheckSendProof::Response::fromJson(const QVariantMap& json)
+template<typename Json>
+static
+void deserialize(CheckSendProof::Response& value, const Json& json)
 {
-    CheckSendProof::Response value;
-
 //    RPCAPI_DESERIALIZE_FIELD(value, json, validation_error);
     RPCAPI_DESERIALIZE_FIELD(value, json, transaction_hash);
     RPCAPI_DESERIALIZE_FIELD(value, json, address);
     RPCAPI_DESERIALIZE_FIELD(value, json, amount);
     RPCAPI_DESERIALIZE_FIELD(value, json, message);
     RPCAPI_DESERIALIZE_FIELD(value, json, output_indexes);
-
-    return value;
 }
 
+RPCAPI_DEFINE_FROM_JSON(CheckSendProof::Response)
+
 QVariantMap
 CheckSendProof::Request::toJson() const
 {
@@ -611,18 +867,27 @@ GetWalletRecords::Request::toJson() const
     return json;
 }
 
-/*static*/
-GetWalletRecords::Response
-GetWalletRecords::Response::fromJson(const QVariantMap& json)
+void
+GetWalletRecords::Request::writeJson(JsonRpc::JsonWriter& json) const
 {
-    GetWalletRecords::Response value;
+    const GetWalletRecords::Request& value = *this;
 
+    RPCAPI_WRITE_FIELD(value, json, need_secrets);
+    RPCAPI_WRITE_FIELD(value, json, create);
+    RPCAPI_WRITE_FIELD(value, json, index);
+    RPCAPI_WRITE_FIELD(value, json, count);
+}
+
+template<typename Json>
+static
+void deserialize(GetWalletRecords::Response& value, const Json& json)
+{
     RPCAPI_DESERIALIZE_LIST(value, json, records);
     RPCAPI_DESERIALIZE_FIELD(value, json, total_count);
-
-    return value;
 }
 
+RPCAPI_DEFINE_FROM_JSON(GetWalletRecords::Response)
+
 QVariantMap
 CreateAddresses::Request::toJson() const
 {
@@ -635,18 +900,17 @@ CreateAddresses::Request::toJson() const
     return json;
 }
 
-/*static*/
-CreateAddresses::Response
-CreateAddresses::Response::fromJson(const QVariantMap& json)
+template<typename Json>
+static
+void deserialize(CreateAddresses::Response& value, const Json& json)
 {
-    CreateAddresses::Response value;
-
     RPCAPI_DESERIALIZE_FIELD(value, json, addresses);
     RPCAPI_DESERIALIZE_FIELD(value, json, secret_spend_keys);
-
-    return value;
 }
 
+RPCAPI_DEFINE_FROM_JSON(CreateAddresses::Response)
+
+#undef RPCAPI_WRITE_FIELD
 #undef RPCAPI_SERIALIZE_FIELD
 #undef RPCAPI_SERIALIZE_TIMESTAMP
 #undef RPCAPI_SERIALIZE_STRUCT
@@ -656,5 +920,6 @@ CreateAddresses::Response::fromJson(const QVariantMap& json)
 #undef RPCAPI_DESERIALIZE_TIMESTAMP
 #undef RPCAPI_DESERIALIZE_LIST
 #undef RPCAPI_DESERIALIZE_STRUCT
+#undef RPCAPI_DEFINE_FROM_JSON
 
 }
@@ -9,8 +9,16 @@
 #include <QMap>
 #include <QMetaType>
 #include <QVariantMap>
+#include <QJsonObject>
 #include <QDateTime>
 #include "common.h"
+#include "addresspool.h"
+#include "hash32.h"
+
+namespace JsonRpc
+{
+class JsonWriter;
+}
 
 namespace RpcApi
 {
@@ -22,7 +30,7 @@ typedef quint64 Timestamp;
 typedef qint64 SignedAmount;
 typedef qint32 HeightOrDepth;
 typedef quint64 BlockOrTimestamp;  // Height or Timestamp,
-typedef QString Hash;
+typedef Hash32 Hash;
 
 constexpr HeightOrDepth DEFAULT_CONFIRMATIONS = CONFIRMATIONS;
 constexpr char MAIN_NET_NAME[] = "main";
@@ -63,6 +71,8 @@ struct EmptyStruct
 {
     static EmptyStruct fromJson(const QVariantMap&)
     { return EmptyStruct{}; }
+    static EmptyStruct fromJson(const QJsonObject&)
+    { return EmptyStruct{}; }
 };
 
 struct Output
@@ -82,6 +92,7 @@ struct Output
     bool dust = false;
 
     static Output fromJson(const QVariantMap& json);
+    static Output fromJson(const QJsonObject& json);
     QVariantMap toJson() const;
 
     auto tie() const
@@ -103,15 +114,16 @@ struct Output
 
 struct Transfer
 {
-    QString address;
+    Address address;
     SignedAmount amount = 0;
     bool ours = true;
     bool locked = false;
     // we do not request outputs
 //    QList<Output> outputs;
-    QString transaction_hash;
+    Hash transaction_hash;
 
     static Transfer fromJson(const QVariantMap& json);
+    static Transfer fromJson(const QJsonObject& json);
     QVariantMap toJson() const;
 
     auto tie() const
@@ -130,14 +142,14 @@ struct Transaction
 {
     BlockOrTimestamp unlock_block_or_timestamp = 0;
     QList<Transfer> transfers;
-    Hash payment_id{};
+    QString payment_id; // typed in by the user when sending, so kept as text
     quint64 anonymity = 0;
 
     Hash hash;
     Hash prefix_hash;
     Hash inputs_hash;
     Amount fee = 0;
-    QString public_key;
+    Hash public_key;
     QString extra;
     bool coinbase = false;
     Amount amount = 0;
@@ -149,6 +161,7 @@ struct Transaction
     quint64 size = 0;
 
     static Transaction fromJson(const QVariantMap& json);
+    static Transaction fromJson(const QJsonObject& json);
     QVariantMap toJson() const;
 
     auto tie() const
@@ -201,6 +214,7 @@ struct BlockHeader
     Amount transactions_fee = 0;
 
     static BlockHeader fromJson(const QVariantMap& json);
+    static BlockHeader fromJson(const QJsonObject& json);
 
     auto tie() const
     {
@@ -237,6 +251,7 @@ struct Block
     QList<Transaction> transactions;
 
     static Block fromJson(const QVariantMap& json);
+    static Block fromJson(const QJsonObject& json);
 
     auto tie() const
     {
@@ -256,6 +271,7 @@ struct WalletRecord
 //    QString public_spend_key;
 
     static WalletRecord fromJson(const QVariantMap& json);
+    static WalletRecord fromJson(const QJsonObject& json);
 
     auto tie() const
     {
@@ -281,11 +297,12 @@ struct GetStatus
         QString lower_level_error;
 
         QVariantMap toJson() const;
+        void writeJson(JsonRpc::JsonWriter& json) const; // same params as toJson(), for polling
     };
 
     struct Response
     {
-        Hash top_block_hash = 0;
+        Hash top_block_hash;
         quint64 transaction_pool_version = 0;
         quint64 outgoing_peer_count = 0;
         quint64 incoming_peer_count = 0;
@@ -302,6 +319,7 @@ struct GetStatus
         quint64 recommended_max_transaction_size = 0;
 
         static Response fromJson(const QVariantMap& json);
+        static Response fromJson(const QJsonObject& json);
 
         auto tie() const
         {
@@ -344,6 +362,7 @@ struct GetAddresses
         quint64 total_address_count = 0;
 
         static Response fromJson(const QVariantMap& json);
+        static Response fromJson(const QJsonObject& json);
     };
 };
 
@@ -356,6 +375,7 @@ struct GetWalletInfo
         bool need_secrets = false;
 
         QVariantMap toJson() const;
+        void writeJson(JsonRpc::JsonWriter& json) const; // same params as toJson(), for polling
     };
 
 
@@ -375,6 +395,7 @@ struct GetWalletInfo
         QString mnemonic;    // for HD wallets
 
         static Response fromJson(const QVariantMap& json);
+        static Response fromJson(const QJsonObject& json);
 
         auto tie() const
         {
@@ -407,6 +428,7 @@ struct GetWalletRecords
         quint32 count  = std::numeric_limits<quint32>::max();
 
         QVariantMap toJson() const;
+        void writeJson(JsonRpc::JsonWriter& json) const; // same params as toJson(), for polling
     };
 
     struct Response
@@ -415,6 +437,7 @@ struct GetWalletRecords
         quint64 total_count = 0;
 
         static Response fromJson(const QVariantMap& json);
+        static Response fromJson(const QJsonObject& json);
     };
 };
 
@@ -451,6 +474,7 @@ struct CreateAddresses
         QStringList secret_spend_keys;
 
         static Response fromJson(const QVariantMap& json);
+        static Response fromJson(const QJsonObject& json);
     };
 };
 
@@ -464,6 +488,7 @@ struct GetBalance
         HeightOrDepth height_or_depth = -DEFAULT_CONFIRMATIONS - 1;
 
         QVariantMap toJson() const;
+        void writeJson(JsonRpc::JsonWriter& json) const; // same params as toJson(), for polling
     };
 
     struct Response
@@ -476,6 +501,7 @@ struct GetBalance
         quint64 locked_or_unconfirmed_outputs = 0;
 
         static Response fromJson(const QVariantMap& json);
+        static Response fromJson(const QJsonObject& json);
 
         auto tie() const
         {
@@ -525,6 +551,7 @@ struct GetTransfers
         bool need_outputs = false;
 
         QVariantMap toJson() const;
+        void writeJson(JsonRpc::JsonWriter& json) const; // same params as toJson(), for polling
     };
 
     struct Response
@@ -535,6 +562,7 @@ struct GetTransfers
         Height next_to_height = 0;
 
         static Response fromJson(const QVariantMap& json);
+        static Response fromJson(const QJsonObject& json);
     };
 };
 
@@ -566,6 +594,7 @@ struct CreateTransaction
         QStringList transactions_required;
 
         static Response fromJson(const QVariantMap& json);
+        static Response fromJson(const QJsonObject& json);
     };
 };
 
@@ -585,6 +614,7 @@ struct SendTransaction
         QString send_result;
 
         static Response fromJson(const QVariantMap& json);
+        static Response fromJson(const QJsonObject& json);
     };
 };
 
@@ -604,6 +634,7 @@ struct GetTransaction
         Transaction transaction;
 
         static Response fromJson(const QVariantMap& json);
+        static Response fromJson(const QJsonObject& json);
     };
 };
 
@@ -625,6 +656,7 @@ struct CreateSendProof
         QStringList sendproofs;
 
         static Response fromJson(const QVariantMap& json);
+        static Response fromJson(const QJsonObject& json);
     };
 };
 
@@ -650,6 +682,7 @@ struct CheckSendProof
         QList<quint64> output_indexes;
 
         static Response fromJson(const QVariantMap& json);
+        static Response fromJson(const QJsonObject& json);
     };
 };
 
@@ -244,7 +244,7 @@ void SendFrame::sendClicked()
         transferSum += amount;
 
         RpcApi::Transfer tr;
-        tr.address = address;
+        tr.address = RpcApi::Address::intern(address);
         tr.amount = amount;
         trs << tr;
     }
@@ -35,6 +35,7 @@ constexpr char OPTION_MINING_CPU_CORE_COUNT[] = "miningCpuCoreCount";
 constexpr char OPTION_MINING_POOL_LIST[] = "miningPoolList";
 constexpr char OPTION_RECENT_WALLETS[] = "recentWallets";
 constexpr char OPTION_WALLETD_PARAMS[] = "walletdParams";
+constexpr char OPTION_WALLETD_COMPRESSION[] = "walletdCompression"; // followed by /<host>:<port>
 
 constexpr quint16 DEFAULT_MAIN_WALLETD_RPC_PORT = 8070;
 constexpr quint16 DEFAULT_TEST_WALLETD_RPC_PORT = DEFAULT_MAIN_WALLETD_RPC_PORT + 1000;
@@ -252,6 +253,14 @@ QString Settings::getWalletdParams() const
     return settings_->value(OPTION_WALLETD_PARAMS).toString();
 }
 
+RpcCompression Settings::getWalletdCompression(const QString& endPoint) const
+{
+    // Compressing costs more than it saves on the loopback
+    const bool local = endPoint.startsWith(LOCAL_HOST) || endPoint.startsWith(QLatin1String("localhost"));
+    const RpcCompression defaultCompression = local ? RpcCompression::NONE : RpcCompression::RESPONSES;
+    return getEnumValue<RpcCompression>(QString("%1/%2").arg(OPTION_WALLETD_COMPRESSION).arg(endPoint), defaultCompression);
+}
+
 quint16 Settings::getDefaultWalletdPort() const
 {
     switch(getNetworkType())
@@ -280,6 +289,11 @@ void Settings::setWalletdParams(const QString& params)
     settings_->setValue(OPTION_WALLETD_PARAMS, params);
 }
 
+void Settings::setWalletdCompression(const QString& endPoint, RpcCompression compression)
+{
+    settings_->setValue(QString("%1/%2").arg(OPTION_WALLETD_COMPRESSION).arg(endPoint), static_cast<int>(compression));
+}
+
 //void Settings::setLocalRpcPort(quint16 port)
 //{
 //    settings_->setValue(OPTION_LOCAL_RPC_PORT, port);
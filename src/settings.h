@@ -25,6 +25,11 @@ enum class NetworkType : int
     MAIN, STAGE, TEST
 };
 
+enum class RpcCompression : int
+{
+    NONE, RESPONSES, REQUESTS_AND_RESPONSES
+};
+
 class Settings : public QObject
 {
     Q_OBJECT
@@ -78,8 +83,10 @@ public:
     QStringList getRecentWallets() const;
 
     QString getWalletdParams() const;
+    RpcCompression getWalletdCompression(const QString& endPoint) const;
 
     void setWalletdParams(const QString& params);
+    void setWalletdCompression(const QString& endPoint, RpcCompression compression);
 //    void setLocalRpcPort(quint16 port);
 //    void setRemoteRpcEndPoint(const QString& host, quint16 port);
     void setLocalWalletdPort(quint16 port);
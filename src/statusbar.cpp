@@ -11,6 +11,7 @@
 #include "statusbar.h"
 //#include "statusmodel.h"
 #include "walletmodel.h"
+#include "walletstatemodel.h"
 #include "JsonRpc/JsonRpcClient.h"
 
 namespace WalletGUI {
@@ -82,13 +83,13 @@ void WalletStatusBar::setWalletModel(WalletModel* model)
     if (needToDisconnect)
         disconnect(walletModel_, 0, this, 0); // disconnect all signals from walletModel_ to all our slots
     walletModel_ = model;
-    stateMapper_->setModel(walletModel_); // clears all previously set mappings
+    stateMapper_->setModel(walletModel_->getStateModel()); // clears all previously set mappings
     stateMapper_->addMapping(m_peerCountLabel, WalletModel::COLUMN_PEER_COUNT_SUM, "text");
     stateMapper_->addMapping(m_walletConnectionLabel, WalletModel::COLUMN_STATE, "text");
     stateMapper_->addMapping(m_bytecoindConnectionLabel, WalletModel::COLUMN_LOWER_LEVEL_ERROR, "text");
 //    stateMapper_->addMapping(m_hdStatusLabel, WalletModel::COLUMN_DETERMINISTIC, "text");
     stateMapper_->toFirst();
-    connect(walletModel_, &QAbstractItemModel::modelReset, stateMapper_, &QDataWidgetMapper::toFirst);
+    connect(walletModel_->getStateModel(), &QAbstractItemModel::modelReset, stateMapper_, &QDataWidgetMapper::toFirst);
     connect(walletModel_, &QAbstractItemModel::dataChanged, this, &WalletStatusBar::nodeStateChanged);
 }
 
@@ -0,0 +1,970 @@
+// Copyright (c) 2015-2018, The Bytecoin developers.
+// Licensed under the GNU Lesser General Public License. See LICENSE for details.
+
+#include <algorithm>
+#include <cstring>
+
+#include <QDataStream>
+#include <QDir>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QtEndian>
+
+#include "txcolumnstore.h"
+
+namespace WalletGUI
+{
+
+namespace
+{
+
+constexpr quint32 STORE_MAGIC = 0x42434e53; // "BCNS"
+constexpr quint16 STORE_VERSION = 2; // 2 added net amounts and balance totals
+constexpr QDataStream::Version STORE_STREAM_VERSION = QDataStream::Qt_5_6;
+constexpr char COMMITTED_FILE[] = "committed";
+constexpr char DAYS_FILE[] = "days"; // written after "committed", made again from the columns if it lags behind
+
+constexpr quint32 LOOKUP_MAGIC = 0x42434e4c; // "BCNL"
+constexpr quint16 LOOKUP_VERSION = 1;
+
+constexpr qint64 SECONDS_PER_DAY = 24 * 60 * 60;
+constexpr qint64 UNIX_EPOCH_JULIAN_DAY = 2440588;
+
+constexpr int HASH_SIZE = RpcApi::Hash::SIZE;
+
+// unlock_block_or_timestamp, anonymity, size, coinbase, prefix_hash, inputs_hash, public_key
+constexpr int DETAILS_WIDTH = 8 + 8 + 8 + 1 + 3 * HASH_SIZE;
+
+struct ColumnInfo
+{
+    const char* name;
+    int width; // bytes per row, 0 for the heap
+};
+
+const ColumnInfo COLUMNS[] = {
+    {"height", 4},
+    {"timestamp", 8}, // seconds since epoch, -1 for unknown
+    {"amount", 8},
+    {"net", 8},
+    {"fee", 8},
+    {"running", 24}, // net, volume and fees through the row
+    {"hash", HASH_SIZE},
+    {"block_hash", HASH_SIZE},
+    {"details", DETAILS_WIDTH},
+    {"heap_offset", 8},
+    {"heap", 0},
+};
+
+const char* const LOOKUPS[] = {"by_hash", "by_block_hash", "by_payment_id", "by_address", "by_amount"};
+
+// magic, version, lookup, first row, end row, entry count, hash of the last row; then the entries,
+// row and key offset past the entries each, then the keys, as heap strings
+constexpr int RUN_HEADER_SIZE = 4 + 2 + 2 + 4 + 4 + 4 + HASH_SIZE;
+constexpr int RUN_ENTRY_SIZE = 8;
+
+template<typename T>
+T readValue(const uchar* data)
+{
+    T value;
+    std::memcpy(&value, data, sizeof(value));
+    return value;
+}
+
+template<typename T>
+void appendValue(QByteArray& out, T value)
+{
+    out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+void appendHash(QByteArray& out, const RpcApi::Hash& hash)
+{
+    out.append(reinterpret_cast<const char*>(hash.data()), HASH_SIZE);
+}
+
+void appendString(QByteArray& heap, const QString& string)
+{
+    const QByteArray utf8 = string.toUtf8();
+    appendValue<quint32>(heap, utf8.size());
+    heap.append(utf8);
+}
+
+// Heap records are written by this process and cut off at committed lengths, so they are trusted to be whole
+QString readString(const uchar*& data)
+{
+    const quint32 size = readValue<quint32>(data);
+    const QString result = QString::fromUtf8(reinterpret_cast<const char*>(data + 4), size);
+    data += 4 + size;
+    return result;
+}
+
+void skipString(const uchar*& data)
+{
+    data += 4 + readValue<quint32>(data);
+}
+
+// Big endian with the sign bit flipped, so that the bytes compare as the amounts do
+void appendAmountKey(QByteArray& out, RpcApi::SignedAmount amount)
+{
+    appendValue<quint64>(out, qToBigEndian(quint64(amount) ^ (quint64(1) << 63)));
+}
+
+int compareKeys(const uchar* lhs, quint32 lhsSize, const uchar* rhs, quint32 rhsSize)
+{
+    const int result = std::memcmp(lhs, rhs, qMin(lhsSize, rhsSize));
+    if (result != 0)
+        return result;
+    return lhsSize < rhsSize ? -1 : lhsSize > rhsSize ? 1 : 0;
+}
+
+int runFirstRow(const uchar* run) { return readValue<qint32>(run + 8); }
+int runEndRow(const uchar* run) { return readValue<qint32>(run + 12); }
+int runSize(const uchar* run) { return readValue<qint32>(run + 16); }
+int runRows(const uchar* run) { return runEndRow(run) - runFirstRow(run); }
+const uchar* runLastHash(const uchar* run) { return run + 20; }
+const uchar* runData(const QByteArray& run) { return reinterpret_cast<const uchar*>(run.constData()); }
+
+int runRow(const uchar* run, int i)
+{
+    return readValue<qint32>(run + RUN_HEADER_SIZE + qint64(i) * RUN_ENTRY_SIZE);
+}
+
+const uchar* runKey(const uchar* run, int i, quint32& size)
+{
+    const uchar* keys = run + RUN_HEADER_SIZE + qint64(runSize(run)) * RUN_ENTRY_SIZE;
+    const uchar* key = keys + readValue<quint32>(run + RUN_HEADER_SIZE + qint64(i) * RUN_ENTRY_SIZE + 4);
+    size = readValue<quint32>(key);
+    return key + 4;
+}
+
+// Takes entries sorted by key and row; a key shared with the entry before is written once.
+// The keys are pointed to, not copied, until finish().
+class RunWriter
+{
+public:
+    void add(const uchar* key, quint32 size, int row)
+    {
+        const bool sameKey = count_ > 0 && compareKeys(key, size, lastKey_, lastSize_) == 0;
+        if (sameKey && row == lastRow_)
+            return;
+        if (!sameKey)
+        {
+            lastOffset_ = keys_.size();
+            appendValue<quint32>(keys_, size);
+            keys_.append(reinterpret_cast<const char*>(key), size);
+            lastKey_ = key;
+            lastSize_ = size;
+        }
+        appendValue<qint32>(entries_, row);
+        appendValue<quint32>(entries_, lastOffset_);
+        lastRow_ = row;
+        ++count_;
+    }
+
+    QByteArray finish(int lookup, int firstRow, int endRow, const uchar* lastHash) const
+    {
+        QByteArray run;
+        run.reserve(RUN_HEADER_SIZE + entries_.size() + keys_.size());
+        appendValue<quint32>(run, LOOKUP_MAGIC);
+        appendValue<quint16>(run, LOOKUP_VERSION);
+        appendValue<quint16>(run, lookup);
+        appendValue<qint32>(run, firstRow);
+        appendValue<qint32>(run, endRow);
+        appendValue<qint32>(run, count_);
+        run.append(reinterpret_cast<const char*>(lastHash), HASH_SIZE);
+        run.append(entries_);
+        run.append(keys_);
+        return run;
+    }
+
+private:
+    QByteArray entries_;
+    QByteArray keys_;
+    const uchar* lastKey_ = nullptr;
+    quint32 lastSize_ = 0;
+    quint32 lastOffset_ = 0;
+    int lastRow_ = -1;
+    int count_ = 0;
+};
+
+// Two runs next to each other, the rows of newer all after those of older
+QByteArray mergeRuns(int lookup, const uchar* older, const uchar* newer)
+{
+    RunWriter writer;
+    const int olderSize = runSize(older);
+    const int newerSize = runSize(newer);
+    int i = 0;
+    int j = 0;
+    while (i < olderSize || j < newerSize)
+    {
+        quint32 olderKeySize = 0;
+        quint32 newerKeySize = 0;
+        const uchar* olderKey = i < olderSize ? runKey(older, i, olderKeySize) : nullptr;
+        const uchar* newerKey = j < newerSize ? runKey(newer, j, newerKeySize) : nullptr;
+        if (olderKey && (!newerKey || compareKeys(olderKey, olderKeySize, newerKey, newerKeySize) <= 0))
+            writer.add(olderKey, olderKeySize, runRow(older, i++));
+        else
+            writer.add(newerKey, newerKeySize, runRow(newer, j++));
+    }
+    return writer.finish(lookup, runFirstRow(older), runEndRow(newer), runLastHash(newer));
+}
+
+// A key of a row being put in a run: in the mapped columns, or at an offset of the keys made for the run
+struct RowKey
+{
+    const uchar* data;
+    int made;
+    quint32 size;
+    int row;
+};
+
+}
+
+TxColumnStore::TxColumnStore(const QString& dirName)
+    : dirName_(dirName)
+    , count_(0)
+    , heapSize_(0)
+{
+    for (const uchar*& data : data_)
+        data = nullptr;
+}
+
+TxColumnStore::~TxColumnStore()
+{
+    unmap();
+    unmapRuns();
+}
+
+QString TxColumnStore::path(int column) const
+{
+    return QDir(dirName_).absoluteFilePath(QString::fromLatin1(COLUMNS[column].name));
+}
+
+qint64 TxColumnStore::committedLength(int column) const
+{
+    return column == HEAP ? heapSize_ : qint64(count_) * COLUMNS[column].width;
+}
+
+const uchar* TxColumnStore::cell(int column, int row) const
+{
+    Q_ASSERT(row >= 0 && row < count_);
+    return data_[column] + qint64(row) * COLUMNS[column].width;
+}
+
+const uchar* TxColumnStore::heapRecord(int row) const
+{
+    return data_[HEAP] + readValue<qint64>(cell(HEAP_OFFSET, row));
+}
+
+bool TxColumnStore::open()
+{
+    unmap();
+    unmapRuns();
+    count_ = 0;
+    heapSize_ = 0;
+    days_.clear();
+
+    QFile file(QDir(dirName_).absoluteFilePath(QString::fromLatin1(COMMITTED_FILE)));
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+    QDataStream stream(&file);
+    stream.setVersion(STORE_STREAM_VERSION);
+    quint32 magic = 0;
+    quint16 version = 0;
+    qint32 count = 0;
+    qint64 heapSize = 0;
+    stream >> magic >> version >> count >> heapSize;
+    if (stream.status() != QDataStream::Ok || magic != STORE_MAGIC || version != STORE_VERSION || count < 0 || heapSize < 0)
+        return false;
+
+    count_ = count;
+    heapSize_ = heapSize;
+    for (int column = 0; column < COLUMN_COUNT; ++column)
+        if (QFileInfo(path(column)).size() < committedLength(column))
+        {
+            count_ = 0;
+            heapSize_ = 0;
+            return false;
+        }
+    if (!map())
+    {
+        count_ = 0;
+        heapSize_ = 0;
+        return false;
+    }
+    if (!loadDays())
+    {
+        rebuildDays();
+        saveDays();
+    }
+    for (int lookup = 0; lookup < LOOKUP_COUNT; ++lookup)
+    {
+        while (loadRun(lookup))
+            ;
+        addRows(lookup); // whatever the runs on disk lack, all of it for a store older than them
+    }
+    return count_ > 0;
+}
+
+bool TxColumnStore::map()
+{
+    for (int column = 0; column < COLUMN_COUNT; ++column)
+    {
+        const qint64 length = committedLength(column);
+        if (length == 0)
+            continue;
+        files_[column].setFileName(path(column));
+        if (!files_[column].open(QIODevice::ReadOnly))
+        {
+            unmap();
+            return false;
+        }
+        data_[column] = files_[column].map(0, length);
+        if (!data_[column])
+        {
+            qDebug("[TxColumnStore] Cannot map %s: %s.", qPrintable(path(column)), qPrintable(files_[column].errorString()));
+            unmap();
+            return false;
+        }
+    }
+    return true;
+}
+
+void TxColumnStore::unmap()
+{
+    for (int column = 0; column < COLUMN_COUNT; ++column)
+    {
+        if (data_[column])
+            files_[column].unmap(const_cast<uchar*>(data_[column]));
+        data_[column] = nullptr;
+        files_[column].close();
+    }
+}
+
+bool TxColumnStore::writeCommitted(int count, qint64 heapSize) const
+{
+    QSaveFile file(QDir(dirName_).absoluteFilePath(QString::fromLatin1(COMMITTED_FILE)));
+    if (!file.open(QIODevice::WriteOnly))
+        return false;
+    QDataStream stream(&file);
+    stream.setVersion(STORE_STREAM_VERSION);
+    stream << STORE_MAGIC << STORE_VERSION << qint32(count) << heapSize;
+    return stream.status() == QDataStream::Ok && file.commit();
+}
+
+bool TxColumnStore::append(const QVector<RpcApi::Transaction>& txs)
+{
+    if (txs.isEmpty())
+        return true;
+    Q_ASSERT(count_ == 0 || txs.first().block_height >= height(count_ - 1));
+    const int oldCount = count_;
+
+    QByteArray columns[COLUMN_COUNT];
+    for (int column = 0; column < COLUMN_COUNT; ++column)
+        columns[column].reserve(txs.size() * COLUMNS[column].width);
+    QVector<QPair<qint64, BalanceSeries::Totals>> added; // for the days
+    added.reserve(txs.size());
+    BalanceSeries::Totals sum = total();
+    for (const RpcApi::Transaction& tx : txs)
+    {
+        const qint64 seconds = tx.timestamp.isValid() ? tx.timestamp.toMSecsSinceEpoch() / 1000 : -1;
+        const RpcApi::SignedAmount net = TxIndex::amountOf(tx);
+        const BalanceSeries::Totals totals = BalanceSeries::totalsOf(net, tx.fee);
+        sum += totals;
+        added << qMakePair(seconds, totals);
+
+        appendValue<quint32>(columns[HEIGHT], tx.block_height);
+        appendValue<qint64>(columns[TIMESTAMP], seconds);
+        appendValue<quint64>(columns[AMOUNT], tx.amount);
+        appendValue<qint64>(columns[NET], net);
+        appendValue<quint64>(columns[FEE], tx.fee);
+        appendValue<qint64>(columns[RUNNING], sum.net);
+        appendValue<quint64>(columns[RUNNING], sum.volume);
+        appendValue<quint64>(columns[RUNNING], sum.fees);
+        appendHash(columns[HASH], tx.hash);
+        appendHash(columns[BLOCK_HASH], tx.block_hash);
+
+        QByteArray& details = columns[DETAILS];
+        appendValue<quint64>(details, tx.unlock_block_or_timestamp);
+        appendValue<quint64>(details, tx.anonymity);
+        appendValue<quint64>(details, tx.size);
+        appendValue<quint8>(details, tx.coinbase ? 1 : 0);
+        appendHash(details, tx.prefix_hash);
+        appendHash(details, tx.inputs_hash);
+        appendHash(details, tx.public_key);
+
+        QByteArray& heap = columns[HEAP];
+        appendValue<qint64>(columns[HEAP_OFFSET], heapSize_ + heap.size());
+        appendString(heap, tx.payment_id);
+        appendString(heap, tx.extra);
+        appendValue<quint32>(heap, tx.transfers.size());
+        for (const RpcApi::Transfer& tr : tx.transfers)
+        {
+            appendString(heap, tr.address.toString());
+            appendValue<qint64>(heap, tr.amount);
+            appendValue<quint8>(heap, (tr.ours ? 1 : 0) | (tr.locked ? 2 : 0));
+            appendHash(heap, tr.transaction_hash);
+        }
+    }
+
+    QDir().mkpath(dirName_);
+    unmap();
+    bool ok = true;
+    for (int column = 0; column < COLUMN_COUNT && ok; ++column)
+    {
+        // Whatever lies past the committed end is left from an append which did not finish
+        QFile file(path(column));
+        ok = file.open(QIODevice::ReadWrite) &&
+                file.resize(committedLength(column)) &&
+                file.seek(committedLength(column)) &&
+                file.write(columns[column]) == columns[column].size() &&
+                file.flush();
+    }
+    if (ok && writeCommitted(count_ + txs.size(), heapSize_ + columns[HEAP].size()))
+    {
+        count_ += txs.size();
+        heapSize_ += columns[HEAP].size();
+        for (const auto& day : added)
+            addDay(day.first, day.second);
+        sumDays();
+        saveDays();
+    }
+    else
+    {
+        qDebug("[TxColumnStore] Failed to append to %s.", qPrintable(dirName_));
+        ok = false;
+    }
+    if (!map())
+    {
+        count_ = 0;
+        heapSize_ = 0;
+        unmapRuns();
+        return false;
+    }
+    if (count_ > oldCount)
+        for (int lookup = 0; lookup < LOOKUP_COUNT; ++lookup)
+            addRows(lookup);
+    return ok;
+}
+
+bool TxColumnStore::truncate(int size)
+{
+    if (size >= count_)
+        return true;
+    const qint64 heapSize = size > 0 ? readValue<qint64>(cell(HEAP_OFFSET, size)) : 0;
+    if (!writeCommitted(size, heapSize))
+        return false;
+    unmap();
+    count_ = size;
+    heapSize_ = heapSize;
+    if (!map())
+    {
+        count_ = 0;
+        heapSize_ = 0;
+        days_.clear();
+        unmapRuns();
+        return false;
+    }
+    rebuildDays();
+    saveDays();
+    for (int lookup = 0; lookup < LOOKUP_COUNT; ++lookup)
+    {
+        // The run holding the cut is made again from the columns, it is usually one of the small ones at the end
+        std::vector<Run>& runs = runs_[lookup];
+        while (!runs.empty() && runEndRow(runs.back().data) > size)
+        {
+            if (runs.back().file)
+                runs.back().file->unmap(const_cast<uchar*>(runs.back().data));
+            runs.pop_back();
+        }
+        removeRunFiles(lookup, runs.size());
+        addRows(lookup);
+    }
+    return true;
+}
+
+void TxColumnStore::remove()
+{
+    unmap();
+    unmapRuns();
+    count_ = 0;
+    heapSize_ = 0;
+    days_.clear();
+    QDir(dirName_).removeRecursively();
+}
+
+RpcApi::Height TxColumnStore::height(int row) const
+{
+    return readValue<quint32>(cell(HEIGHT, row));
+}
+
+RpcApi::Hash TxColumnStore::hash(int row) const
+{
+    return RpcApi::Hash::fromBytes(cell(HASH, row));
+}
+
+RpcApi::Hash TxColumnStore::blockHash(int row) const
+{
+    return RpcApi::Hash::fromBytes(cell(BLOCK_HASH, row));
+}
+
+RpcApi::Amount TxColumnStore::fee(int row) const
+{
+    return readValue<quint64>(cell(FEE, row));
+}
+
+RpcApi::SignedAmount TxColumnStore::net(int row) const
+{
+    return readValue<qint64>(cell(NET, row));
+}
+
+qint64 TxColumnStore::timestamp(int row) const
+{
+    return readValue<qint64>(cell(TIMESTAMP, row));
+}
+
+quint64 TxColumnStore::unlockBlockOrTimestamp(int row) const
+{
+    return readValue<quint64>(cell(DETAILS, row));
+}
+
+const uchar* TxColumnStore::transfers(int row, quint32& count) const
+{
+    const uchar* heap = heapRecord(row);
+    skipString(heap); // payment id
+    skipString(heap); // extra
+    count = readValue<quint32>(heap);
+    return heap + 4;
+}
+
+bool TxColumnStore::hasForeignTransfer(int row) const
+{
+    quint32 count = 0;
+    const uchar* heap = transfers(row, count);
+    for (quint32 i = 0; i < count; ++i)
+    {
+        skipString(heap); // address
+        if ((heap[8] & 1) == 0)
+            return true;
+        heap += 9 + HASH_SIZE;
+    }
+    return false;
+}
+
+RpcApi::Transaction TxColumnStore::transaction(int row) const
+{
+    RpcApi::Transaction tx;
+    tx.block_height = height(row);
+    const qint64 seconds = timestamp(row);
+    if (seconds >= 0)
+        tx.timestamp = QDateTime::fromMSecsSinceEpoch(seconds * 1000).toUTC();
+    tx.amount = readValue<quint64>(cell(AMOUNT, row));
+    tx.fee = fee(row);
+    tx.hash = hash(row);
+    tx.block_hash = blockHash(row);
+
+    const uchar* details = cell(DETAILS, row);
+    tx.unlock_block_or_timestamp = readValue<quint64>(details);
+    tx.anonymity = readValue<quint64>(details + 8);
+    tx.size = readValue<quint64>(details + 16);
+    tx.coinbase = details[24] != 0;
+    tx.prefix_hash = RpcApi::Hash::fromBytes(details + 25);
+    tx.inputs_hash = RpcApi::Hash::fromBytes(details + 25 + HASH_SIZE);
+    tx.public_key = RpcApi::Hash::fromBytes(details + 25 + 2 * HASH_SIZE);
+
+    const uchar* heap = heapRecord(row);
+    tx.payment_id = readString(heap);
+    tx.extra = readString(heap);
+    const quint32 transferCount = readValue<quint32>(heap);
+    heap += 4;
+    tx.transfers.reserve(transferCount);
+    for (quint32 i = 0; i < transferCount; ++i)
+    {
+        RpcApi::Transfer tr;
+        tr.address = RpcApi::Address::intern(readString(heap));
+        tr.amount = readValue<qint64>(heap);
+        const quint8 flags = heap[8];
+        tr.ours = (flags & 1) != 0;
+        tr.locked = (flags & 2) != 0;
+        tr.transaction_hash = RpcApi::Hash::fromBytes(heap + 9);
+        heap += 9 + HASH_SIZE;
+        tx.transfers << tr;
+    }
+    return tx;
+}
+
+void TxColumnStore::find(const TxIndex::Query& query, QVector<int>& rows) const
+{
+    QVector<int> found;
+    const QString text = query.text.trimmed();
+    if (text.isEmpty())
+    {
+        QByteArray from;
+        QByteArray to;
+        appendAmountKey(from, query.minAmount);
+        appendAmountKey(to, query.maxAmount);
+        findKeys(BY_AMOUNT, from, to, false, found);
+    }
+    else
+    {
+        const QString lower = text.toLower();
+        RpcApi::Hash first;
+        RpcApi::Hash last;
+        if (TxIndex::hashRange(lower, first, last))
+        {
+            const QByteArray from = QByteArray::fromRawData(reinterpret_cast<const char*>(first.data()), HASH_SIZE);
+            const QByteArray to = QByteArray::fromRawData(reinterpret_cast<const char*>(last.data()), HASH_SIZE);
+            findKeys(BY_HASH, from, to, false, found);
+
+            // A block is known by its first row, the others follow it
+            QVector<int> blocks;
+            findKeys(BY_BLOCK_HASH, from, to, false, blocks);
+            for (const int block : blocks)
+                for (int row = block; row < count_ && std::memcmp(cell(BLOCK_HASH, row), cell(BLOCK_HASH, block), HASH_SIZE) == 0; ++row)
+                    found << row;
+        }
+        findKeys(BY_PAYMENT_ID, lower.toUtf8(), QByteArray(), true, found);
+        const QByteArray address = text.toUtf8();
+        findKeys(BY_ADDRESS, address, address, false, found);
+    }
+
+    for (const int row : found)
+    {
+        const RpcApi::Height height = this->height(row);
+        const RpcApi::SignedAmount amount = net(row);
+        if (height >= query.minHeight && height <= query.maxHeight && amount >= query.minAmount && amount <= query.maxAmount)
+            rows << row;
+    }
+}
+
+// The rows with a key from..to, or starting with from when prefix is set: a binary search in each run
+void TxColumnStore::findKeys(int lookup, const QByteArray& from, const QByteArray& to, bool prefix, QVector<int>& rows) const
+{
+    const uchar* fromData = runData(from);
+    const uchar* toData = runData(to);
+    for (const Run& run : runs_[lookup])
+    {
+        const int size = runSize(run.data);
+        int first = 0;
+        int count = size;
+        while (count > 0)
+        {
+            const int step = count / 2;
+            quint32 keySize = 0;
+            const uchar* key = runKey(run.data, first + step, keySize);
+            if (compareKeys(key, keySize, fromData, from.size()) < 0)
+            {
+                first += step + 1;
+                count -= step + 1;
+            }
+            else
+                count = step;
+        }
+        for (int i = first; i < size; ++i)
+        {
+            quint32 keySize = 0;
+            const uchar* key = runKey(run.data, i, keySize);
+            if (prefix ? keySize < quint32(from.size()) || std::memcmp(key, fromData, from.size()) != 0
+                       : compareKeys(key, keySize, toData, to.size()) > 0)
+                break;
+            rows << runRow(run.data, i);
+        }
+    }
+}
+
+QString TxColumnStore::runPath(int lookup, int level) const
+{
+    return QDir(dirName_).absoluteFilePath(QString("%1.%2").arg(QString::fromLatin1(LOOKUPS[lookup])).arg(level));
+}
+
+// The next run of the chain on disk, if it starts where the last one ends and its rows are still the same
+bool TxColumnStore::loadRun(int lookup)
+{
+    std::vector<Run>& runs = runs_[lookup];
+    const int firstRow = runs.empty() ? 0 : runEndRow(runs.back().data);
+    if (firstRow >= count_)
+        return false;
+
+    Run run;
+    run.file.reset(new QFile(runPath(lookup, runs.size())));
+    const qint64 fileSize = run.file->size();
+    if (fileSize < RUN_HEADER_SIZE || !run.file->open(QIODevice::ReadOnly))
+        return false;
+    run.data = run.file->map(0, fileSize);
+    if (!run.data)
+        return false;
+    const int endRow = runEndRow(run.data);
+    const bool valid = readValue<quint32>(run.data) == LOOKUP_MAGIC &&
+            readValue<quint16>(run.data + 4) == LOOKUP_VERSION &&
+            readValue<quint16>(run.data + 6) == lookup &&
+            runFirstRow(run.data) == firstRow &&
+            endRow > firstRow && endRow <= count_ &&
+            runSize(run.data) >= 0 &&
+            fileSize >= RUN_HEADER_SIZE + qint64(runSize(run.data)) * RUN_ENTRY_SIZE &&
+            std::memcmp(runLastHash(run.data), cell(HASH, endRow - 1), HASH_SIZE) == 0;
+    if (!valid)
+    {
+        run.file->unmap(const_cast<uchar*>(run.data));
+        return false;
+    }
+    runs.push_back(std::move(run));
+    return true;
+}
+
+void TxColumnStore::saveRun(int lookup, const QByteArray& data)
+{
+    const QString path = runPath(lookup, runs_[lookup].size());
+    Run run;
+    QSaveFile file(path);
+    if (file.open(QIODevice::WriteOnly) && file.write(data) == data.size() && file.commit())
+    {
+        run.file.reset(new QFile(path));
+        if (run.file->open(QIODevice::ReadOnly))
+            run.data = run.file->map(0, data.size());
+    }
+    if (!run.data)
+    {
+        qDebug("[TxColumnStore] Cannot save %s, it is kept in memory and made again on open.", qPrintable(path));
+        run.file.reset();
+        run.unsaved = data;
+        run.data = runData(run.unsaved);
+    }
+    runs_[lookup].push_back(std::move(run));
+}
+
+void TxColumnStore::removeRunFiles(int lookup, int level) const
+{
+    for (; QFile::exists(runPath(lookup, level)); ++level)
+        QFile::remove(runPath(lookup, level));
+}
+
+void TxColumnStore::unmapRuns()
+{
+    for (std::vector<Run>& runs : runs_)
+    {
+        for (Run& run : runs)
+            if (run.file)
+                run.file->unmap(const_cast<uchar*>(run.data));
+        runs.clear();
+    }
+}
+
+QByteArray TxColumnStore::buildRun(int lookup, int firstRow) const
+{
+    QVector<RowKey> keys;
+    QByteArray made; // keys which are not in the columns as they are
+    const auto addKey = [&keys](const uchar* data, quint32 size, int row) { keys << RowKey{data, 0, size, row}; };
+    const auto makeKey = [&keys, &made](const QByteArray& key, int row)
+    {
+        keys << RowKey{nullptr, made.size(), quint32(key.size()), row};
+        made.append(key);
+    };
+
+    keys.reserve(count_ - firstRow);
+    for (int row = firstRow; row < count_; ++row)
+    {
+        switch (lookup)
+        {
+        case BY_HASH:
+            addKey(cell(HASH, row), HASH_SIZE, row);
+            break;
+        case BY_BLOCK_HASH:
+            if (row == 0 || std::memcmp(cell(BLOCK_HASH, row), cell(BLOCK_HASH, row - 1), HASH_SIZE) != 0)
+                addKey(cell(BLOCK_HASH, row), HASH_SIZE, row);
+            break;
+        case BY_PAYMENT_ID:
+        {
+            // Lower case as TxIndex has them; mostly they are already
+            const uchar* heap = heapRecord(row);
+            const quint32 size = readValue<quint32>(heap);
+            const uchar* id = heap + 4;
+            if (size == 0)
+                break;
+            if (std::any_of(id, id + size, [](uchar c) { return c >= 0x80 || (c >= 'A' && c <= 'Z'); }))
+                makeKey(QString::fromUtf8(reinterpret_cast<const char*>(id), size).toLower().toUtf8(), row);
+            else
+                addKey(id, size, row);
+            break;
+        }
+        case BY_ADDRESS:
+        {
+            quint32 count = 0;
+            const uchar* heap = transfers(row, count);
+            for (quint32 i = 0; i < count; ++i)
+            {
+                const quint32 size = readValue<quint32>(heap);
+                if (size > 0)
+                    addKey(heap + 4, size, row);
+                heap += 4 + size + 9 + HASH_SIZE;
+            }
+            break;
+        }
+        case BY_AMOUNT:
+        {
+            QByteArray key;
+            appendAmountKey(key, net(row));
+            makeKey(key, row);
+            break;
+        }
+        }
+    }
+    for (RowKey& key : keys)
+        if (!key.data)
+            key.data = runData(made) + key.made;
+
+    std::sort(keys.begin(), keys.end(), [](const RowKey& lhs, const RowKey& rhs)
+    {
+        const int order = compareKeys(lhs.data, lhs.size, rhs.data, rhs.size);
+        return order < 0 || (order == 0 && lhs.row < rhs.row);
+    });
+    RunWriter writer;
+    for (const RowKey& key : keys)
+        writer.add(key.data, key.size, key.row);
+    return writer.finish(lookup, firstRow, count_, cell(HASH, count_ - 1));
+}
+
+// The rows past the last run make a run of their own, merged into the one before for as long as that
+// one has no more than twice its rows. Runs go halving from the oldest, so a row is rewritten about
+// log2(rows) times over the life of the store, not with every append, and a search looks into as many runs.
+void TxColumnStore::addRows(int lookup)
+{
+    std::vector<Run>& runs = runs_[lookup];
+    const int firstRow = runs.empty() ? 0 : runEndRow(runs.back().data);
+    if (firstRow >= count_)
+        return;
+    QByteArray run = buildRun(lookup, firstRow);
+    while (!runs.empty() && 2 * runRows(runData(run)) >= runRows(runs.back().data))
+    {
+        run = mergeRuns(lookup, runs.back().data, runData(run));
+        if (runs.back().file)
+            runs.back().file->unmap(const_cast<uchar*>(runs.back().data));
+        runs.pop_back();
+    }
+    saveRun(lookup, run);
+    removeRunFiles(lookup, runs.size()); // what was merged into the new one
+}
+
+BalanceSeries::Totals TxColumnStore::running(int row) const
+{
+    const uchar* data = cell(RUNNING, row);
+    BalanceSeries::Totals totals;
+    totals.net = readValue<qint64>(data);
+    totals.volume = readValue<quint64>(data + 8);
+    totals.fees = readValue<quint64>(data + 16);
+    totals.count = row + 1;
+    return totals;
+}
+
+BalanceSeries::Totals TxColumnStore::through(RpcApi::Height height) const
+{
+    int first = 0;
+    int count = count_;
+    while (count > 0)
+    {
+        const int step = count / 2;
+        if (!(height < this->height(first + step)))
+        {
+            first += step + 1;
+            count -= step + 1;
+        }
+        else
+            count = step;
+    }
+    return first > 0 ? running(first - 1) : BalanceSeries::Totals();
+}
+
+BalanceSeries::Totals TxColumnStore::total() const
+{
+    return count_ > 0 ? running(count_ - 1) : BalanceSeries::Totals();
+}
+
+BalanceSeries::Totals TxColumnStore::throughDay(const QDate& date) const
+{
+    const qint64 day = date.toJulianDay();
+    const auto it = std::upper_bound(days_.begin(), days_.end(), day, [](qint64 lhs, const Day& rhs) { return lhs < rhs.day; });
+    return it != days_.begin() ? (it - 1)->through : BalanceSeries::Totals();
+}
+
+QVector<BalanceSeries::Bucket> TxColumnStore::days(const QDate& from, const QDate& to) const
+{
+    QVector<BalanceSeries::Bucket> result;
+    const auto first = std::lower_bound(days_.begin(), days_.end(), from.toJulianDay(), [](const Day& lhs, qint64 rhs) { return lhs.day < rhs; });
+    for (auto it = first; it != days_.end() && it->day <= to.toJulianDay(); ++it)
+        result << BalanceSeries::Bucket{QDate::fromJulianDay(it->day), it->totals, it->through};
+    return result;
+}
+
+// Rows with no timestamp count in the running totals only, as in BalanceSeries
+void TxColumnStore::addDay(qint64 seconds, const BalanceSeries::Totals& totals)
+{
+    if (seconds < 0)
+        return;
+    const qint64 day = seconds / SECONDS_PER_DAY + UNIX_EPOCH_JULIAN_DAY;
+    const auto it = std::lower_bound(days_.begin(), days_.end(), day, [](const Day& lhs, qint64 rhs) { return lhs.day < rhs; });
+    if (it != days_.end() && it->day == day)
+        it->totals += totals;
+    else
+        days_.insert(it, Day{day, totals, BalanceSeries::Totals()});
+}
+
+void TxColumnStore::sumDays()
+{
+    BalanceSeries::Totals through;
+    for (Day& day : days_)
+        day.through = through += day.totals;
+}
+
+void TxColumnStore::rebuildDays()
+{
+    days_.clear();
+    for (int row = 0; row < count_; ++row)
+        addDay(timestamp(row), BalanceSeries::totalsOf(net(row), fee(row)));
+    sumDays();
+}
+
+bool TxColumnStore::loadDays()
+{
+    QFile file(QDir(dirName_).absoluteFilePath(QString::fromLatin1(DAYS_FILE)));
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+    QDataStream stream(&file);
+    stream.setVersion(STORE_STREAM_VERSION);
+    quint32 magic = 0;
+    quint16 version = 0;
+    qint32 count = 0;
+    qint32 dayCount = 0;
+    stream >> magic >> version >> count >> dayCount;
+    if (stream.status() != QDataStream::Ok || magic != STORE_MAGIC || version != STORE_VERSION || count != count_ || dayCount < 0)
+        return false;
+
+    QVector<Day> days;
+    days.reserve(dayCount);
+    for (qint32 i = 0; i < dayCount && stream.status() == QDataStream::Ok; ++i)
+    {
+        Day day;
+        stream >> day.day >> day.totals.net >> day.totals.volume >> day.totals.fees >> day.totals.count;
+        days << day;
+    }
+    if (stream.status() != QDataStream::Ok)
+        return false;
+    days_.swap(days);
+    sumDays();
+    return true;
+}
+
+void TxColumnStore::saveDays() const
+{
+    QSaveFile file(QDir(dirName_).absoluteFilePath(QString::fromLatin1(DAYS_FILE)));
+    if (file.open(QIODevice::WriteOnly))
+    {
+        QDataStream stream(&file);
+        stream.setVersion(STORE_STREAM_VERSION);
+        stream << STORE_MAGIC << STORE_VERSION << qint32(count_) << qint32(days_.size());
+        for (const Day& day : days_)
+            stream << day.day << day.totals.net << day.totals.volume << day.totals.fees << day.totals.count;
+        if (stream.status() == QDataStream::Ok && file.commit())
+            return;
+    }
+    qDebug("[TxColumnStore] Cannot save %s, the days will be summed up again on open.", qPrintable(file.fileName()));
+}
+
+}
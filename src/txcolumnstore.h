@@ -0,0 +1,128 @@
+// Copyright (c) 2015-2018, The Bytecoin developers.
+// Licensed under the GNU Lesser General Public License. See LICENSE for details.
+
+#ifndef TXCOLUMNSTORE_H
+#define TXCOLUMNSTORE_H
+
+#include <memory>
+#include <vector>
+
+#include <QDate>
+#include <QFile>
+#include <QString>
+#include <QVector>
+
+#include "balanceseries.h"
+#include "rpcapi.h"
+#include "txindex.h"
+
+namespace WalletGUI
+{
+
+// Confirmed transactions in ascending height, one file per column in a directory, memory-mapped read-only.
+// Fixed-width columns are read in place; payment id, extra and transfers live in a heap and are decoded
+// only when a whole transaction is asked for. Rows are only ever appended or cut off at the end:
+// the new data goes past the committed end first and the row count in "committed" is replaced last,
+// so a crash in the middle leaves the store as it was.
+// Balance totals come with the rows: a column of running totals by row and a small table by day,
+// written next to the columns, so neither the sort keys nor the chart decode a stored transaction.
+// Search goes through sorted lookups, also next to the columns: tx hash, block hash, payment id, address
+// and amount, each mapped to the rows having it.
+class TxColumnStore
+{
+    Q_DISABLE_COPY(TxColumnStore)
+
+public:
+    explicit TxColumnStore(const QString& dirName);
+    ~TxColumnStore();
+
+    bool open(); // maps what was committed, false if there is nothing usable
+    bool append(const QVector<RpcApi::Transaction>& txs);
+    bool truncate(int size);
+    void remove();
+
+    int size() const { return count_; }
+    RpcApi::Height height(int row) const;
+    RpcApi::Hash hash(int row) const;
+    RpcApi::Hash blockHash(int row) const;
+    RpcApi::Amount fee(int row) const;
+    RpcApi::SignedAmount net(int row) const; // our transfers, as the history shows them
+    qint64 timestamp(int row) const; // seconds since epoch, -1 for unknown
+    quint64 unlockBlockOrTimestamp(int row) const;
+    bool hasForeignTransfer(int row) const; // one not ours, a proof can be made
+    RpcApi::Transaction transaction(int row) const;
+
+    // The rows matching as TxIndex::find() and accepts() match, in no order and maybe more than once
+    void find(const TxIndex::Query& query, QVector<int>& rows) const;
+
+    // As BalanceSeries has them, for all the rows
+    BalanceSeries::Totals through(RpcApi::Height height) const;
+    BalanceSeries::Totals total() const;
+    BalanceSeries::Totals throughDay(const QDate& date) const;
+    QVector<BalanceSeries::Bucket> days(const QDate& from, const QDate& to) const; // days with transactions only
+
+private:
+    enum Column
+    {
+        HEIGHT, TIMESTAMP, AMOUNT, NET, FEE, RUNNING, HASH, BLOCK_HASH, DETAILS, HEAP_OFFSET, HEAP,
+        COLUMN_COUNT
+    };
+
+    enum Lookup
+    {
+        BY_HASH, BY_BLOCK_HASH, BY_PAYMENT_ID, BY_ADDRESS, BY_AMOUNT,
+        LOOKUP_COUNT
+    };
+
+    // (key, row) entries of a range of rows sorted by key, a file each, see addRows()
+    struct Run
+    {
+        std::unique_ptr<QFile> file;
+        QByteArray unsaved; // in place of the file when it could not be written, until the next open
+        const uchar* data = nullptr;
+    };
+
+    struct Day
+    {
+        qint64 day; // julian day
+        BalanceSeries::Totals totals;
+        BalanceSeries::Totals through;
+    };
+
+    QString path(int column) const;
+    qint64 committedLength(int column) const;
+    bool writeCommitted(int count, qint64 heapSize) const;
+    bool map();
+    void unmap();
+    const uchar* cell(int column, int row) const;
+    const uchar* heapRecord(int row) const;
+    const uchar* transfers(int row, quint32& count) const;
+    BalanceSeries::Totals running(int row) const; // through the row
+
+    QString runPath(int lookup, int level) const;
+    bool loadRun(int lookup);
+    void saveRun(int lookup, const QByteArray& data);
+    void removeRunFiles(int lookup, int level) const; // the files of the levels from there on
+    void unmapRuns();
+    QByteArray buildRun(int lookup, int firstRow) const; // of the rows from firstRow on
+    void addRows(int lookup);
+    void findKeys(int lookup, const QByteArray& from, const QByteArray& to, bool prefix, QVector<int>& rows) const;
+
+    void addDay(qint64 seconds, const BalanceSeries::Totals& totals);
+    void sumDays();
+    bool loadDays();
+    void saveDays() const;
+    void rebuildDays();
+
+    QString dirName_;
+    int count_;
+    qint64 heapSize_;
+    QFile files_[COLUMN_COUNT];
+    const uchar* data_[COLUMN_COUNT];
+    QVector<Day> days_; // ascending, of the committed rows
+    std::vector<Run> runs_[LOOKUP_COUNT]; // the oldest rows first
+};
+
+}
+
+#endif // TXCOLUMNSTORE_H
@@ -0,0 +1,253 @@
+// Copyright (c) 2015-2018, The Bytecoin developers.
+// Licensed under the GNU Lesser General Public License. See LICENSE for details.
+
+#include "txindex.h"
+
+namespace WalletGUI
+{
+
+namespace
+{
+
+int hexDigit(QChar c)
+{
+    const ushort u = c.unicode();
+    if (u >= '0' && u <= '9')
+        return u - '0';
+    if (u >= 'a' && u <= 'f')
+        return u - 'a' + 10;
+    return -1;
+}
+
+bool isHexPrefix(const QString& text)
+{
+    if (text.size() > 2 * RpcApi::Hash::SIZE)
+        return false;
+    for (const QChar c : text)
+        if (hexDigit(c) < 0)
+            return false;
+    return true;
+}
+
+constexpr int MIN_DEAD_TO_COMPACT = 1024;
+
+}
+
+/*static*/ RpcApi::SignedAmount TxIndex::amountOf(const RpcApi::Transaction& tx)
+{
+    RpcApi::SignedAmount amount = 0;
+    for (const RpcApi::Transfer& tr : tx.transfers)
+        if (tr.ours)
+            amount += tr.amount;
+    return amount;
+}
+
+void TxIndex::add(const RpcApi::Transaction& tx)
+{
+    const RpcApi::SignedAmount amount = amountOf(tx);
+
+    // Known already: payment id and transfers go with the hash, only where it is may have changed
+    const auto it = byHash_.constFind(tx.hash);
+    if (it != byHash_.constEnd())
+    {
+        Entry& entry = entries_[*it];
+        if (entry.alive)
+            detachBlock(entry.blockHash);
+        else
+            --dead_;
+        attachBlock(tx.block_hash, tx.block_height);
+        entry.height = tx.block_height;
+        entry.blockHash = tx.block_hash;
+        entry.alive = true;
+        if (entry.amount != amount)
+        {
+            entry.amount = amount;
+            amounts_.insert(amount, *it);
+        }
+        return;
+    }
+
+    const quint32 id = entries_.size();
+    entries_ << Entry{tx.hash, tx.block_height, tx.block_hash, amount, true};
+    attachBlock(tx.block_hash, tx.block_height);
+    byHash_.insert(tx.hash, id);
+    amounts_.insert(amount, id);
+    if (!tx.payment_id.isEmpty())
+        paymentIds_[tx.payment_id.toLower()] << id;
+    for (const RpcApi::Transfer& tr : tx.transfers)
+    {
+        if (tr.address.isEmpty())
+            continue;
+        QVector<quint32>& ids = addresses_[tr.address];
+        if (ids.isEmpty() || ids.last() != id)
+            ids << id;
+    }
+}
+
+void TxIndex::remove(const RpcApi::Hash& hash)
+{
+    const auto it = byHash_.constFind(hash);
+    if (it == byHash_.constEnd() || !entries_[*it].alive)
+        return;
+    entries_[*it].alive = false;
+    detachBlock(entries_[*it].blockHash);
+    if (++dead_ >= MIN_DEAD_TO_COMPACT && dead_ > entries_.size() / 2)
+        compact();
+}
+
+// Only the live entries are kept, lists and maps are rewritten with their new ids
+void TxIndex::compact()
+{
+    QVector<quint32> ids(entries_.size(), quint32(-1));
+    QVector<Entry> entries;
+    entries.reserve(entries_.size() - dead_);
+    for (int i = 0; i < entries_.size(); ++i)
+        if (entries_[i].alive)
+        {
+            ids[i] = entries.size();
+            entries << entries_[i];
+        }
+
+    const auto renumber = [&ids](QVector<quint32>& list)
+    {
+        QVector<quint32> result;
+        for (const quint32 id : list)
+            if (ids[id] != quint32(-1))
+                result << ids[id];
+        list.swap(result);
+    };
+    for (auto it = paymentIds_.begin(); it != paymentIds_.end();)
+    {
+        renumber(*it);
+        it = it->isEmpty() ? paymentIds_.erase(it) : it + 1;
+    }
+    for (auto it = addresses_.begin(); it != addresses_.end();)
+    {
+        renumber(*it);
+        it = it->isEmpty() ? addresses_.erase(it) : it + 1;
+    }
+
+    entries_.swap(entries);
+    byHash_.clear();
+    amounts_.clear();
+    for (int id = 0; id < entries_.size(); ++id)
+    {
+        byHash_.insert(entries_[id].hash, id);
+        amounts_.insert(entries_[id].amount, id);
+    }
+    dead_ = 0;
+}
+
+void TxIndex::attachBlock(const RpcApi::Hash& blockHash, Height height)
+{
+    if (blockHash.isNull())
+        return;
+    Block& block = blocks_[blockHash];
+    block.height = height;
+    ++block.liveCount;
+}
+
+void TxIndex::detachBlock(const RpcApi::Hash& blockHash)
+{
+    const auto it = blocks_.find(blockHash);
+    if (it != blocks_.end() && --it->liveCount <= 0)
+        blocks_.erase(it);
+}
+
+void TxIndex::clear()
+{
+    entries_.clear();
+    byHash_.clear();
+    blocks_.clear();
+    paymentIds_.clear();
+    addresses_.clear();
+    amounts_.clear();
+    dead_ = 0;
+}
+
+bool TxIndex::acceptsEntry(quint32 id, const Query& query) const
+{
+    const Entry& entry = entries_[id];
+    return entry.alive &&
+        entry.height >= query.minHeight && entry.height <= query.maxHeight &&
+        entry.amount >= query.minAmount && entry.amount <= query.maxAmount;
+}
+
+bool TxIndex::accepts(const RpcApi::Hash& hash, const Query& query) const
+{
+    const auto it = byHash_.constFind(hash);
+    return it != byHash_.constEnd() && acceptsEntry(*it, query);
+}
+
+bool TxIndex::heightOf(const RpcApi::Hash& hash, Height& height) const
+{
+    const auto it = byHash_.constFind(hash);
+    if (it == byHash_.constEnd() || !entries_[*it].alive)
+        return false;
+    height = entries_[*it].height;
+    return true;
+}
+
+// The prefix is turned into the lowest and the highest hash starting with it
+/*static*/ bool TxIndex::hashRange(const QString& prefix, RpcApi::Hash& first, RpcApi::Hash& last)
+{
+    if (!isHexPrefix(prefix))
+        return false;
+    uchar low[RpcApi::Hash::SIZE];
+    uchar high[RpcApi::Hash::SIZE];
+    for (int i = 0; i < RpcApi::Hash::SIZE; ++i)
+    {
+        const int hi = 2 * i < prefix.size() ? hexDigit(prefix[2 * i]) : -1;
+        const int lo = 2 * i + 1 < prefix.size() ? hexDigit(prefix[2 * i + 1]) : -1;
+        low[i] = static_cast<uchar>(((hi < 0 ? 0 : hi) << 4) | (lo < 0 ? 0 : lo));
+        high[i] = static_cast<uchar>(((hi < 0 ? 0xf : hi) << 4) | (lo < 0 ? 0xf : lo));
+    }
+    first = RpcApi::Hash::fromBytes(low);
+    last = RpcApi::Hash::fromBytes(high);
+    return true;
+}
+
+void TxIndex::findHashPrefix(const QString& text, const Query& query, QVector<Key>& keys, QVector<Height>& blockHeights) const
+{
+    RpcApi::Hash first;
+    RpcApi::Hash last;
+    if (!hashRange(text, first, last))
+        return;
+    for (auto it = byHash_.lowerBound(first); it != byHash_.constEnd() && !(last < it.key()); ++it)
+        if (acceptsEntry(*it, query))
+            keys << Key{entries_[*it].height, it.key()};
+    for (auto it = blocks_.lowerBound(first); it != blocks_.constEnd() && !(last < it.key()); ++it)
+        if (it->height >= query.minHeight && it->height <= query.maxHeight)
+            blockHeights << it->height;
+}
+
+bool TxIndex::find(const Query& query, QVector<Key>& keys, QVector<Height>& blockHeights) const
+{
+    const QString text = query.text.trimmed();
+    if (text.isEmpty())
+    {
+        if (!query.hasAmount())
+            return false;
+        for (auto it = amounts_.lowerBound(query.minAmount); it != amounts_.constEnd() && it.key() <= query.maxAmount; ++it)
+            if (acceptsEntry(*it, query))
+                keys << Key{entries_[*it].height, entries_[*it].hash};
+        return true;
+    }
+
+    const QString lower = text.toLower();
+    findHashPrefix(lower, query, keys, blockHeights);
+    for (auto it = paymentIds_.lowerBound(lower); it != paymentIds_.constEnd() && it.key().startsWith(lower); ++it)
+        for (const quint32 id : *it)
+            if (acceptsEntry(id, query))
+                keys << Key{entries_[id].height, entries_[id].hash};
+
+    // Addresses are looked up whole, an address never seen is not in the pool either
+    const RpcApi::Address address = RpcApi::Address::find(text);
+    if (!address.isEmpty())
+        for (const quint32 id : addresses_.value(address))
+            if (acceptsEntry(id, query))
+                keys << Key{entries_[id].height, entries_[id].hash};
+    return true;
+}
+
+}
@@ -0,0 +1,97 @@
+// Copyright (c) 2015-2018, The Bytecoin developers.
+// Licensed under the GNU Lesser General Public License. See LICENSE for details.
+
+#ifndef TXINDEX_H
+#define TXINDEX_H
+
+#include <limits>
+
+#include <QHash>
+#include <QMap>
+#include <QString>
+#include <QVector>
+
+#include "rpcapi.h"
+
+namespace WalletGUI
+{
+
+// Search index over the rows TxList keeps in memory, kept up to date as rows come and go.
+// Transactions are known by an id, their place in entries_. A removed one is only marked dead and
+// the lists pointing to it are not touched: matches are checked against the entry, and a transaction
+// coming back (a reorg, a pool transaction getting into a block) gets its old id again.
+// Once most entries are dead, as after rows moved to the store, they are dropped and the ids renumbered.
+class TxIndex
+{
+public:
+    using Height = RpcApi::Height;
+
+    struct Query
+    {
+        QString text; // tx or block hash prefix, payment id prefix or an address; empty for any
+        RpcApi::SignedAmount minAmount = std::numeric_limits<RpcApi::SignedAmount>::min();
+        RpcApi::SignedAmount maxAmount = std::numeric_limits<RpcApi::SignedAmount>::max();
+        Height minHeight = 0;
+        Height maxHeight = std::numeric_limits<Height>::max();
+
+        bool hasAmount() const
+        {
+            return minAmount != std::numeric_limits<RpcApi::SignedAmount>::min() ||
+                maxAmount != std::numeric_limits<RpcApi::SignedAmount>::max();
+        }
+    };
+
+    // A matching transaction, TxList finds its row by height and hash
+    struct Key
+    {
+        Height height;
+        RpcApi::Hash hash;
+    };
+
+    static RpcApi::SignedAmount amountOf(const RpcApi::Transaction& tx); // as the history shows it, our transfers only
+    static bool hashRange(const QString& prefix, RpcApi::Hash& first, RpcApi::Hash& last); // false unless lower case hex
+
+    void add(const RpcApi::Transaction& tx);
+    void remove(const RpcApi::Hash& hash);
+    void clear();
+
+    // False if the query has neither text nor amount, the height range alone is for TxList to resolve.
+    // Block hash matches come as heights: every row at them belongs to the block, accepts() checks the rest.
+    bool find(const Query& query, QVector<Key>& keys, QVector<Height>& blockHeights) const;
+    bool accepts(const RpcApi::Hash& hash, const Query& query) const;
+    bool heightOf(const RpcApi::Hash& hash, Height& height) const; // false for one not in the history
+
+private:
+    struct Entry
+    {
+        RpcApi::Hash hash;
+        Height height;
+        RpcApi::Hash blockHash; // null in the pool
+        RpcApi::SignedAmount amount;
+        bool alive;
+    };
+
+    struct Block
+    {
+        Height height;
+        int liveCount; // the block is dropped with its last live transaction
+    };
+
+    bool acceptsEntry(quint32 id, const Query& query) const;
+    void compact();
+    void attachBlock(const RpcApi::Hash& blockHash, Height height);
+    void detachBlock(const RpcApi::Hash& blockHash);
+    void findHashPrefix(const QString& text, const Query& query, QVector<Key>& keys, QVector<Height>& blockHeights) const;
+
+    QVector<Entry> entries_;
+    QMap<RpcApi::Hash, quint32> byHash_; // dead ones too, ordered for prefix search
+    QMap<RpcApi::Hash, Block> blocks_; // blocks with our live transactions
+    QMap<QString, QVector<quint32>> paymentIds_; // lower case
+    QHash<RpcApi::Address, QVector<quint32>> addresses_;
+    QMultiMap<RpcApi::SignedAmount, quint32> amounts_;
+    int dead_ = 0;
+};
+
+}
+
+#endif // TXINDEX_H
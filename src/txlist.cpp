@@ -0,0 +1,594 @@
+// Copyright (c) 2015-2018, The Bytecoin developers.
+// Licensed under the GNU Lesser General Public License. See LICENSE for details.
+
+#include <algorithm>
+#include <iterator>
+
+#include <QHash>
+
+#include "txlist.h"
+
+namespace WalletGUI
+{
+
+namespace
+{
+
+// Rendered rows kept around the one asked for last. Scrolling, a CSV export or a view with paging
+// off walk the whole history, once this many rows got rendered the ones far from it are dropped.
+constexpr int CACHE_TRIM_ROWS = 2048;
+constexpr int CACHE_KEEP_ROWS = CACHE_TRIM_ROWS / 2; // either way, so at most 2 * CACHE_TRIM_ROWS are cached
+
+}
+
+/*static*/ TxList::Row TxList::makeRow(const Transaction& tx)
+{
+    Row row;
+    row.height = tx.block_height;
+    row.hash = tx.hash;
+    row.amount = TxIndex::amountOf(tx);
+    row.fee = tx.fee;
+    row.time = tx.timestamp.isValid() ? tx.timestamp.toMSecsSinceEpoch() / 1000 : -1;
+    row.blockHash = tx.block_hash;
+    row.unlock = tx.unlock_block_or_timestamp;
+    row.proof = std::any_of(tx.transfers.begin(), tx.transfers.end(), [](const RpcApi::Transfer& tr) { return !tr.ours; });
+    row.tx.reset(new Transaction(tx));
+    return row;
+}
+
+const TxList::Transaction& TxList::at(int index) const
+{
+    const int stored = storedCount();
+    if (index >= stored && rows_[index - stored].tx)
+        return *rows_[index - stored].tx;
+    if (decodedIndex_ != index)
+    {
+        if (index < stored)
+            decoded_ = store_->transaction(index);
+        else
+        {
+            decoded_ = Transaction();
+            decoded_.block_height = rows_[index - stored].height;
+            decoded_.hash = rows_[index - stored].hash;
+        }
+        decodedIndex_ = index;
+    }
+    return decoded_;
+}
+
+TxList::Height TxList::heightAt(int index) const
+{
+    const int stored = storedCount();
+    return index < stored ? store_->height(index) : rows_[index - stored].height;
+}
+
+RpcApi::Hash TxList::hashAt(int index) const
+{
+    const int stored = storedCount();
+    return index < stored ? store_->hash(index) : rows_[index - stored].hash;
+}
+
+RpcApi::SignedAmount TxList::amountAt(int index) const
+{
+    const int stored = storedCount();
+    return index < stored ? store_->net(index) : rows_[index - stored].amount;
+}
+
+RpcApi::Amount TxList::feeAt(int index) const
+{
+    const int stored = storedCount();
+    return index < stored ? store_->fee(index) : rows_[index - stored].fee;
+}
+
+qint64 TxList::timeAt(int index) const
+{
+    const int stored = storedCount();
+    return index < stored ? store_->timestamp(index) : rows_[index - stored].time;
+}
+
+RpcApi::Hash TxList::blockHashAt(int index) const
+{
+    const int stored = storedCount();
+    return index < stored ? store_->blockHash(index) : rows_[index - stored].blockHash;
+}
+
+quint64 TxList::unlockAt(int index) const
+{
+    const int stored = storedCount();
+    return index < stored ? store_->unlockBlockOrTimestamp(index) : rows_[index - stored].unlock;
+}
+
+bool TxList::proofAt(int index) const
+{
+    const int stored = storedCount();
+    return index < stored ? store_->hasForeignTransfer(index) : rows_[index - stored].proof;
+}
+
+bool TxList::isResident(int index) const
+{
+    const int stored = storedCount();
+    return index < stored || rows_[index - stored].tx;
+}
+
+bool TxList::equals(int index, const Transaction& tx) const
+{
+    // Stored and paged out rows are decoded only when their hash already matches
+    const int stored = storedCount();
+    if (index >= stored && rows_[index - stored].tx)
+        return *rows_[index - stored].tx == tx;
+    return hashAt(index) == tx.hash && at(index) == tx;
+}
+
+int TxList::lowerBound(Height height) const
+{
+    int first = 0;
+    int count = size();
+    while (count > 0)
+    {
+        const int step = count / 2;
+        if (heightAt(first + step) < height)
+        {
+            first += step + 1;
+            count -= step + 1;
+        }
+        else
+            count = step;
+    }
+    return first;
+}
+
+int TxList::upperBound(Height height) const
+{
+    int first = 0;
+    int count = size();
+    while (count > 0)
+    {
+        const int step = count / 2;
+        if (!(height < heightAt(first + step)))
+        {
+            first += step + 1;
+            count -= step + 1;
+        }
+        else
+            count = step;
+    }
+    return first;
+}
+
+// Replacing [first, last) with batch. Unconfirmed heights are requested again with every block
+// and mostly come back unchanged, the equal head and tail are left out of the splice.
+TxList::Splice TxList::trimmed(int first, int last, List batch) const
+{
+    int head = 0;
+    while (first + head < last && head < batch.size() && equals(first + head, batch[head]))
+        ++head;
+    int tail = 0;
+    while (last - tail > first + head && batch.size() - tail > head && equals(last - tail - 1, batch[batch.size() - tail - 1]))
+        ++tail;
+
+    Splice splice;
+    splice.first = first + head;
+    splice.removed = last - tail - splice.first;
+    splice.inserted = batch.mid(head, batch.size() - head - tail);
+    return splice;
+}
+
+TxList::Splice TxList::replaceRange(Height from_height, Height to_height, List batch) const
+{
+    std::stable_sort(batch.begin(), batch.end(), [](const Transaction& lhs, const Transaction& rhs) { return lhs.block_height < rhs.block_height; });
+    int first = upperBound(from_height);
+    int last = to_height > 0 ? lowerBound(to_height) : first;
+    if (!batch.isEmpty()) // a batch outside of its range still must not break the order
+    {
+        first = qMin(first, lowerBound(batch.first().block_height));
+        last = qMax(last, upperBound(batch.last().block_height));
+    }
+    return trimmed(first, qMax(first, last), std::move(batch));
+}
+
+TxList::Splice TxList::replaceHeights(List batch) const
+{
+    if (batch.isEmpty())
+        return Splice();
+    std::stable_sort(batch.begin(), batch.end(), [](const Transaction& lhs, const Transaction& rhs) { return lhs.block_height < rhs.block_height; });
+    const Height lowest = batch.first().block_height;
+    const Height highest = batch.last().block_height;
+
+    QSet<Height> replaced;
+    for (const Transaction& tx : batch)
+        replaced.insert(tx.block_height);
+
+    // Heights between the ones in batch are kept, a block brings one height anyway
+    const int first = lowerBound(lowest);
+    const int last = upperBound(highest);
+    List merged;
+    merged.reserve(last - first + batch.size());
+    int b = 0;
+    for (int i = first; i < last; ++i)
+    {
+        const Height height = heightAt(i);
+        for (; b < batch.size() && batch[b].block_height < height; ++b)
+            merged << batch[b];
+        if (!replaced.contains(height))
+            merged << at(i);
+    }
+    for (; b < batch.size(); ++b)
+        merged << batch[b];
+    return trimmed(first, last, std::move(merged));
+}
+
+TxList::Splice TxList::retain(Height from_height, Height to_height, const QSet<Height>& heights) const
+{
+    const int first = upperBound(from_height);
+    const int last = lowerBound(to_height);
+    int firstDropped = last;
+    int lastDropped = first;
+    for (int i = first; i < last; ++i)
+        if (!heights.contains(heightAt(i)))
+        {
+            firstDropped = qMin(firstDropped, i);
+            lastDropped = i + 1;
+        }
+    if (firstDropped >= lastDropped)
+        return Splice();
+
+    Splice splice;
+    splice.first = firstDropped;
+    splice.removed = lastDropped - firstDropped;
+    for (int i = firstDropped; i < lastDropped; ++i)
+        if (heights.contains(heightAt(i)))
+            splice.inserted << at(i);
+    return splice;
+}
+
+// Pool transactions have no block, they come and go without the chain switching. A transaction mined
+// again in another block is looked up by hash too: the row it had may be outside the splice.
+TxList::Height TxList::forkHeight(const Splice& splice) const
+{
+    Height fork = 0;
+    const auto found = [&fork](Height height) { if (fork == 0 || height < fork) fork = height; };
+
+    QHash<Height, RpcApi::Hash> blocks;
+    for (const Transaction& tx : splice.inserted)
+        if (!tx.block_hash.isNull())
+            blocks.insert(tx.block_height, tx.block_hash);
+    for (int i = splice.first; i < splice.first + splice.removed; ++i)
+    {
+        if (!isResident(i))
+            continue;
+        const Transaction& tx = at(i);
+        if (!tx.block_hash.isNull() && blocks.value(tx.block_height) != tx.block_hash)
+            found(tx.block_height);
+    }
+
+    for (const Transaction& tx : splice.inserted)
+    {
+        Height height = 0;
+        if (!index_.heightOf(tx.hash, height))
+            continue;
+        const int i = indexOf(height, tx.hash);
+        if (i < 0 || (i >= splice.first && i < splice.first + splice.removed) || !isResident(i))
+            continue;
+        const RpcApi::Hash blockHash = at(i).block_hash;
+        if (!blockHash.isNull() && blockHash != tx.block_hash)
+            found(height);
+    }
+    return fork;
+}
+
+// Rows are matched by hash, so a transaction which changed in place (its block hash, its timestamp)
+// is reported as changed rather than removed and inserted again. One which moved to another height
+// is removed where it was and inserted where it is now.
+QVector<TxList::Edit> TxList::edits(const Splice& splice) const
+{
+    QSet<RpcApi::Hash> oldHashes;
+    QSet<RpcApi::Hash> newHashes;
+    for (int i = 0; i < splice.removed; ++i)
+        oldHashes.insert(hashAt(splice.first + i));
+    for (const Transaction& tx : splice.inserted)
+        newHashes.insert(tx.hash);
+
+    QVector<Edit> result;
+    const auto push = [&result](Edit::Kind kind)
+    {
+        if (!result.isEmpty() && result.last().kind == kind)
+            ++result.last().count;
+        else
+            result << Edit{kind, 1};
+    };
+
+    int i = 0;
+    int j = 0;
+    while (i < splice.removed || j < splice.inserted.size())
+    {
+        const bool hasOld = i < splice.removed;
+        const RpcApi::Hash oldHash = hasOld ? hashAt(splice.first + i) : RpcApi::Hash();
+        const Transaction* newTx = j < splice.inserted.size() ? &splice.inserted[j] : nullptr;
+        if (hasOld && newTx && oldHash == newTx->hash)
+        {
+            push(equals(splice.first + i, *newTx) ? Edit::KEPT : Edit::CHANGED);
+            ++i;
+            ++j;
+        }
+        else if (hasOld && (!newTx || !newHashes.contains(oldHash)))
+        {
+            push(Edit::REMOVED);
+            ++i;
+        }
+        else if (newTx && (!hasOld || !oldHashes.contains(newTx->hash)))
+        {
+            push(Edit::INSERTED);
+            ++j;
+        }
+        else
+        {
+            // Both are further on the other side, the old one goes and its new place becomes an insert
+            oldHashes.remove(oldHash);
+            push(Edit::REMOVED);
+            ++i;
+        }
+    }
+    return result;
+}
+
+void TxList::apply(const Splice& splice)
+{
+    const int common = qMin(splice.removed, splice.inserted.size());
+    replace(splice.first, splice.inserted, 0, common);
+    if (splice.removed > common)
+        remove(splice.first + common, splice.removed - common);
+    else
+        insert(splice.first + common, splice.inserted, common, splice.inserted.size() - common);
+}
+
+void TxList::replace(int index, const List& txs, int from, int count)
+{
+    if (count <= 0)
+        return;
+    unstore(index);
+    const int stored = storedCount();
+    for (int i = 0; i < count; ++i)
+    {
+        Row& row = rows_[index - stored + i];
+        untrack(row.hash);
+        track(txs[from + i]);
+        if (!row.tx)
+            --pagedOut_;
+        row = makeRow(txs[from + i]);
+        cache_[index + i].reset();
+    }
+    decodedIndex_ = -1;
+}
+
+void TxList::insert(int index, const List& txs, int from, int count)
+{
+    if (count <= 0)
+        return;
+    unstore(index);
+    std::vector<Row> rows;
+    rows.reserve(count);
+    for (int i = from; i < from + count; ++i)
+    {
+        rows.push_back(makeRow(txs[i]));
+        track(txs[i]);
+    }
+    rows_.insert(rows_.begin() + (index - storedCount()), std::make_move_iterator(rows.begin()), std::make_move_iterator(rows.end()));
+    cache_.insert(cache_.begin() + index, count, nullptr);
+    decodedIndex_ = -1;
+}
+
+void TxList::remove(int index, int count)
+{
+    if (count <= 0)
+        return;
+    const int stored = storedCount();
+    const bool cut = index < stored && index + count >= stored; // everything stored from index on goes
+    if (!cut)
+        unstore(index);
+    for (int i = qMax(index, storedCount()); i < index + count; ++i)
+        untrack(hashAt(i));
+    if (cut)
+    {
+        store_->truncate(index);
+        eraseRows(0, index + count - stored);
+    }
+    else
+        eraseRows(index - storedCount(), count);
+    cache_.erase(cache_.begin() + index, cache_.begin() + index + count);
+    decodedIndex_ = -1;
+}
+
+void TxList::eraseRows(int first, int count)
+{
+    const auto begin = rows_.begin() + first;
+    pagedOut_ -= std::count_if(begin, begin + count, [](const Row& row) { return !row.tx; });
+    rows_.erase(begin, begin + count);
+}
+
+// Rows from index on are changed, those of them still in the store are taken back into memory.
+// Happens only on a reorg deeper than the confirmation threshold or with the history being dropped.
+void TxList::unstore(int index)
+{
+    const int stored = storedCount();
+    if (index >= stored)
+        return;
+    std::vector<Row> rows;
+    rows.reserve(stored - index);
+    for (int i = index; i < stored; ++i)
+    {
+        const Transaction tx = store_->transaction(i);
+        rows.push_back(makeRow(tx));
+        track(tx);
+    }
+    store_->truncate(index);
+    decodedIndex_ = -1;
+    rows_.insert(rows_.begin(), std::make_move_iterator(rows.begin()), std::make_move_iterator(rows.end()));
+}
+
+void TxList::setStore(std::unique_ptr<TxColumnStore> store)
+{
+    Q_ASSERT(!store || store->size() == 0 || rows_.empty());
+    store_ = std::move(store);
+    decodedIndex_ = -1;
+    cache_.resize(size());
+    series_.setStored(store_.get());
+}
+
+void TxList::track(const Transaction& tx)
+{
+    index_.add(tx);
+    series_.add(tx);
+}
+
+void TxList::untrack(const RpcApi::Hash& hash)
+{
+    index_.remove(hash);
+    series_.remove(hash);
+}
+
+const BalanceSeries& TxList::series() const
+{
+    return series_;
+}
+
+int TxList::indexOf(Height height, const RpcApi::Hash& hash) const
+{
+    for (int i = lowerBound(height), end = upperBound(height); i < end; ++i)
+        if (hashAt(i) == hash)
+            return i;
+    return -1;
+}
+
+QVector<int> TxList::search(const TxIndex::Query& query) const
+{
+    QVector<int> result;
+    QVector<TxIndex::Key> keys;
+    QVector<Height> blockHeights;
+    if (!index_.find(query, keys, blockHeights))
+    {
+        // Nothing but heights: the list is ordered by them
+        for (int i = lowerBound(query.minHeight), end = upperBound(query.maxHeight); i < end; ++i)
+            result << i;
+        return result;
+    }
+    if (storedCount() > 0)
+        store_->find(query, result);
+
+    for (const TxIndex::Key& key : keys)
+    {
+        const int index = indexOf(key.height, key.hash);
+        if (index >= 0)
+            result << index;
+    }
+    // Another block can share the height after a reorg, only rows still in a matching block count
+    RpcApi::Hash first;
+    RpcApi::Hash last;
+    if (!blockHeights.isEmpty() && TxIndex::hashRange(query.text.trimmed().toLower(), first, last))
+        for (const Height height : blockHeights)
+            for (int i = lowerBound(height), end = upperBound(height); i < end; ++i)
+            {
+                const RpcApi::Hash blockHash = blockHashAt(i);
+                if (!(blockHash < first) && !(last < blockHash) && index_.accepts(hashAt(i), query))
+                    result << i;
+            }
+
+    // A transaction can match in more than one way
+    std::sort(result.begin(), result.end());
+    result.erase(std::unique(result.begin(), result.end()), result.end());
+    return result;
+}
+
+int TxList::storeRows(Height confirmedHeight)
+{
+    if (!store_)
+        return 0;
+    // The store takes rows in order, so it stops at the first paged out one
+    List confirmed;
+    for (const Row& row : rows_)
+    {
+        if (!row.tx || row.height > confirmedHeight || row.tx->block_hash.isNull())
+            break;
+        confirmed << *row.tx;
+    }
+    if (confirmed.isEmpty() || !store_->append(confirmed))
+        return 0;
+    for (const Transaction& tx : confirmed)
+        untrack(tx.hash);
+    rows_.erase(rows_.begin(), rows_.begin() + confirmed.size());
+    decodedIndex_ = -1;
+    return confirmed.size();
+}
+
+// Only confirmed rows go: those above confirmedHeight may still change and are matched by their data
+int TxList::pageOut(int first, int last, Height confirmedHeight)
+{
+    const int stored = storedCount();
+    int count = 0;
+    for (int i = qMax(first, stored); i < last; ++i)
+    {
+        Row& row = rows_[i - stored];
+        if (!row.tx || row.height > confirmedHeight)
+            continue;
+        row.tx.reset();
+        cache_[i].reset();
+        ++count;
+    }
+    pagedOut_ += count;
+    if (count > 0)
+        decodedIndex_ = -1;
+    return count;
+}
+
+QPair<int, int> TxList::restore(const List& txs)
+{
+    int first = size();
+    int last = 0;
+    if (pagedOut_ == 0)
+        return qMakePair(first, last);
+    const int stored = storedCount();
+    for (const Transaction& tx : txs)
+        for (int i = qMax(lowerBound(tx.block_height), stored), end = upperBound(tx.block_height); i < end; ++i)
+        {
+            Row& row = rows_[i - stored];
+            if (row.tx || row.hash != tx.hash)
+                continue;
+            row = makeRow(tx);
+            cache_[i].reset();
+            --pagedOut_;
+            first = qMin(first, i);
+            last = qMax(last, i + 1);
+        }
+    if (first < last)
+        decodedIndex_ = -1;
+    return qMakePair(first, last);
+}
+
+TxList::CachedRow& TxList::cachedRow(int index, int cellCount) const
+{
+    if (!cache_[index] && ++cachedSinceTrim_ >= CACHE_TRIM_ROWS)
+        trimCache(index);
+    std::unique_ptr<CachedRow>& row = cache_[index];
+    if (!row)
+        row.reset(new CachedRow(cellCount));
+    return *row;
+}
+
+void TxList::trimCache(int index) const
+{
+    const int keepFirst = qMax(0, index - CACHE_KEEP_ROWS);
+    const int keepLast = qMin(int(cache_.size()), index + CACHE_KEEP_ROWS);
+    for (int i = 0; i < keepFirst; ++i)
+        cache_[i].reset();
+    for (int i = keepLast; i < int(cache_.size()); ++i)
+        cache_[i].reset();
+    cachedSinceTrim_ = 0;
+}
+
+void TxList::clearCache()
+{
+    for (std::unique_ptr<CachedRow>& row : cache_)
+        row.reset();
+    cachedSinceTrim_ = 0;
+}
+
+}
@@ -0,0 +1,153 @@
+// Copyright (c) 2015-2018, The Bytecoin developers.
+// Licensed under the GNU Lesser General Public License. See LICENSE for details.
+
+#ifndef TXLIST_H
+#define TXLIST_H
+
+#include <memory>
+#include <vector>
+
+#include <QPair>
+#include <QSet>
+#include <QVariant>
+#include <QVector>
+
+#include "balanceseries.h"
+#include "rpcapi.h"
+#include "txcolumnstore.h"
+#include "txindex.h"
+
+namespace WalletGUI
+{
+
+// History in ascending block height. Updates replace a height range in place and are described
+// by a Splice first, so the model can announce exactly the rows that change.
+// The oldest rows may live in a TxColumnStore on disk and the rest in memory, indexes run over both.
+// Confirmed rows in memory can be paged out: they keep height and hash, the rest is given back by restore().
+class TxList
+{
+public:
+    using Height = RpcApi::Height;
+    using Transaction = RpcApi::Transaction;
+    using List = QVector<Transaction>;
+
+    // Replaces [first, first + removed) with inserted
+    struct Splice
+    {
+        int first = 0;
+        int removed = 0;
+        List inserted;
+
+        bool isEmpty() const { return removed == 0 && inserted.isEmpty(); }
+    };
+
+    // One run of a splice matched by transaction hash, in ascending index order
+    struct Edit
+    {
+        enum Kind { KEPT, CHANGED, INSERTED, REMOVED };
+
+        Kind kind;
+        int count;
+    };
+
+    // Cells of one row as rendered for a view. Kept next to the transaction and dropped when it is replaced,
+    // so only the rows a splice touches lose theirs.
+    struct CachedRow
+    {
+        explicit CachedRow(int cellCount) : cells(cellCount) {}
+
+        QVector<QVariant> cells;
+        quint32 filled = 0; // a bit per cell
+        // For a cell following the top block rather than the transaction: what it was filled for
+        Height topHeight = 0;
+        uint medianTime = 0;
+    };
+
+    TxList() {}
+    Splice replaceRange(Height from_height, Height to_height, List batch) const; // (from_height, to_height) becomes batch
+    Splice replaceHeights(List batch) const; // the heights present in batch become batch, the rest is kept
+    Splice retain(Height from_height, Height to_height, const QSet<Height>& heights) const; // drops (from_height, to_height) except heights
+    QVector<Edit> edits(const Splice& splice) const;
+    Height forkHeight(const Splice& splice) const; // lowest height whose block the splice replaces or drops, 0 if none
+    void apply(const Splice& splice);
+
+    // Single steps of a splice, for applying it run by run
+    void replace(int index, const List& txs, int from, int count);
+    void insert(int index, const List& txs, int from, int count);
+    void remove(int index, int count);
+
+    CachedRow& cachedRow(int index, int cellCount) const; // made on first use, rows far from index may go then
+    void clearCache();
+
+    // Rows below storedCount() are read from the store. A splice reaching into them takes them back into memory.
+    void setStore(std::unique_ptr<TxColumnStore> store);
+    int storeRows(Height confirmedHeight); // moves the confirmed rows from memory to the store, returns how many
+    int storedCount() const { return store_ ? store_->size() : 0; }
+
+    // Paged out rows read as a placeholder with only hash and height set
+    int pageOut(int first, int last, Height confirmedHeight); // [first, last), returns how many went
+    QPair<int, int> restore(const List& txs); // [first, last) of the rows given their data back, empty if none
+    bool isResident(int index) const;
+    int residentCount() const { return int(rows_.size()) - pagedOut_; } // in memory with data
+    int pagedOutCount() const { return pagedOut_; }
+
+    // Indexes of the matching rows, ascending. Only rows in memory are in the index and the series,
+    // a search reads the stored ones in place and the series adds the totals the store keeps.
+    QVector<int> search(const TxIndex::Query& query) const;
+    const BalanceSeries& series() const;
+    int indexOf(Height height, const RpcApi::Hash& hash) const; // -1 if not there
+
+    // The reference stays good until the next call for a stored or paged out row
+    const Transaction& at(int index) const;
+    Height heightAt(int index) const;
+    RpcApi::Hash hashAt(int index) const;
+
+    // Sort keys, kept by paged out rows too; stored rows read them in place
+    RpcApi::SignedAmount amountAt(int index) const;
+    RpcApi::Amount feeAt(int index) const;
+    qint64 timeAt(int index) const; // seconds since epoch, -1 for unknown
+    RpcApi::Hash blockHashAt(int index) const;
+    quint64 unlockAt(int index) const; // unlock_block_or_timestamp
+    bool proofAt(int index) const; // has a transfer not ours, a proof can be made
+    int size() const { return storedCount() + int(rows_.size()); }
+    static Height confirmationThreshold(Height height) { return height > CONFIRMATIONS + 2 ? height - CONFIRMATIONS - 2 : 0; }
+
+private:
+    struct Row
+    {
+        Height height;
+        RpcApi::Hash hash;
+        RpcApi::SignedAmount amount;
+        RpcApi::Amount fee;
+        qint64 time;
+        RpcApi::Hash blockHash;
+        quint64 unlock;
+        bool proof;
+        std::unique_ptr<Transaction> tx; // null when paged out
+    };
+
+    static Row makeRow(const Transaction& tx);
+    int lowerBound(Height height) const;
+    int upperBound(Height height) const;
+    Splice trimmed(int first, int last, List batch) const;
+    bool equals(int index, const Transaction& tx) const;
+    void unstore(int index);
+    void eraseRows(int first, int count);
+    void track(const Transaction& tx);
+    void untrack(const RpcApi::Hash& hash);
+    void trimCache(int index) const;
+
+    std::unique_ptr<TxColumnStore> store_;
+    std::vector<Row> rows_; // from storedCount() on
+    int pagedOut_ = 0;
+    mutable std::vector<std::unique_ptr<CachedRow>> cache_; // a row each, stored or not
+    mutable int cachedSinceTrim_ = 0;
+    mutable int decodedIndex_ = -1;
+    mutable Transaction decoded_; // the last stored or paged out row asked for
+    TxIndex index_; // of rows_
+    BalanceSeries series_; // of rows_, over the store's totals
+};
+
+}
+
+#endif // TXLIST_H
@@ -0,0 +1,156 @@
+// Copyright (c) 2015-2018, The Bytecoin developers.
+// Licensed under the GNU Lesser General Public License. See LICENSE for details.
+
+#include <algorithm>
+#include <iterator>
+
+#include "updatescheduler.h"
+
+namespace WalletGUI
+{
+
+namespace
+{
+
+constexpr int MAX_SPANS = 32; // of the same columns, past it they are all folded into one
+
+// Both ascending, empty meaning all roles
+QVector<int> unite(const QVector<int>& lhs, const QVector<int>& rhs)
+{
+    if (lhs.isEmpty() || rhs.isEmpty())
+        return QVector<int>();
+    QVector<int> result;
+    result.reserve(lhs.size() + rhs.size());
+    std::set_union(lhs.begin(), lhs.end(), rhs.begin(), rhs.end(), std::back_inserter(result));
+    return result;
+}
+
+}
+
+void UpdateScheduler::add(int firstRow, int lastRow, int firstColumn, int lastColumn, const QVector<int>& roles)
+{
+    if (firstRow > lastRow || firstColumn > lastColumn)
+        return;
+    QVector<int> sortedRoles = roles;
+    std::sort(sortedRoles.begin(), sortedRoles.end());
+    sortedRoles.erase(std::unique(sortedRoles.begin(), sortedRoles.end()), sortedRoles.end());
+
+    // Pending spans of the same columns never overlap or touch, the new one takes in those it does
+    Region added{firstRow, lastRow, firstColumn, lastColumn, sortedRoles};
+    const auto fold = [this, &added](const Region& region)
+    {
+        added.firstRow = qMin(added.firstRow, region.firstRow);
+        added.lastRow = qMax(added.lastRow, region.lastRow);
+        added.roles = unite(added.roles, region.roles);
+        ++merged_;
+    };
+    int spans = 0;
+    for (auto it = regions_.begin(); it != regions_.end();)
+    {
+        if (it->firstColumn != firstColumn || it->lastColumn != lastColumn)
+            ++it;
+        else if (it->firstRow <= added.lastRow + 1 && added.firstRow <= it->lastRow + 1)
+        {
+            fold(*it);
+            it = regions_.erase(it);
+        }
+        else
+        {
+            ++spans;
+            ++it;
+        }
+    }
+
+    // Too scattered to be worth telling apart, a bounding span repaints less than many small ones cost
+    if (spans >= MAX_SPANS)
+        for (auto it = regions_.begin(); it != regions_.end();)
+        {
+            if (it->firstColumn == firstColumn && it->lastColumn == lastColumn)
+            {
+                fold(*it);
+                it = regions_.erase(it);
+            }
+            else
+                ++it;
+        }
+    regions_ << added;
+}
+
+void UpdateScheduler::addStatus()
+{
+    if (status_)
+        ++merged_;
+    status_ = true;
+}
+
+// A span the insertion falls into grows with it
+void UpdateScheduler::rowsInserted(int first, int count, int firstColumn, int lastColumn)
+{
+    for (Region& region : regions_)
+    {
+        if (region.lastColumn < firstColumn || region.firstColumn > lastColumn)
+            continue;
+        if (region.firstRow >= first)
+            region.firstRow += count;
+        if (region.lastRow >= first)
+            region.lastRow += count;
+    }
+}
+
+void UpdateScheduler::rowsRemoved(int first, int count, int firstColumn, int lastColumn)
+{
+    const int last = first + count - 1;
+    for (auto it = regions_.begin(); it != regions_.end();)
+    {
+        Region& region = *it;
+        if (region.lastColumn < firstColumn || region.firstColumn > lastColumn)
+        {
+            ++it;
+            continue;
+        }
+        if (region.firstRow > last)
+            region.firstRow -= count;
+        else if (region.firstRow > first)
+            region.firstRow = first;
+        if (region.lastRow > last)
+            region.lastRow -= count;
+        else if (region.lastRow >= first)
+            region.lastRow = first - 1;
+
+        if (region.firstRow > region.lastRow)
+        {
+            it = regions_.erase(it);
+            ++dropped_;
+        }
+        else
+            ++it;
+    }
+}
+
+void UpdateScheduler::clear()
+{
+    dropped_ += regions_.size();
+    regions_.clear();
+    status_ = false;
+}
+
+QVector<UpdateScheduler::Region> UpdateScheduler::take(int rowCount, bool& status)
+{
+    QVector<Region> result;
+    result.reserve(regions_.size());
+    for (Region& region : regions_)
+    {
+        region.lastRow = qMin(region.lastRow, rowCount - 1);
+        if (region.firstRow > region.lastRow)
+            ++dropped_;
+        else
+            result << region;
+    }
+    status = status_;
+    regions_.clear();
+    status_ = false;
+    ++flushes_;
+    return result;
+}
+
+}
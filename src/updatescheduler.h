@@ -0,0 +1,51 @@
+// Copyright (c) 2015-2018, The Bytecoin developers.
+// Licensed under the GNU Lesser General Public License. See LICENSE for details.
+
+#ifndef UPDATESCHEDULER_H
+#define UPDATESCHEDULER_H
+
+#include <QVector>
+
+namespace WalletGUI
+{
+
+// Model changes gathered between two flushes. Changes to the same columns whose rows overlap or touch
+// are merged into one span with the union of their roles, disjoint ones are kept apart unless there
+// are too many of them. Rows inserted or removed meanwhile move the pending spans over the columns
+// they belong to, and spans left with no rows are dropped. WalletModel hands out what is pending once a frame.
+class UpdateScheduler
+{
+public:
+    struct Region
+    {
+        int firstRow;
+        int lastRow;
+        int firstColumn;
+        int lastColumn;
+        QVector<int> roles; // ascending, empty for all of them
+    };
+
+    void add(int firstRow, int lastRow, int firstColumn, int lastColumn, const QVector<int>& roles);
+    void addStatus(); // statusUpdatedSignal is due
+    // Rows of the columns firstColumn..lastColumn only, spans of other columns stay
+    void rowsInserted(int first, int count, int firstColumn, int lastColumn);
+    void rowsRemoved(int first, int count, int firstColumn, int lastColumn);
+    void clear(); // a reset repaints everything anyway
+    bool isEmpty() const { return regions_.isEmpty() && !status_; }
+    QVector<Region> take(int rowCount, bool& status); // pending spans within rowCount, and empties the scheduler
+
+    quint64 merged() const { return merged_; } // changes folded into one pending already
+    quint64 dropped() const { return dropped_; } // pending spans never handed out
+    quint64 flushes() const { return flushes_; }
+
+private:
+    QVector<Region> regions_;
+    bool status_ = false;
+    quint64 merged_ = 0;
+    quint64 dropped_ = 0;
+    quint64 flushes_ = 0;
+};
+
+}
+
+#endif // UPDATESCHEDULER_H
@@ -10,6 +10,7 @@
 #include <QFileDialog>
 
 #include <random>
+#include <limits>
 #include "walletd.h"
 #include "JsonRpc/JsonRpcClient.h"
 #include "settings.h"
@@ -118,6 +119,9 @@ constexpr int RERUN_TIMER_MSEC = 3000;
 constexpr int STATUS_TIMER_MSEC = 15000;
 constexpr int STATUS_DELAY_TIMER_MSEC = 500;
 constexpr int WAITING_TIMEOUT_MSEC = 10000;
+constexpr int REQUEST_TIMEOUT_MSEC = 30000;
+constexpr int CREATE_TRANSACTION_TIMEOUT_MSEC = 120000; // may wait for a hardware wallet confirmation
+constexpr int SEND_TRANSACTION_TIMEOUT_MSEC = 60000;
 
 using namespace std::placeholders;
 
@@ -125,6 +129,7 @@ RemoteWalletd::RemoteWalletd(const QString& endPoint, QObject* parent)
     : QObject(parent)
     , jsonClient_(new JsonRpc::WalletClient(endPoint, this))
     , state_(State::STOPPED)
+    , longPollRequestId_(std::numeric_limits<quint64>::max())
 {
 //    connect(jsonClient_, &JsonRpc::WalletClient::walletInfoReceived, this, &RemoteWalletd::walletInfoReceived);
 //    connect(jsonClient_, &JsonRpc::WalletClient::statusReceived, this, &RemoteWalletd::statusReceived);
@@ -140,6 +145,24 @@ RemoteWalletd::RemoteWalletd(const QString& endPoint, QObject* parent)
     connect(jsonClient_, &JsonRpc::WalletClient::jsonParsingError, this, &RemoteWalletd::jsonParsingError);
 //    connect(jsonClient_, &JsonRpc::WalletClient::jsonErrorResponse, this, &RemoteWalletd::jsonErrorResponse);
     connect(jsonClient_, &JsonRpc::WalletClient::jsonUnknownMessageId, this, &RemoteWalletd::jsonUnknownMessageId);
+    connect(jsonClient_, &JsonRpc::WalletClient::requestTimedOut, this, &RemoteWalletd::requestTimedOut);
+
+    jsonClient_->setDefaultTimeout(REQUEST_TIMEOUT_MSEC);
+    jsonClient_->setMethodTimeout(RpcApi::CreateTransaction::METHOD, CREATE_TRANSACTION_TIMEOUT_MSEC);
+    jsonClient_->setMethodTimeout(RpcApi::SendTransaction::METHOD, SEND_TRANSACTION_TIMEOUT_MSEC);
+
+    switch (Settings::instance().getWalletdCompression(endPoint))
+    {
+    case RpcCompression::NONE:
+        jsonClient_->setCompression(JsonRpc::Client::NoCompression);
+        break;
+    case RpcCompression::RESPONSES:
+        jsonClient_->setCompression(JsonRpc::Client::AcceptCompressed);
+        break;
+    case RpcCompression::REQUESTS_AND_RESPONSES:
+        jsonClient_->setCompression(JsonRpc::Client::AcceptCompressed | JsonRpc::Client::CompressRequests);
+        break;
+    }
 
     connect(jsonClient_, &JsonRpc::WalletClient::packetSent, this, &RemoteWalletd::packetSent);
     connect(jsonClient_, &JsonRpc::WalletClient::packetReceived, this, &RemoteWalletd::packetReceived);
@@ -172,15 +195,14 @@ void RemoteWalletd::sendGetStatus(const RpcApi::GetStatus::Request& req, bool se
 {
     if (state_ == State::CONNECTED)
     {
-        jsonClient_->sendRequest<RpcApi::GetStatus>(
+        // Long-poll get_status is held by walletd until something changes, it must not delay other calls
+        const JsonRpc::Client::RequestId id = jsonClient_->sendRequest<RpcApi::GetStatus>(
                     req,
                     std::bind(&RemoteWalletd::statusReceived, this, _2, sendAgain),
-                    std::bind(&RemoteWalletd::jsonErrorResponse, this, _1, _2));
-
-        jsonClient_->sendRequest<RpcApi::GetBalance>(
-                    RpcApi::GetBalance::Request{},
-                    std::bind(&RemoteWalletd::balanceReceived, this, _2),
-                    std::bind(&RemoteWalletd::jsonErrorResponse, this, _1, _2));
+                    std::bind(&RemoteWalletd::jsonErrorResponse, this, _1, _2),
+                    sendAgain ? JsonRpc::Client::NoBatch | JsonRpc::Client::NoTimeout : JsonRpc::Client::RequestFlags(JsonRpc::Client::Coalesce));
+        if (sendAgain)
+            longPollRequestId_ = id;
 
         heartbeatTimer_.start();
     }
@@ -193,6 +215,8 @@ void RemoteWalletd::run()
         return;
 
     setState(State::CONNECTING);
+    // walletd may have been restarted or replaced meanwhile
+    jsonClient_->resetBatchSupport();
 
 //    onceCallOrDieConnect(
 //            jsonClient_, &JsonRpc::WalletClient::walletInfoReceived,
@@ -220,6 +244,7 @@ void RemoteWalletd::run()
 void RemoteWalletd::stop()
 {
     rerunTimer_.stop();
+    jsonClient_->cancelRequest(longPollRequestId_);
 //    heartbeatTimer_.stop();
     setState(State::STOPPED);
 }
@@ -230,6 +255,14 @@ void RemoteWalletd::statusReceived(const RpcApi::Status& status, bool sendAgain)
 //        setState(State::CONNECTED);
     emit statusReceivedSignal(status);
 
+    // Goes out in one batch with get_transfers requested by statusReceivedSignal receivers
+    if (state_ == State::CONNECTED)
+        jsonClient_->sendRequest<RpcApi::GetBalance>(
+                    RpcApi::GetBalance::Request{},
+                    std::bind(&RemoteWalletd::balanceReceived, this, _2),
+                    std::bind(&RemoteWalletd::jsonErrorResponse, this, _1, _2),
+                    JsonRpc::Client::Coalesce);
+
     if (sendAgain)
         QTimer::singleShot(STATUS_DELAY_TIMER_MSEC,
                            std::bind(&RemoteWalletd::sendGetStatus,
@@ -334,6 +367,12 @@ void RemoteWalletd::jsonErrorResponse(const QString& id, const JsonRpc::Error& e
     emit errorOccurred();
 }
 
+void RemoteWalletd::requestTimedOut(quint64 /*id*/, const QString& method)
+{
+    // A hung walletd is no better than an unreachable one
+    networkError(tr("Walletd did not answer %1 in time.").arg(method));
+}
+
 void RemoteWalletd::jsonUnknownMessageId(const QString& id)
 {
     if (state_ == State::STOPPED)
@@ -370,6 +409,21 @@ bool RemoteWalletd::isConnected() const
     return state_ == State::CONNECTED;
 }
 
+JsonRpc::StatsSnapshot RemoteWalletd::getRpcStatistics() const
+{
+    return jsonClient_->statistics();
+}
+
+quint64 RemoteWalletd::getRpcBytesSaved() const
+{
+    return jsonClient_->requestBytesSaved() + jsonClient_->responseBytesSaved();
+}
+
+void RemoteWalletd::setPacketCapture(bool capture)
+{
+    jsonClient_->setWholeStreamedPackets(capture);
+}
+
 void RemoteWalletd::createTx(const RpcApi::CreateTransaction::Request& tx)
 {
     jsonClient_->sendRequest<RpcApi::CreateTransaction>(
@@ -388,10 +442,15 @@ void RemoteWalletd::sendTx(const RpcApi::SendTransaction::Request& tx)
 
 void RemoteWalletd::getTransfers(const RpcApi::GetTransfers::Request& req, RpcApi::Height topHeight)
 {
-    jsonClient_->sendRequest<RpcApi::GetTransfers>(
+    // Blocks are passed on one by one while the reply is downloaded,
+    // transfersReceived() then gets the rest of the response with no blocks in it.
+    jsonClient_->sendStreamingRequest<RpcApi::GetTransfers, RpcApi::Block>(
                 req,
+                QStringLiteral("blocks"),
+                [this, topHeight, from = req.from_height, to = req.to_height](const RpcApi::Block& block) { emit this->transferBlockReceivedSignal(block, topHeight, from, to); },
                 std::bind(&RemoteWalletd::transfersReceived, this, _2, topHeight, req.from_height, req.to_height),
-                std::bind(&RemoteWalletd::jsonErrorResponse, this, _1, _2));
+                std::bind(&RemoteWalletd::jsonErrorResponse, this, _1, _2),
+                JsonRpc::Client::Coalesce);
 }
 
 void RemoteWalletd::createProof(const RpcApi::CreateSendProof::Request& req)
@@ -422,7 +481,8 @@ void RemoteWalletd::getWalletRecords(const RpcApi::GetWalletRecords::Request& re
     jsonClient_->sendRequest<RpcApi::GetWalletRecords>(
                 req,
                 std::bind(&RemoteWalletd::walletRecordsReceived, this, _2),
-                std::bind(&RemoteWalletd::jsonErrorResponse, this, _1, _2));
+                std::bind(&RemoteWalletd::jsonErrorResponse, this, _1, _2),
+                JsonRpc::Client::Coalesce);
 }
 
 void RemoteWalletd::setAddressLabel(const RpcApi::SetAddressLabel::Request& req)
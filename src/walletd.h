@@ -10,6 +10,7 @@
 #include <functional>
 
 #include "rpcapi.h"
+#include "JsonRpc/JsonRpcStats.h"
 
 class QAuthenticator;
 
@@ -40,22 +41,26 @@ public:
     virtual void run();
     virtual void stop();
 
-    void createTx(const RpcApi::CreateTransaction::Request& tx);
-    void sendTx(const RpcApi::SendTransaction::Request& tx);
-    void getTransfers(const RpcApi::GetTransfers::Request& req, RpcApi::Height topHeight);
-    void createProof(const RpcApi::CreateSendProof::Request& req);
-    void checkSendProof(const RpcApi::CheckSendProof::Request& proof);
-    void getWalletRecords(const RpcApi::GetWalletRecords::Request& req);
-    void setAddressLabel(const RpcApi::SetAddressLabel::Request& req);
-    void createAddresses(const RpcApi::CreateAddresses::Request& req);
-    void createAddress(const QString& label);
+    virtual void createTx(const RpcApi::CreateTransaction::Request& tx);
+    virtual void sendTx(const RpcApi::SendTransaction::Request& tx);
+    virtual void getTransfers(const RpcApi::GetTransfers::Request& req, RpcApi::Height topHeight);
+    virtual void createProof(const RpcApi::CreateSendProof::Request& req);
+    virtual void checkSendProof(const RpcApi::CheckSendProof::Request& proof);
+    virtual void getWalletRecords(const RpcApi::GetWalletRecords::Request& req);
+    virtual void setAddressLabel(const RpcApi::SetAddressLabel::Request& req);
+    virtual void createAddresses(const RpcApi::CreateAddresses::Request& req);
+    virtual void createAddress(const QString& label);
 
     State getState() const;
     bool isConnected() const;
+    JsonRpc::StatsSnapshot getRpcStatistics() const;
+    quint64 getRpcBytesSaved() const; // by compression
+    void setPacketCapture(bool capture); // packetReceived carries streamed replies whole, for recording
 
 signals:
     void statusReceivedSignal(const RpcApi::Status& status);
     void transfersReceivedSignal(const RpcApi::Transfers& history, RpcApi::Height topHeight, RpcApi::Height from_height, RpcApi::Height to_height);
+    void transferBlockReceivedSignal(const RpcApi::Block& block, RpcApi::Height topHeight, RpcApi::Height from_height, RpcApi::Height to_height);
     void walletInfoReceivedSignal(const RpcApi::WalletInfo& info);
     void balanceReceivedSignal(const RpcApi::Balance& balance);
     void createTxReceivedSignal(const RpcApi::CreatedTx& tx);
@@ -80,13 +85,16 @@ signals:
 
     void authRequiredSignal(QAuthenticator* authenticator);
 
+protected:
+    void setState(State state);
+
 private:
     JsonRpc::WalletClient* jsonClient_;
     State state_;
     QTimer rerunTimer_;
     QTimer heartbeatTimer_;
+    quint64 longPollRequestId_;
 
-    void setState(State state);
     virtual void authRequired(QAuthenticator* authenticator);
     void rerun();
     void sendGetStatus(const RpcApi::GetStatus::Request& req, bool sendAgain);
@@ -108,6 +116,7 @@ private slots:
     void jsonParsingError(const QString& message);
     void jsonErrorResponse(const QString& id, const JsonRpc::Error& error);
     void jsonUnknownMessageId(const QString& id);
+    void requestTimedOut(quint64 id, const QString& method);
 
 };
 
@@ -0,0 +1,303 @@
+// Copyright (c) 2015-2018, The Bytecoin developers.
+// Licensed under the GNU Lesser General Public License. See LICENSE for details.
+
+#include <QJsonArray>
+#include <QJsonDocument>
+
+#include <limits>
+
+#include "walletdcapture.h"
+#include "JsonRpc/JsonRpcClient.h"
+
+namespace WalletGUI
+{
+
+namespace
+{
+
+constexpr quint32 CAPTURE_MAGIC = 0x42434e43; // "BCNC"
+constexpr quint16 CAPTURE_VERSION = 1;
+constexpr QDataStream::Version CAPTURE_STREAM_VERSION = QDataStream::Qt_5_6;
+
+QString idOf(const QJsonObject& json)
+{
+    return json.value(QStringLiteral("id")).toVariant().toString();
+}
+
+QList<QJsonObject> objectsOf(const QByteArray& body)
+{
+    // A packet is either a single JSON-RPC object or a batch array of them
+    const QJsonDocument document = QJsonDocument::fromJson(body);
+    QList<QJsonObject> objects;
+    if (document.isObject())
+        objects << document.object();
+    else
+        for (const QJsonValue& value : document.array())
+            if (value.isObject())
+                objects << value.toObject();
+    return objects;
+}
+
+}
+
+WalletdRecorder::WalletdRecorder(const QString& fileName, QObject* parent)
+    : QObject(parent)
+    , file_(fileName)
+{
+    if (!file_.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    {
+        qDebug("[WalletdRecorder] Cannot open %s: %s", qPrintable(fileName), qPrintable(file_.errorString()));
+        return;
+    }
+    stream_.setDevice(&file_);
+    stream_.setVersion(CAPTURE_STREAM_VERSION);
+    stream_ << CAPTURE_MAGIC << CAPTURE_VERSION;
+    clock_.start();
+    qDebug("[WalletdRecorder] Recording walletd traffic to %s", qPrintable(fileName));
+}
+
+WalletdRecorder::~WalletdRecorder()
+{
+    file_.close();
+}
+
+bool WalletdRecorder::isOpen() const
+{
+    return file_.isOpen();
+}
+
+void WalletdRecorder::packetSent(const QByteArray& data)
+{
+    write(CapturedPacket::SENT, data);
+}
+
+void WalletdRecorder::packetReceived(const QByteArray& data)
+{
+    write(CapturedPacket::RECEIVED, data);
+}
+
+void WalletdRecorder::write(CapturedPacket::Direction direction, const QByteArray& data)
+{
+    if (!isOpen())
+        return;
+    QStringList ids;
+    for (const QJsonObject& json : objectsOf(data))
+        ids << idOf(json);
+    stream_ << static_cast<quint8>(direction) << clock_.elapsed() << ids << qCompress(data);
+    file_.flush(); // the capture stays usable if the GUI crashes
+}
+
+ReplayWalletd::ReplayWalletd(const QString& fileName, bool fast, QObject* parent)
+    : RemoteWalletd(QString(), parent)
+    , fileName_(fileName)
+    , fast_(fast)
+    , position_(0)
+    , topHeight_(0)
+{
+    timer_.setSingleShot(true);
+    connect(&timer_, &QTimer::timeout, this, &ReplayWalletd::playNext);
+}
+
+/* static */
+bool ReplayWalletd::readCapture(const QString& fileName, QList<CapturedPacket>& packets, QString& errorString)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        errorString = file.errorString();
+        return false;
+    }
+    QDataStream stream(&file);
+    stream.setVersion(CAPTURE_STREAM_VERSION);
+    quint32 magic = 0;
+    quint16 version = 0;
+    stream >> magic >> version;
+    if (magic != CAPTURE_MAGIC || version != CAPTURE_VERSION)
+    {
+        errorString = tr("Not a walletd capture file.");
+        return false;
+    }
+
+    packets.clear();
+    while (!stream.atEnd())
+    {
+        quint8 direction = 0;
+        CapturedPacket packet;
+        QByteArray compressed;
+        stream >> direction >> packet.msec >> packet.ids >> compressed;
+        if (stream.status() != QDataStream::Ok)
+            break; // a capture cut off by a crash is still good up to here
+        packet.direction = static_cast<CapturedPacket::Direction>(direction);
+        packet.body = qUncompress(compressed);
+        packets << packet;
+    }
+    return true;
+}
+
+/*virtual*/
+void ReplayWalletd::run()
+{
+    if (getState() != State::STOPPED)
+        return;
+
+    QString errorString;
+    if (!readCapture(fileName_, packets_, errorString))
+    {
+        qDebug("[ReplayWalletd] Cannot read %s: %s", qPrintable(fileName_), qPrintable(errorString));
+        emit networkErrorSignal(errorString);
+        return;
+    }
+    qDebug("[ReplayWalletd] Replaying %d packets from %s%s", packets_.size(), qPrintable(fileName_), fast_ ? " as fast as possible" : "");
+
+    setState(State::CONNECTING);
+    position_ = 0;
+    requests_.clear();
+    clock_.start();
+    playNext();
+}
+
+/*virtual*/
+void ReplayWalletd::stop()
+{
+    timer_.stop();
+    RemoteWalletd::stop();
+}
+
+void ReplayWalletd::playNext()
+{
+    if (position_ >= packets_.size())
+    {
+        qDebug("[ReplayWalletd] Replay finished, %d packets in %lld msec", packets_.size(), clock_.elapsed());
+        emit replayFinishedSignal(packets_.size(), clock_.elapsed());
+        return;
+    }
+
+    if (!fast_)
+    {
+        const qint64 wait = packets_[position_].msec - clock_.elapsed();
+        if (wait > 0)
+        {
+            timer_.start(static_cast<int>(wait));
+            return;
+        }
+    }
+
+    play(packets_[position_++]);
+    timer_.start(0); // lets the models and views handle the packet before the next one
+}
+
+void ReplayWalletd::play(const CapturedPacket& packet)
+{
+    const QList<QJsonObject> objects = objectsOf(packet.body);
+    if (packet.direction == CapturedPacket::SENT)
+    {
+        for (const QJsonObject& json : objects)
+            requests_.insert(idOf(json), json);
+        return;
+    }
+
+    for (const QJsonObject& json : objects)
+        playResponse(json);
+}
+
+void ReplayWalletd::playResponse(const QJsonObject& json)
+{
+    const QString id = idOf(json);
+    const QJsonObject request = requests_.take(id);
+    const QString method = request.value(QStringLiteral("method")).toString();
+    const QJsonObject params = request.value(QStringLiteral("params")).toObject();
+
+    if (json.contains(QStringLiteral("error")))
+    {
+        const QJsonObject error = json.value(QStringLiteral("error")).toObject();
+        emit jsonErrorResponseSignal(id, JsonRpc::Error{
+                                         error.value(QStringLiteral("code")).toInt(),
+                                         error.value(QStringLiteral("message")).toString(),
+                                         error.value(QStringLiteral("data")).toVariant().toString()});
+        return;
+    }
+
+    const QJsonObject result = json.value(QStringLiteral("result")).toObject();
+    if (method == RpcApi::GetWalletInfo::METHOD)
+    {
+        emit walletInfoReceivedSignal(RpcApi::WalletInfo::fromJson(result));
+        if (getState() != State::CONNECTED)
+            setState(State::CONNECTED);
+    }
+    else if (method == RpcApi::GetStatus::METHOD)
+    {
+        const RpcApi::Status status = RpcApi::Status::fromJson(result);
+        topHeight_ = status.top_block_height;
+        emit statusReceivedSignal(status);
+    }
+    else if (method == RpcApi::GetBalance::METHOD)
+        emit balanceReceivedSignal(RpcApi::Balance::fromJson(result));
+    else if (method == RpcApi::GetTransfers::METHOD)
+    {
+        // Same order as a live streamed reply: the blocks one by one, then the rest
+        RpcApi::Transfers transfers = RpcApi::Transfers::fromJson(result);
+        const QList<RpcApi::Block> blocks = std::move(transfers.blocks);
+        transfers.blocks.clear();
+        const RpcApi::Height fromHeight = params.value(QStringLiteral("from_height")).toVariant().toUInt();
+        const RpcApi::Height toHeight = params.contains(QStringLiteral("to_height")) ?
+                    params.value(QStringLiteral("to_height")).toVariant().toUInt() :
+                    std::numeric_limits<RpcApi::Height>::max();
+        for (const RpcApi::Block& block : blocks)
+            emit transferBlockReceivedSignal(block, topHeight_, fromHeight, toHeight);
+        emit transfersReceivedSignal(transfers, topHeight_, fromHeight, toHeight);
+    }
+    else if (method == RpcApi::GetWalletRecords::METHOD)
+        emit walletRecordsReceivedSignal(RpcApi::WalletRecords::fromJson(result));
+    else if (method == RpcApi::SetAddressLabel::METHOD)
+        emit addressLabelSetReceivedSignal(params.value(QStringLiteral("address")).toString(), params.value(QStringLiteral("label")).toString());
+    else if (method == RpcApi::CreateAddresses::METHOD)
+        emit addressesCreatedReceivedSignal(RpcApi::CreatedAddresses::fromJson(result));
+    else if (method == RpcApi::CreateTransaction::METHOD)
+        emit createTxReceivedSignal(RpcApi::CreatedTx::fromJson(result));
+    else if (method == RpcApi::SendTransaction::METHOD)
+        emit sendTxReceivedSignal(RpcApi::SentTx::fromJson(result));
+    else if (method == RpcApi::CreateSendProof::METHOD)
+        emit proofsReceivedSignal(RpcApi::Proofs::fromJson(result));
+    else if (method == RpcApi::CheckSendProof::METHOD)
+        emit checkProofReceivedSignal(RpcApi::ProofCheck::fromJson(result));
+    else
+        qDebug("[ReplayWalletd] Skipping reply '%s' to unknown method '%s'", qPrintable(id), qPrintable(method));
+}
+
+/*virtual*/
+void ReplayWalletd::createTx(const RpcApi::CreateTransaction::Request& /*tx*/)
+{}
+
+/*virtual*/
+void ReplayWalletd::sendTx(const RpcApi::SendTransaction::Request& /*tx*/)
+{}
+
+/*virtual*/
+void ReplayWalletd::getTransfers(const RpcApi::GetTransfers::Request& /*req*/, RpcApi::Height /*topHeight*/)
+{}
+
+/*virtual*/
+void ReplayWalletd::createProof(const RpcApi::CreateSendProof::Request& /*req*/)
+{}
+
+/*virtual*/
+void ReplayWalletd::checkSendProof(const RpcApi::CheckSendProof::Request& /*proof*/)
+{}
+
+/*virtual*/
+void ReplayWalletd::getWalletRecords(const RpcApi::GetWalletRecords::Request& /*req*/)
+{}
+
+/*virtual*/
+void ReplayWalletd::setAddressLabel(const RpcApi::SetAddressLabel::Request& /*req*/)
+{}
+
+/*virtual*/
+void ReplayWalletd::createAddresses(const RpcApi::CreateAddresses::Request& /*req*/)
+{}
+
+/*virtual*/
+void ReplayWalletd::createAddress(const QString& /*label*/)
+{}
+
+}
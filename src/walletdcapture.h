@@ -0,0 +1,101 @@
+// Copyright (c) 2015-2018, The Bytecoin developers.
+// Licensed under the GNU Lesser General Public License. See LICENSE for details.
+
+#ifndef WALLETDCAPTURE_H
+#define WALLETDCAPTURE_H
+
+#include <QElapsedTimer>
+#include <QFile>
+#include <QDataStream>
+#include <QHash>
+#include <QJsonObject>
+#include <QTimer>
+
+#include "walletd.h"
+
+namespace WalletGUI
+{
+
+// Capture file: a header, then one record per packet, each with its body compressed
+struct CapturedPacket
+{
+    enum Direction : quint8
+    {
+        SENT, RECEIVED
+    };
+
+    Direction direction = SENT;
+    qint64 msec = 0; // since the recording was started
+    QStringList ids; // JSON-RPC ids in the packet, several for a batch
+    QByteArray body;
+};
+
+// Writes what RemoteWalletd::packetSent and packetReceived carry to a capture file
+class WalletdRecorder : public QObject
+{
+    Q_OBJECT
+    Q_DISABLE_COPY(WalletdRecorder)
+
+public:
+    WalletdRecorder(const QString& fileName, QObject* parent);
+    ~WalletdRecorder();
+
+    bool isOpen() const;
+
+    Q_SLOT void packetSent(const QByteArray& data);
+    Q_SLOT void packetReceived(const QByteArray& data);
+
+private:
+    void write(CapturedPacket::Direction direction, const QByteArray& data);
+
+    QFile file_;
+    QDataStream stream_;
+    QElapsedTimer clock_;
+};
+
+// Plays a capture back through the RemoteWalletd signals, so the models see it as a live walletd.
+// Requests from the models are dropped, the capture already holds the answers they got when recorded.
+class ReplayWalletd : public RemoteWalletd
+{
+    Q_OBJECT
+    Q_DISABLE_COPY(ReplayWalletd)
+
+public:
+    ReplayWalletd(const QString& fileName, bool fast, QObject* parent = nullptr); // fast ignores recorded timing
+
+    virtual void run() override;
+    virtual void stop() override;
+
+    virtual void createTx(const RpcApi::CreateTransaction::Request& tx) override;
+    virtual void sendTx(const RpcApi::SendTransaction::Request& tx) override;
+    virtual void getTransfers(const RpcApi::GetTransfers::Request& req, RpcApi::Height topHeight) override;
+    virtual void createProof(const RpcApi::CreateSendProof::Request& req) override;
+    virtual void checkSendProof(const RpcApi::CheckSendProof::Request& proof) override;
+    virtual void getWalletRecords(const RpcApi::GetWalletRecords::Request& req) override;
+    virtual void setAddressLabel(const RpcApi::SetAddressLabel::Request& req) override;
+    virtual void createAddresses(const RpcApi::CreateAddresses::Request& req) override;
+    virtual void createAddress(const QString& label) override;
+
+    static bool readCapture(const QString& fileName, QList<CapturedPacket>& packets, QString& errorString);
+
+signals:
+    void replayFinishedSignal(int packetCount, qint64 msec);
+
+private:
+    void playNext();
+    void play(const CapturedPacket& packet);
+    void playResponse(const QJsonObject& json);
+
+    const QString fileName_;
+    const bool fast_;
+    QList<CapturedPacket> packets_;
+    int position_;
+    QHash<QString, QJsonObject> requests_; // by id, until answered
+    RpcApi::Height topHeight_;
+    QElapsedTimer clock_;
+    QTimer timer_;
+};
+
+}
+
+#endif // WALLETDCAPTURE_H
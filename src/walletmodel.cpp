@@ -6,9 +6,18 @@
 #include <QDateTime>
 #include <QDebug>
 #include <QMetaEnum>
+#include <QSet>
+#include <QTimer>
+
+#include <algorithm>
+#include <iterator>
 
 #include "walletmodel.h"
 #include "common.h"
+#include "confirmationwindow.h"
+#include "historycache.h"
+#include "historyplanner.h"
+#include "walletstatemodel.h"
 
 #include "rpcapi.h"
 #include "settings.h"
@@ -19,39 +28,31 @@ namespace WalletGUI
 static const int SECS_IN_MINUTE = 60;
 static const int SECS_IN_HOUR = 60 * SECS_IN_MINUTE;
 
-class TxList
-{
-public:
-    using Height = RpcApi::Height;
-    using Transaction = RpcApi::Transaction;
-    using Transfer = RpcApi::Transfer;
-    using Map = QMultiMap<Height, Transaction>;
-    using List = QList<Transaction>;
+// The history cache is written again once this many blocks got confirmed, or this many transactions fetched, since it was written last
+static const RpcApi::Height HISTORY_CACHE_SAVE_BLOCKS = 60;
+static const int HISTORY_CACHE_SAVE_TRANSACTIONS = 1000;
 
-    TxList() {}
-    void add(const Map& map, TxList::Height topHeight, TxList::Height from_height, TxList::Height to_height, TxList::Height next_from_height, TxList::Height next_to_height);
-    const Map& map() const { return map_; }
-    const List& list() const { return list_; }
-    Height topHeight() const { return topHeight_; }
-    int size() const { return map_.size(); }
-    static Height confirmationThreshold(Height height) { return height > CONFIRMATIONS + 2 ? height - CONFIRMATIONS - 2 : 0; }
+// With paging, rows paged out this close to the shown ones are fetched again,
+// and rows farther than half the resident limit go once there are more than that in memory
+static const int HISTORY_PAGE_ROWS = 300;
+static const int HISTORY_MAX_RESIDENT_ROWS = 10 * HISTORY_PAGE_ROWS;
 
-private:
-    Map map_;
-    List list_;
-    Height topHeight_ = 0;
+// A frame at 60 Hz, what the views get to repaint in at most once
+static const int UPDATE_INTERVAL_MSEC = 16;
 
-};
-
-void TxList::add(const Map& newMap, TxList::Height /*topHeight*/, TxList::Height from_height, TxList::Height to_height, TxList::Height /*next_from_height*/, TxList::Height /*next_to_height*/)
+// Hashes are kept binary, hex is made only when a view asks for one
+static QString hashText(const RpcApi::Hash& hash)
 {
-    auto fhit = map_.upperBound(from_height);
-    auto thit = map_.lowerBound(to_height);
-    for (; fhit != thit;)
-        fhit = map_.erase(fhit);
+    return hash.isNull() ? QString() : hash.toHex();
+}
 
-    map_.unite(newMap);
-    list_ = map_.values();
+// The first 8 bytes, big endian: sorts as the hex does, up to 16 digits
+static quint64 hashSortKey(const RpcApi::Hash& hash)
+{
+    quint64 key = 0;
+    for (int i = 0; i < 8; ++i)
+        key = (key << 8) | hash.data()[i];
+    return key;
 }
 
 struct WalletModelState
@@ -70,17 +71,59 @@ struct WalletModelState
 
     RemoteWalletd::State walletdState = RemoteWalletd::State::STOPPED;
     int unconfirmedSize = 0;
+    // Rows whose unlock time still follows the top block, none when first > last
+    int firstLockedRow = 0;
+    int lastLockedRow = -1;
     bool canFetchMore = true;
+    QSet<RpcApi::Height> streamedHeights; // already applied by transferBlockReceived, waiting for the end of their reply
+    QVector<QPair<RpcApi::Height, RpcApi::Height>> pageRequests; // paged out ranges asked for again, (from_height, to_height)
+    HistoryPlanner planner; // older history, fetched by fetchMore() a few windows at once
+    ConfirmationWindow window; // block hashes above the confirmed history, what a new top needs asked again
+
+    QScopedPointer<HistoryCache> historyCache;
+    RpcApi::Height cacheCheckHeight = 0; // newest cached transaction, the first reply must have it in the same block
+    RpcApi::Hash cacheCheckBlockHash;
+    bool cacheCheckPassed = false;
+    RpcApi::Height savedConfirmedHeight = 0;
+    int savedSize = 0;
+    bool savedComplete = false;
 };
 
 WalletModel::WalletModel(QObject* parent)
     : QAbstractItemModel(parent)
     , columnCount_(WalletModel::staticMetaObject.enumerator(WalletModel::staticMetaObject.indexOfEnumerator("Columns")).keyCount())
     , pimpl_(new WalletModelState)
-{}
+    , paging_(false)
+    , updateTimer_(new QTimer(this))
+    , stateModel_(nullptr)
+{
+    updateTimer_->setSingleShot(true);
+    updateTimer_->setInterval(UPDATE_INTERVAL_MSEC);
+    connect(updateTimer_, &QTimer::timeout, this, &WalletModel::flushUpdates);
+
+    // Pending history rows move with the rows inserted and removed before they are flushed,
+    // status, balance and addresses stay where they are
+    connect(this, &QAbstractItemModel::rowsInserted, this, [this](const QModelIndex& /*parent*/, int first, int last)
+    {
+        updates_.rowsInserted(first, last - first + 1, COLUMN_UNLOCK_TIME, COLUMN_PROOF);
+        lockedRowsInserted(first, last - first + 1);
+    });
+    connect(this, &QAbstractItemModel::rowsRemoved, this, [this](const QModelIndex& /*parent*/, int first, int last)
+    {
+        updates_.rowsRemoved(first, last - first + 1, COLUMN_UNLOCK_TIME, COLUMN_PROOF);
+        lockedRowsRemoved(first, last - first + 1);
+    });
+    connect(this, &QAbstractItemModel::modelReset, this, [this]()
+    {
+        updates_.clear();
+    });
+    stateModel_ = new WalletStateModel(this);
+}
 
 WalletModel::~WalletModel()
-{}
+{
+    saveHistoryCache();
+}
 
 Qt::ItemFlags WalletModel::flags(const QModelIndex& /*index*/) const
 {
@@ -189,33 +232,95 @@ QModelIndex WalletModel::parent(const QModelIndex& /*index*/) const
     return QModelIndex();
 }
 
-template<typename Container>
-void WalletModel::containerReceived(Container& oldContainer, const Container& newContainer, int restSize)
+template<typename Mutator>
+void WalletModel::resizeRows(int oldSize, int newSize, int restSize, Mutator mutate)
 {
     const int rows = rowCount();
-    if (newContainer.size() < oldContainer.size())
+    if (newSize < oldSize)
     {
         const int sizeWithoutUs = qMax(restSize, 1);
-        const int newSize = qMax(sizeWithoutUs, newContainer.size());
+        const int newRows = qMax(sizeWithoutUs, newSize);
 
-        if (newSize < rows)
+        if (newRows < rows)
         {
-            beginRemoveRows(QModelIndex(), newSize, rows - 1);
-            oldContainer = newContainer;
+            beginRemoveRows(QModelIndex(), newRows, rows - 1);
+            mutate();
             endRemoveRows();
         }
         else
-            oldContainer = newContainer;
+            mutate();
     }
-    else if (newContainer.size() > rows)
+    else if (newSize > rows)
     {
-        beginInsertRows(QModelIndex(), rows, newContainer.size() - 1);
-        oldContainer = newContainer;
+        beginInsertRows(QModelIndex(), rows, newSize - 1);
+        mutate();
         endInsertRows();
     }
     else
     {
-        oldContainer = newContainer;
+        mutate();
+    }
+}
+
+template<typename Container>
+void WalletModel::containerReceived(Container& oldContainer, const Container& newContainer, int restSize)
+{
+    resizeRows(oldContainer.size(), newContainer.size(), restSize, [&oldContainer, &newContainer]() { oldContainer = newContainer; });
+}
+
+// History rows are newest first: the transaction at index i of the list is shown in row size - 1 - i.
+// The splice is applied run by run as matched by hash, each run announced on its own.
+void WalletModel::applyHistorySplice(const TxList::Splice& splice)
+{
+    TxList& txs = pimpl_->txs;
+    const int oldSize = txs.size();
+    const int restRows = qMax(pimpl_->addresses.size(), 1);
+    if (oldSize - splice.removed < restRows)
+    {
+        // Part of the rows belong to the other sections only, let them grow or shrink at the end
+        const int newSize = oldSize - splice.removed + splice.inserted.size();
+        const int row = oldSize - splice.first - splice.removed;
+        resizeRows(oldSize, newSize, pimpl_->addresses.size(), [&txs, &splice]() { txs.apply(splice); });
+        emitHistoryChanged(row, qMax(oldSize, newSize) - 1);
+        return;
+    }
+
+    int index = splice.first;
+    int from = 0;
+    for (const TxList::Edit& edit : txs.edits(splice))
+    {
+        const int size = txs.size();
+        switch (edit.kind)
+        {
+        case TxList::Edit::KEPT:
+            index += edit.count;
+            from += edit.count;
+            break;
+        case TxList::Edit::CHANGED:
+            txs.replace(index, splice.inserted, from, edit.count);
+            emitHistoryChanged(size - index - edit.count, size - index - 1);
+            index += edit.count;
+            from += edit.count;
+            break;
+        case TxList::Edit::INSERTED:
+        {
+            const int row = size - index;
+            beginInsertRows(QModelIndex(), row, row + edit.count - 1);
+            txs.insert(index, splice.inserted, from, edit.count);
+            endInsertRows();
+            index += edit.count;
+            from += edit.count;
+            break;
+        }
+        case TxList::Edit::REMOVED:
+        {
+            const int row = size - index - edit.count;
+            beginRemoveRows(QModelIndex(), row, row + edit.count - 1);
+            txs.remove(index, edit.count);
+            endRemoveRows();
+            break;
+        }
+        }
     }
 }
 
@@ -227,7 +332,14 @@ void WalletModel::walletInfoReceived(const RpcApi::WalletInfo& response)
         return;
 
     containerReceived(pimpl_->addresses, addresses, pimpl_->txs.size());
+    const bool viewOnlyChanged = pimpl_->viewOnly != response.view_only;
     pimpl_->viewOnly = response.view_only;
+    if (viewOnlyChanged && pimpl_->txs.size() > 0)
+    {
+        // The proof column depends on it
+        pimpl_->txs.clearCache();
+        scheduleDataChanged(index(0, COLUMN_PROOF), index(pimpl_->txs.size() - 1, COLUMN_PROOF), QVector<int>() << Qt::DisplayRole);
+    }
     pimpl_->addressesCount = response.total_address_count;
     pimpl_->creationTimestamp = response.wallet_creation_timestamp;
     pimpl_->walletType = response.wallet_type;
@@ -236,6 +348,8 @@ void WalletModel::walletInfoReceived(const RpcApi::WalletInfo& response)
         pimpl_->net = response.net;
         emit netChangedSignal(pimpl_->net);
     }
+    if (!pimpl_->historyCache && pimpl_->prevTopHeight == 0 && pimpl_->txs.size() == 0 && !response.first_address.isEmpty())
+        loadHistoryCache(response.first_address);
 
     QVector<int> changedAddressRoles;
     changedAddressRoles << Qt::EditRole << Qt::DisplayRole
@@ -252,106 +366,258 @@ void WalletModel::walletInfoReceived(const RpcApi::WalletInfo& response)
         << ROLE_MNEMONIC
         << ROLE_VIEW_ONLY;
 
-    emit dataChanged(index(0, COLUMN_FIRST_ADDRESS), index(pimpl_->addresses.size() - 1, COLUMN_VIEW_ONLY), changedAddressRoles);
+    scheduleDataChanged(index(0, COLUMN_FIRST_ADDRESS), index(pimpl_->addresses.size() - 1, COLUMN_VIEW_ONLY), changedAddressRoles);
 }
 
 void WalletModel::transfersReceived(const RpcApi::Transfers& history, RpcApi::Height topHeight, RpcApi::Height from_height, RpcApi::Height to_height)
 {
-//    const RpcApi::Height confirmedThreshold = topHeight > CONFIRMATIONS + 2 ? topHeight - CONFIRMATIONS - 2 : 0;
-//    const RpcApi::Height prevConfirmedThreshold = pimpl_->prevTopHeight > CONFIRMATIONS + 2 ? pimpl_->prevTopHeight - CONFIRMATIONS - 2 : 0;
-
+    // The blocks came one by one through transferBlockReceived(), history has the rest of the reply
     pimpl_->prevTopHeight = topHeight;
 
-    TxList::Map rcvdTxs;
-    for (const RpcApi::Block& block : history.blocks)
-        for (const RpcApi::Transaction& tx : block.transactions)
-            rcvdTxs.insert(tx.block_height, tx);
+    // A window of the older history: held until the windows above it are in, then merged top down
+    const bool planned = pimpl_->planner.owns(from_height, to_height);
+    if (planned)
+        pimpl_->planner.received(from_height, to_height, history.next_to_height);
+
+    // A paged out range asked for again: its rows got their data back in place as the blocks came
+    const bool pageReply = !planned && pimpl_->pageRequests.removeOne(qMakePair(from_height, to_height));
+
+    // The reply meant to confirm the cached history: if it disagrees, the cache goes and everything is fetched anew
+    if (pimpl_->cacheCheckHeight != 0 && from_height < pimpl_->cacheCheckHeight && to_height > pimpl_->cacheCheckHeight)
+    {
+        pimpl_->cacheCheckHeight = 0;
+        if (!pimpl_->cacheCheckPassed)
+        {
+            dropHistoryCache();
+            return;
+        }
+    }
 
-    if (!rcvdTxs.empty())
+    if (planned)
+        mergePlannedWindows();
+    else
     {
-        TxList newList = pimpl_->txs;
-        newList.add(rcvdTxs, topHeight, from_height, to_height, history.next_from_height, history.next_to_height);
-        containerReceived(pimpl_->txs, newList, pimpl_->addresses.size());
+        // Its blocks are in place already, drop what it did not mention
+        QSet<RpcApi::Height> streamed;
+        for (auto it = pimpl_->streamedHeights.begin(); it != pimpl_->streamedHeights.end();)
+        {
+            if (*it > from_height && *it < to_height)
+            {
+                streamed.insert(*it);
+                it = pimpl_->streamedHeights.erase(it);
+            }
+            else
+                ++it;
+        }
+        if (!streamed.isEmpty())
+        {
+            const TxList::Splice splice = pimpl_->txs.retain(from_height, to_height, streamed);
+            if (!splice.isEmpty())
+                applyWindowSplice(splice);
+        }
     }
 
-    if (history.next_to_height == 0)
+    // A fork this reply found may go below the lowest height it had
+    ConfirmationWindow::Range walkBack;
+    if (!planned && !pageReply && pimpl_->window.owns(from_height, to_height) &&
+            pimpl_->window.replyReceived(from_height, to_height, topHeight, walkBack))
+    {
+        RpcApi::GetTransfers::Request req;
+        req.from_height = walkBack.first;
+        req.to_height = walkBack.second;
+        req.desired_transactions_count = std::numeric_limits<RpcApi::Height>::max();
+        req.forward = false;
+        emit getTransfersSignal(req, pimpl_->status.top_block_height);
+    }
+
+    // A page reply says nothing about how deep the history goes, for windows the planner knows
+    if (planned)
+        pimpl_->canFetchMore = !pimpl_->planner.isComplete();
+    else if (history.next_to_height == 0 && !pageReply)
     {
         const bool cantFetchMore = (history.next_to_height == history.next_from_height);
         pimpl_->canFetchMore = !cantFetchMore;
     }
-    if (pimpl_->canFetchMore)
+    if (canFetchMore())
         emit fetchedSignal();
     else
         emit nothingToFetchSignal();
 
+    const RpcApi::Height confirmedHeight = TxList::confirmationThreshold(topHeight);
+    if ((!pimpl_->canFetchMore && !pimpl_->savedComplete) ||
+            confirmedHeight >= pimpl_->savedConfirmedHeight + HISTORY_CACHE_SAVE_BLOCKS ||
+            pimpl_->txs.size() >= pimpl_->savedSize + HISTORY_CACHE_SAVE_TRANSACTIONS)
+        saveHistoryCache();
+}
 
-//    if (from_height >= pimpl_->prevTopHeight && history.next_from_height < )
+void WalletModel::transferBlockReceived(const RpcApi::Block& block, RpcApi::Height /*topHeight*/, RpcApi::Height from_height, RpcApi::Height to_height)
+{
+    if (pimpl_->planner.owns(from_height, to_height))
+    {
+        pimpl_->planner.accept(block);
+        return;
+    }
+    // Page replies bring old heights back, they say nothing about the blocks near the top
+    if (!pimpl_->pageRequests.contains(qMakePair(from_height, to_height)))
+        pimpl_->window.blockReceived(block.header);
 
-//    for (auto it = pimpl_->txs.begin(); it != pimpl_->txs.end() && it->block_height > confirmedThreshold; it = pimpl_->txs.erase(it))
-//        ;
+    for (const RpcApi::Transaction& tx : block.transactions)
+    {
+        pimpl_->streamedHeights.insert(tx.block_height);
+        checkCachedTransaction(tx);
+    }
+    if (block.transactions.empty())
+        return;
 
-//    for (const RpcApi::Transaction& tx : pimpl_->txs)
-//        if (tx.block_height < )
+    const TxList::List txs = block.transactions.toVector();
+    const QPair<int, int> restored = pimpl_->txs.restore(txs);
+    if (restored.first < restored.second)
+        emitHistoryChanged(pimpl_->txs.size() - restored.second, pimpl_->txs.size() - restored.first - 1);
 
-//    if (history.next_from_height)
+    const TxList::Splice splice = pimpl_->txs.replaceHeights(txs);
+    if (!splice.isEmpty())
+        applyWindowSplice(splice);
+}
 
+void WalletModel::loadHistoryCache(const QString& firstAddress)
+{
+    pimpl_->historyCache.reset(new HistoryCache(firstAddress, pimpl_->net));
 
+    // A complete history is in the column store, mapped rather than read
+    std::unique_ptr<TxColumnStore> store(new TxColumnStore(pimpl_->historyCache->storeDirName()));
+    if (store->open())
+    {
+        const int size = store->size();
+        qDebug("[WalletModel] %d transactions mapped from %s.", size, qPrintable(pimpl_->historyCache->storeDirName()));
+        pimpl_->cacheCheckHeight = store->height(size - 1);
+        pimpl_->cacheCheckBlockHash = store->blockHash(size - 1);
+        pimpl_->cacheCheckPassed = false;
+        pimpl_->savedConfirmedHeight = pimpl_->cacheCheckHeight;
+        pimpl_->savedSize = size;
+        pimpl_->savedComplete = true;
+        pimpl_->canFetchMore = false;
+        resizeRows(0, size, pimpl_->addresses.size(), [this, &store]() { pimpl_->txs.setStore(std::move(store)); });
+        emitHistoryChanged(0, 0);
+        return;
+    }
+    store->remove(); // whatever is there cannot be used
+    pimpl_->txs.setStore(std::move(store));
 
+    HistoryCache::Snapshot snapshot;
+    if (!pimpl_->historyCache->load(snapshot) || snapshot.transactions.isEmpty())
+        return;
 
+    qDebug("[WalletModel] %d transactions loaded from %s.", snapshot.transactions.size(), qPrintable(pimpl_->historyCache->fileName()));
+    const RpcApi::Transaction& newest = snapshot.transactions.last();
+    pimpl_->cacheCheckHeight = newest.block_height;
+    pimpl_->cacheCheckBlockHash = newest.block_hash;
+    pimpl_->cacheCheckPassed = false;
+    pimpl_->savedConfirmedHeight = snapshot.confirmedHeight;
+    pimpl_->savedSize = snapshot.transactions.size();
+    pimpl_->savedComplete = snapshot.complete;
+    pimpl_->canFetchMore = !snapshot.complete;
+
+    TxList::Splice splice;
+    splice.inserted = std::move(snapshot.transactions);
+    applyHistorySplice(splice);
+}
 
-//    const quint32 highestConfirmedBlock = getHighestKnownConfirmedBlock();
-//    if (history.next_from_height >= highestConfirmedBlock) // unconfirmed
-//    {
-////        QLinkedList<RpcApi::Transaction> rcvdTxs;
-//        QList<RpcApi::Transaction> rcvdTxs;
-//        for (const RpcApi::Block& block : history.blocks)
-//            rcvdTxs.append(block.transactions);
-
-//        if (rcvdTxs == pimpl_->txs.mid(0, pimpl_->unconfirmedSize))
-//            return;
-
-//        const QList<RpcApi::Transaction>& confirmedTxs = pimpl_->txs.mid(pimpl_->unconfirmedSize);
-//        pimpl_->unconfirmedSize = rcvdTxs.size();
-//        rcvdTxs.append(confirmedTxs);
-//        containerReceived(pimpl_->txs, rcvdTxs, pimpl_->addresses.size());
-//    }
-//    else if (history.next_to_height < highestConfirmedBlock) // confirmed
-//    {
-//        QList<RpcApi::Transaction> rcvdTxs;
-//        for (const RpcApi::Block& block : history.blocks)
-//            rcvdTxs.append(block.transactions);
+void WalletModel::checkCachedTransaction(const RpcApi::Transaction& tx)
+{
+    if (pimpl_->cacheCheckHeight != 0 && tx.block_height == pimpl_->cacheCheckHeight && tx.block_hash == pimpl_->cacheCheckBlockHash)
+        pimpl_->cacheCheckPassed = true;
+}
 
-//        if (rcvdTxs.empty())
-//            return;
-//        if (rcvdTxs.first().block_height < getBottomConfirmedBlock())
-//        {
-////            QList<RpcApi::Transaction> newTxs = pimpl_->txs;
-////            newTxs.append(rcvdTxs);
-
-//            beginInsertRows(QModelIndex(), rowCount(), pimpl_->txs.size() + rcvdTxs.size() - 1);
-//            pimpl_->txs.append(std::move(rcvdTxs));
-////            oldContainer = newContainer;
-//            endInsertRows();
-
-////            containerReceived(pimpl_->txs, newTxs, pimpl_->addresses.size());
-//            pimpl_->canFetchMore = history.next_to_height != 0;
-//            if (pimpl_->canFetchMore)
-//                emit fetchedSignal();
-//            else
-//                emit nothingToFetchSignal();
-//        }
-//        else if (rcvdTxs.last().block_height > getTopConfirmedBlock())
-//        {
-//            QList<RpcApi::Transaction> newTxs = pimpl_->txs.mid(0, pimpl_->unconfirmedSize);
-//            newTxs.append(rcvdTxs);
-//            newTxs.append(pimpl_->txs.mid(pimpl_->unconfirmedSize));
-//            containerReceived(pimpl_->txs, newTxs, pimpl_->addresses.size());
-//        }
-//    }
-//    else
-//    {
-//        qDebug("Got %d block, but %d expected", history.next_from_height, highestConfirmedBlock);
-//    }
+void WalletModel::dropHistoryCache()
+{
+    qDebug("[WalletModel] Cached history does not match walletd, fetching it again.");
+    pimpl_->historyCache->remove();
+    pimpl_->streamedHeights.clear();
+    pimpl_->pageRequests.clear();
+    pimpl_->planner.reset();
+    pimpl_->window.reset();
+    pimpl_->savedConfirmedHeight = 0;
+    pimpl_->savedSize = 0;
+    pimpl_->savedComplete = false;
+    pimpl_->canFetchMore = true;
+    pimpl_->prevTopHeight = 0;
+
+    TxList::Splice splice;
+    splice.removed = pimpl_->txs.size();
+    applyHistorySplice(splice);
+
+    RpcApi::GetTransfers::Request req;
+    req.from_height = 0;
+    req.to_height = std::numeric_limits<RpcApi::Height>::max();
+    req.desired_transactions_count = 300;
+    req.forward = false;
+    emit getTransfersSignal(req, pimpl_->status.top_block_height);
+}
+
+// Confirmed transactions only, so what is loaded next time needs no more than the check of its newest block
+void WalletModel::saveHistoryCache()
+{
+    if (!pimpl_->historyCache || pimpl_->cacheCheckHeight != 0)
+        return;
+
+    const RpcApi::Height confirmedHeight = TxList::confirmationThreshold(pimpl_->status.top_block_height);
+    if (!pimpl_->canFetchMore)
+    {
+        // The history is complete: its confirmed part is appended to the column store and leaves memory,
+        // the snapshot file is not needed anymore
+        const int stored = pimpl_->txs.storeRows(confirmedHeight);
+        if (stored > 0)
+        {
+            pimpl_->historyCache->remove();
+            qDebug("[WalletModel] %d transactions moved to %s.", stored, qPrintable(pimpl_->historyCache->storeDirName()));
+        }
+        pimpl_->savedConfirmedHeight = confirmedHeight;
+        pimpl_->savedSize = pimpl_->txs.size();
+        pimpl_->savedComplete = true;
+        return;
+    }
+
+    // A snapshot must not have holes: with rows paged out only those above the newest of them are written,
+    // the rest is fetched below the snapshot next time
+    int firstIndex = 0;
+    if (pimpl_->txs.pagedOutCount() > 0)
+        for (int i = pimpl_->txs.storedCount(); i < pimpl_->txs.size(); ++i)
+            if (!pimpl_->txs.isResident(i))
+                firstIndex = i + 1;
+
+    HistoryCache::Snapshot snapshot;
+    snapshot.confirmedHeight = confirmedHeight;
+    snapshot.complete = false;
+    for (int i = firstIndex; i < pimpl_->txs.size(); ++i)
+    {
+        const RpcApi::Transaction& tx = pimpl_->txs.at(i);
+        if (tx.block_height > snapshot.confirmedHeight)
+            break;
+        if (!tx.block_hash.isNull())
+            snapshot.transactions << tx;
+    }
+
+    pimpl_->savedConfirmedHeight = snapshot.confirmedHeight;
+    pimpl_->savedSize = pimpl_->txs.size();
+    pimpl_->savedComplete = snapshot.complete;
+    if (snapshot.transactions.isEmpty())
+        return;
+    if (!pimpl_->historyCache->save(snapshot))
+        qDebug("[WalletModel] Failed to write %s.", qPrintable(pimpl_->historyCache->fileName()));
+}
+
+// A splice replacing a block of the history tells the window the chain switched there
+void WalletModel::applyWindowSplice(const TxList::Splice& splice)
+{
+    const RpcApi::Height fork = pimpl_->txs.forkHeight(splice);
+    if (fork != 0)
+        pimpl_->window.forkFound(fork);
+    applyHistorySplice(splice);
+}
+
+void WalletModel::emitHistoryChanged(int firstRow, int lastRow)
+{
+    trackLockedRows(firstRow, lastRow);
 
     QVector<int> changedRoles;
     changedRoles << Qt::EditRole << Qt::DisplayRole
@@ -362,15 +628,79 @@ void WalletModel::transfersReceived(const RpcApi::Transfers& history, RpcApi::He
         << ROLE_FEE
         << ROLE_PK
         << ROLE_EXTRA
-        << COLUMN_COINBASE
+        << ROLE_COINBASE
         << ROLE_AMOUNT
         << ROLE_BLOCK_HEIGHT
         << ROLE_BLOCK_HASH
 //        << ROLE_TRANSFER_COUNT
 //        << ROLE_STATE
-        << ROLE_TIMESTAMP;
+        << ROLE_TIMESTAMP
+        << ROLE_PROOF
+        << ROLE_SORT_KEY;
+
+    // All of the history columns: a sorted view re-keys only the columns in the span
+    scheduleDataChanged(index(firstRow, COLUMN_UNLOCK_TIME), index(lastRow, COLUMN_PROOF), changedRoles);
+}
+
+bool WalletModel::isLockedRow(int row) const
+{
+    const int size = pimpl_->txs.size();
+    if (row < 0 || row >= size)
+        return false;
+    const quint64 unlock = pimpl_->txs.unlockAt(size - 1 - row);
+    return unlock != 0 &&
+            !isTransactionSpendTimeUnlocked(unlock, pimpl_->status.top_block_height, pimpl_->status.top_block_timestamp_median.toTime_t());
+}
 
-    emit dataChanged(index(0, COLUMN_UNLOCK_TIME), index(pimpl_->txs.size() - 1, COLUMN_TIMESTAMP), changedRoles);
+// Widens the locked range by the locked rows among these, the ends are looked for from both sides
+void WalletModel::trackLockedRows(int firstRow, int lastRow)
+{
+    while (firstRow <= lastRow && !isLockedRow(firstRow))
+        ++firstRow;
+    while (lastRow >= firstRow && !isLockedRow(lastRow))
+        --lastRow;
+    if (firstRow > lastRow)
+        return;
+    if (pimpl_->firstLockedRow > pimpl_->lastLockedRow)
+    {
+        pimpl_->firstLockedRow = firstRow;
+        pimpl_->lastLockedRow = lastRow;
+        return;
+    }
+    pimpl_->firstLockedRow = qMin(pimpl_->firstLockedRow, firstRow);
+    pimpl_->lastLockedRow = qMax(pimpl_->lastLockedRow, lastRow);
+}
+
+void WalletModel::lockedRowsInserted(int first, int count)
+{
+    if (pimpl_->firstLockedRow <= pimpl_->lastLockedRow)
+    {
+        if (pimpl_->firstLockedRow >= first)
+            pimpl_->firstLockedRow += count;
+        if (pimpl_->lastLockedRow >= first)
+            pimpl_->lastLockedRow += count;
+    }
+    trackLockedRows(first, first + count - 1);
+}
+
+void WalletModel::lockedRowsRemoved(int first, int count)
+{
+    if (pimpl_->firstLockedRow > pimpl_->lastLockedRow)
+        return;
+    const int last = first + count - 1;
+    if (pimpl_->firstLockedRow > last)
+        pimpl_->firstLockedRow -= count;
+    else if (pimpl_->firstLockedRow > first)
+        pimpl_->firstLockedRow = first;
+    if (pimpl_->lastLockedRow > last)
+        pimpl_->lastLockedRow -= count;
+    else if (pimpl_->lastLockedRow >= first)
+        pimpl_->lastLockedRow = first - 1;
+    if (pimpl_->firstLockedRow > pimpl_->lastLockedRow)
+    {
+        pimpl_->firstLockedRow = 0;
+        pimpl_->lastLockedRow = -1;
+    }
 }
 
 void WalletModel::statusReceived(const RpcApi::Status& status)
@@ -416,16 +746,45 @@ void WalletModel::statusReceived(const RpcApi::Status& status)
 //        needToRequestUnconfirmed = true;
     }
 
+    // "Unlocked" in the history follows the top block, the history is not repainted as a whole anymore
+    const bool unlockTimesChanged =
+            status.top_block_height != pimpl_->status.top_block_height ||
+            status.top_block_timestamp_median != pimpl_->status.top_block_timestamp_median;
+    // A top going back can lock rows again, then all of them are looked at
+    const bool topWentBack =
+            status.top_block_height < pimpl_->status.top_block_height ||
+            status.top_block_timestamp_median < pimpl_->status.top_block_timestamp_median;
+
     pimpl_->status = status;
     changedRoles << Qt::EditRole << Qt::DisplayRole;
 
-    emit statusUpdatedSignal();
-    emit dataChanged(index(0, COLUMN_TOP_BLOCK_HEIGHT), index(0, COLUMN_PEER_COUNT_SUM), changedRoles);
+    scheduleStatusUpdated();
+    scheduleDataChanged(index(0, COLUMN_TOP_BLOCK_HEIGHT), index(0, COLUMN_PEER_COUNT_SUM), changedRoles);
+    if (topWentBack && pimpl_->txs.size() > 0)
+    {
+        pimpl_->firstLockedRow = 0;
+        pimpl_->lastLockedRow = pimpl_->txs.size() - 1;
+    }
+    if (unlockTimesChanged && pimpl_->firstLockedRow <= pimpl_->lastLockedRow)
+    {
+        // Only the rows locked until now can change, those unlocked by this block drop out of the range
+        const int firstRow = pimpl_->firstLockedRow;
+        const int lastRow = pimpl_->lastLockedRow;
+        scheduleDataChanged(index(firstRow, COLUMN_UNLOCK_TIME), index(lastRow, COLUMN_UNLOCK_TIME), QVector<int>() << Qt::DisplayRole);
+        pimpl_->firstLockedRow = 0;
+        pimpl_->lastLockedRow = -1;
+        trackLockedRows(firstRow, lastRow);
+    }
+
+    const bool firstRequest = pimpl_->prevTopHeight == 0 && pimpl_->cacheCheckHeight == 0;
 
-    const bool firstRequest = pimpl_->prevTopHeight == 0;
+    // Only what is above the height the history was last known good at, unless the window cannot tell yet
+    const RpcApi::Height windowFrom = pimpl_->window.statusChanged(
+                status.top_block_height, status.top_block_hash, TxList::confirmationThreshold(pimpl_->prevTopHeight));
 
     RpcApi::GetTransfers::Request req;
-    req.from_height = TxList::confirmationThreshold(pimpl_->prevTopHeight);
+    // With the history taken from the cache everything above it is asked for, starting with the block checked against it
+    req.from_height = pimpl_->cacheCheckHeight != 0 ? pimpl_->cacheCheckHeight - 1 : windowFrom;
     req.to_height = std::numeric_limits<RpcApi::Height>::max();
     req.desired_transactions_count = firstRequest ? 300 : std::numeric_limits<RpcApi::Height>::max();
     req.forward = false;
@@ -455,7 +814,7 @@ void WalletModel::statusReceived(const RpcApi::Status& status)
 
 quint32 WalletModel::getBottomConfirmedBlock() const
 {
-    return pimpl_->unconfirmedSize < pimpl_->txs.size() ? pimpl_->txs.map().first().block_height : std::numeric_limits<quint32>::max();
+    return pimpl_->unconfirmedSize < pimpl_->txs.size() ? pimpl_->txs.heightAt(0) : std::numeric_limits<quint32>::max();
 }
 
 quint32 WalletModel::getHighestKnownConfirmedBlock() const
@@ -486,7 +845,7 @@ void WalletModel::balanceReceived(const RpcApi::Balance& balance)
 //           qPrintable(formatUnsignedAmount(balance.spendable_dust)),
 //           qPrintable(formatUnsignedAmount(balance.locked_or_unconfirmed)),
 //           qPrintable(formatUnsignedAmount(balance.spendable + balance.spendable_dust + balance.locked_or_unconfirmed)));
-    emit dataChanged(index(0, COLUMN_SPENDABLE), index(0, COLUMN_TOTAL), changedRoles);
+    scheduleDataChanged(index(0, COLUMN_SPENDABLE), index(0, COLUMN_TOTAL), changedRoles);
 }
 
 void WalletModel::stateChanged(RemoteWalletd::State /*oldState*/, RemoteWalletd::State newState)
@@ -499,7 +858,7 @@ void WalletModel::stateChanged(RemoteWalletd::State /*oldState*/, RemoteWalletd:
     changedRoles << Qt::EditRole << Qt::DisplayRole
         << ROLE_STATE;
 
-    emit dataChanged(index(0, COLUMN_STATE), index(0, COLUMN_STATE), changedRoles);
+    scheduleDataChanged(index(0, COLUMN_STATE), index(0, COLUMN_STATE), changedRoles);
 }
 
 QVariant WalletModel::getDisplayRoleData(const QModelIndex& index) const
@@ -530,6 +889,9 @@ QVariant WalletModel::getUserRoleData(const QModelIndex& index, int role) const
     if (role >= ROLE_FIRST_ADDRESS && role <= ROLE_VIEW_ONLY)
         return getUserRoleAddresses(index, role);
 
+    if (role == ROLE_SORT_KEY)
+        return getSortKeyHistory(index);
+
     if (role >= ROLE_UNLOCK_TIME && role <= ROLE_PROOF)
         return getUserRoleHistory(index, role);
 
@@ -631,20 +993,58 @@ QVariant WalletModel::getDisplayRoleHistory(const QModelIndex& index) const
         return QVariant();
 //    const RpcApi::Transaction& tx = pimpl_->txs[index.row()];
 //    const RpcApi::Transaction tx = pimpl_->txs.map().values().at(size - row - 1);
-    const RpcApi::Transaction& tx = pimpl_->txs.list()[size - row - 1];
+    const int txIndex = size - row - 1;
 
-    switch(index.column())
+    // A paged out row shows what it kept until its page is back
+    if (!pimpl_->txs.isResident(txIndex))
+        return index.column() == COLUMN_HASH || index.column() == COLUMN_BLOCK_HEIGHT ? renderHistoryCell(pimpl_->txs.at(txIndex), index.column()) : QVariant();
+
+    TxList::CachedRow& cached = pimpl_->txs.cachedRow(txIndex, COLUMN_PROOF - COLUMN_UNLOCK_TIME + 1);
+    const int cell = index.column() - COLUMN_UNLOCK_TIME;
+    const quint32 bit = 1u << cell;
+
+    // Unlock time follows the top block, everything else only changes with the transaction
+    if (index.column() == COLUMN_UNLOCK_TIME)
     {
-    case COLUMN_UNLOCK_TIME:
+        const RpcApi::Height topHeight = pimpl_->status.top_block_height;
+        const uint medianTime = pimpl_->status.top_block_timestamp_median.toTime_t();
+        if (!(cached.filled & bit) || cached.topHeight != topHeight || cached.medianTime != medianTime)
+        {
+            cached.cells[cell] = renderUnlockTime(pimpl_->txs.unlockAt(txIndex), pimpl_->txs.timeAt(txIndex));
+            cached.filled |= bit;
+            cached.topHeight = topHeight;
+            cached.medianTime = medianTime;
+        }
+        return cached.cells[cell];
+    }
+
+    if (!(cached.filled & bit))
     {
-        if (tx.unlock_block_or_timestamp == 0)
-            return QVariant();
-        if (isTransactionSpendTimeUnlocked(tx.unlock_block_or_timestamp, pimpl_->status.top_block_height, pimpl_->status.top_block_timestamp_median.toTime_t()))
-            return tr("Unlocked");
-        if (tx.unlock_block_or_timestamp < CRYPTONOTE_MAX_BLOCK_NUMBER)
-            return tr("Locked till %1 block").arg(tx.unlock_block_or_timestamp);
-        return tr("Locked till %1").arg(tx.timestamp.toString(Qt::SystemLocaleShortDate));
+        cached.cells[cell] = renderHistoryCell(pimpl_->txs.at(txIndex), index.column());
+        cached.filled |= bit;
     }
+    return cached.cells[cell];
+}
+
+// Read from the columns, the transaction is not decoded for it
+QVariant WalletModel::renderUnlockTime(quint64 unlockBlockOrTimestamp, qint64 time) const
+{
+    if (unlockBlockOrTimestamp == 0)
+        return QVariant();
+    if (isTransactionSpendTimeUnlocked(unlockBlockOrTimestamp, pimpl_->status.top_block_height, pimpl_->status.top_block_timestamp_median.toTime_t()))
+        return tr("Unlocked");
+    if (unlockBlockOrTimestamp < CRYPTONOTE_MAX_BLOCK_NUMBER)
+        return tr("Locked till %1 block").arg(unlockBlockOrTimestamp);
+    const QDateTime timestamp = time >= 0 ? QDateTime::fromMSecsSinceEpoch(time * 1000).toUTC() : QDateTime();
+    return tr("Locked till %1").arg(timestamp.toString(Qt::SystemLocaleShortDate));
+}
+
+QVariant WalletModel::renderHistoryCell(const RpcApi::Transaction& tx, int column) const
+{
+    switch(column)
+    {
+    case COLUMN_UNLOCK_TIME:
+        return renderUnlockTime(tx.unlock_block_or_timestamp, tx.timestamp.isValid() ? tx.timestamp.toMSecsSinceEpoch() / 1000 : -1);
     case COLUMN_PAYMENT_ID:
     {
         if (tx.payment_id.isEmpty())
@@ -654,11 +1054,11 @@ QVariant WalletModel::getDisplayRoleHistory(const QModelIndex& index) const
     case COLUMN_ANONYMITY:
         return tx.anonymity;
     case COLUMN_HASH:
-        return tx.hash;
+        return hashText(tx.hash);
     case COLUMN_FEE:
         return formatAmount(tx.fee);
     case COLUMN_PK:
-        return tx.public_key;
+        return hashText(tx.public_key);
     case COLUMN_EXTRA:
         return tx.extra;
     case COLUMN_COINBASE:
@@ -680,16 +1080,16 @@ QVariant WalletModel::getDisplayRoleHistory(const QModelIndex& index) const
     case COLUMN_BLOCK_HEIGHT:
     {
 //        if (tx.block_height > getLastBlockHeight())
-        if (tx.block_hash.isEmpty())
+        if (tx.block_hash.isNull())
             return tr("-", "n/a");
         return tx.block_height;
     }
     case COLUMN_BLOCK_HASH:
     {
 //        if (tx.block_height > getLastBlockHeight())
-        if (tx.block_hash.isEmpty())
+        if (tx.block_hash.isNull())
             return tr("In mempool");
-        return tx.block_hash;
+        return hashText(tx.block_hash);
     }
     case COLUMN_TIMESTAMP:
     {
@@ -715,6 +1115,37 @@ QVariant WalletModel::getDisplayRoleHistory(const QModelIndex& index) const
     return QVariant();
 }
 
+// Read without the transaction itself, so paged out and stored rows sort as well as the others
+QVariant WalletModel::getSortKeyHistory(const QModelIndex& index) const
+{
+    const TxList& txs = pimpl_->txs;
+    const int row = index.row();
+    if (row >= txs.size())
+        return QVariant();
+    const int i = txs.size() - 1 - row;
+
+    switch (index.column())
+    {
+    case COLUMN_AMOUNT:
+        return static_cast<qint64>(txs.amountAt(i));
+    case COLUMN_FEE:
+        return static_cast<quint64>(txs.feeAt(i));
+    case COLUMN_BLOCK_HEIGHT:
+        return static_cast<quint32>(txs.heightAt(i));
+    case COLUMN_TIMESTAMP:
+        return txs.timeAt(i);
+    case COLUMN_HASH:
+        return hashSortKey(txs.hashAt(i));
+    case COLUMN_BLOCK_HASH:
+        return hashSortKey(txs.blockHashAt(i)); // the pool ones first, they have none
+    case COLUMN_UNLOCK_TIME:
+        return static_cast<quint64>(txs.unlockAt(i)); // heights below timestamps, as walletd tells them apart
+    case COLUMN_PROOF:
+        return static_cast<quint32>(!pimpl_->viewOnly && txs.proofAt(i));
+    }
+    return QVariant();
+}
+
 QVariant WalletModel::getUserRoleHistory(const QModelIndex& index, int role) const
 {
     const int size = pimpl_->txs.size();
@@ -723,7 +1154,7 @@ QVariant WalletModel::getUserRoleHistory(const QModelIndex& index, int role) con
         return QVariant();
 //    const RpcApi::Transaction& tx = pimpl_->txs[index.row()];
 //    const RpcApi::Transaction tx = pimpl_->txs.map().values().at(size - row - 1);
-    const RpcApi::Transaction& tx = pimpl_->txs.list()[size - row - 1];
+    const RpcApi::Transaction& tx = pimpl_->txs.at(size - row - 1);
 
     switch (role)
     {
@@ -734,21 +1165,25 @@ QVariant WalletModel::getUserRoleHistory(const QModelIndex& index, int role) con
     case ROLE_ANONYMITY:
         return tx.anonymity;
     case ROLE_HASH:
-        return tx.hash;
+        return hashText(tx.hash);
     case ROLE_RECIPIENTS:
     {
+        // A transaction pays the same address in several transfers, handles make skipping the repeats cheap
+        QVector<RpcApi::Address> seen;
         QStringList addresses;
         for (const RpcApi::Transfer& tr : tx.transfers)
         {
-            if (!tr.ours)
-                addresses << tr.address;
+            if (tr.ours || seen.contains(tr.address))
+                continue;
+            seen << tr.address;
+            addresses << tr.address.toString();
         }
         return addresses;
     }
     case ROLE_FEE:
         return tx.fee;
     case ROLE_PK:
-        return tx.public_key;
+        return hashText(tx.public_key);
     case ROLE_EXTRA:
         return tx.extra;
     case ROLE_COINBASE:
@@ -766,7 +1201,7 @@ QVariant WalletModel::getUserRoleHistory(const QModelIndex& index, int role) con
     case ROLE_BLOCK_HEIGHT:
         return tx.block_height;
     case ROLE_BLOCK_HASH:
-        return tx.block_hash;
+        return hashText(tx.block_hash);
     case ROLE_TIMESTAMP:
         return tx.timestamp;
     case ROLE_PROOF:
@@ -803,7 +1238,7 @@ QVariant WalletModel::getDisplayRoleStatus(const QModelIndex& index) const
         return pimpl_->status.top_block_timestamp_median.toString(Qt::SystemLocaleShortDate);
     }
     case COLUMN_TOP_BLOCK_HASH:
-        return pimpl_->status.top_block_hash;
+        return hashText(pimpl_->status.top_block_hash);
     case COLUMN_TOP_BLOCK_DIFFICULTY:
     {
         if (pimpl_->status.top_block_height < pimpl_->status.top_known_block_height)
@@ -849,7 +1284,7 @@ QVariant WalletModel::getUserRoleStatus(const QModelIndex& /*index*/, int role)
     case ROLE_TOP_BLOCK_TIMESTAMP_MEDIAN:
         return pimpl_->status.top_block_timestamp_median;
     case ROLE_TOP_BLOCK_HASH:
-        return pimpl_->status.top_block_hash;
+        return hashText(pimpl_->status.top_block_hash);
     case ROLE_TOP_BLOCK_DIFFICULTY:
         return pimpl_->status.top_block_difficulty;
     case ROLE_NETWORK_HASHRATE:
@@ -982,7 +1417,7 @@ quint32 WalletModel::getLastBlockHeight() const
 
 QString WalletModel::getLastBlockHash() const
 {
-    return pimpl_->status.top_block_hash;
+    return hashText(pimpl_->status.top_block_hash);
 }
 
 QDateTime WalletModel::getLastBlockTimestamp() const
@@ -1079,6 +1514,7 @@ bool WalletModel::isViewOnly() const
 
 void WalletModel::reset()
 {
+    saveHistoryCache();
     beginResetModel();
     pimpl_.reset(new WalletModelState);
     endResetModel();
@@ -1125,29 +1561,266 @@ void WalletModel::reset()
         << ROLE_LOCKED_OR_UNCONFIRMED_OUTPUTS
         << ROLE_TOTAL;
 
-    emit dataChanged(index(0, COLUMN_UNLOCK_TIME), index(0, COLUMN_TOTAL), changedRoles);
+    scheduleDataChanged(index(0, COLUMN_UNLOCK_TIME), index(0, COLUMN_TOTAL), changedRoles);
+}
+
+WalletStateModel* WalletModel::getStateModel() const
+{
+    return stateModel_;
 }
 
 void WalletModel::fetchMore(const QModelIndex& parent)
 {
     if (parent.isValid())
         return;
+    if (!paging_ && pimpl_->txs.pagedOutCount() > 0)
+    {
+        // Paging was switched off, the rows paged out come back before anything older is fetched
+        const TxList& txs = pimpl_->txs;
+        int first = txs.storedCount();
+        while (txs.isResident(first))
+            ++first;
+        int last = first;
+        while (last + 1 < txs.size() && !txs.isResident(last + 1))
+            ++last;
+        requestPage(txs.heightAt(first), txs.heightAt(last));
+        return;
+    }
 //    RpcApi::GetTransfers::Request req;
 //    req.to_height = getBottomConfirmedBlock() - 1;
 //    emit getTransfersSignal(req, 0);
 
-    RpcApi::GetTransfers::Request req;
-    req.from_height = 0;
-    req.to_height = getBottomConfirmedBlock() - 1;
-    req.desired_transactions_count = 300;
-    req.forward = false;
-    emit getTransfersSignal(req, pimpl_->status.top_block_height);
+    const TxList& txs = pimpl_->txs;
+    if (txs.size() == 0)
+        return; // the first reply is still on its way
+    if (!pimpl_->planner.isActive())
+    {
+        // Everything below the lowest height fetched is split into windows, sized by what was seen above it
+        const RpcApi::Height bottom = txs.heightAt(0);
+        const RpcApi::Height top = qMax<RpcApi::Height>(pimpl_->status.top_block_height, txs.heightAt(txs.size() - 1));
+        pimpl_->planner.start(bottom, static_cast<double>(txs.size()) / (top - bottom + 1));
+    }
+    requestPlannedWindows(true);
+}
 
+void WalletModel::requestPlannedWindows(bool extend)
+{
+    for (const HistoryPlanner::Range& range : pimpl_->planner.issue(extend))
+    {
+        RpcApi::GetTransfers::Request req;
+        req.from_height = range.first;
+        req.to_height = range.second;
+        req.desired_transactions_count = std::numeric_limits<RpcApi::Height>::max();
+        req.forward = false;
+        emit getTransfersSignal(req, pimpl_->status.top_block_height);
+    }
+}
+
+// Windows which came empty do not make the view ask for more, the planner goes on by itself then
+void WalletModel::mergePlannedWindows()
+{
+    int windows = 0;
+    int merged = 0;
+    HistoryPlanner::Window window;
+    while (pimpl_->planner.takeMerged(window))
+    {
+        ++windows;
+        merged += window.transactions.size();
+        const TxList::Splice splice = pimpl_->txs.replaceRange(window.from_height, window.to_height, std::move(window.transactions));
+        if (!splice.isEmpty())
+            applyHistorySplice(splice);
+    }
+    requestPlannedWindows(windows > 0 && merged == 0);
+    pageHistory();
 }
 
 bool WalletModel::canFetchMore(const QModelIndex& parent) const
 {
-    return !parent.isValid() && pimpl_->canFetchMore;
+    return !parent.isValid() && (pimpl_->canFetchMore || (!paging_ && pimpl_->txs.pagedOutCount() > 0));
+}
+
+QVector<int> WalletModel::findHistoryRows(const TxIndex::Query& query) const
+{
+    const QVector<int> indexes = pimpl_->txs.search(query);
+    const int size = pimpl_->txs.size();
+    QVector<int> rows;
+    rows.reserve(indexes.size());
+    for (auto it = indexes.crbegin(); it != indexes.crend(); ++it)
+        rows << size - 1 - *it;
+    return rows;
+}
+
+const BalanceSeries& WalletModel::getBalanceSeries() const
+{
+    return pimpl_->txs.series();
+}
+
+RpcApi::SignedAmount WalletModel::getTotalBalance() const
+{
+    return pimpl_->balance.spendable + pimpl_->balance.spendable_dust + pimpl_->balance.locked_or_unconfirmed;
+}
+
+RpcApi::SignedAmount WalletModel::getBalanceAt(RpcApi::Height height) const
+{
+    const BalanceSeries& series = getBalanceSeries();
+    return getTotalBalance() - (series.total().net - series.through(height).net);
+}
+
+RpcApi::Height WalletModel::getLastReorgDepth() const
+{
+    return pimpl_->window.lastReorgDepth();
+}
+
+RpcApi::Height WalletModel::getMaxReorgDepth() const
+{
+    return pimpl_->window.maxReorgDepth();
+}
+
+void WalletModel::setUpdateInterval(int msec)
+{
+    updateTimer_->setInterval(qMax(0, msec));
+    if (msec <= 0)
+        flushUpdates();
+}
+
+quint64 WalletModel::getMergedUpdates() const
+{
+    return updates_.merged();
+}
+
+quint64 WalletModel::getDroppedUpdates() const
+{
+    return updates_.dropped();
+}
+
+void WalletModel::scheduleDataChanged(const QModelIndex& topLeft, const QModelIndex& bottomRight, const QVector<int>& roles)
+{
+    if (!topLeft.isValid() || !bottomRight.isValid())
+        return;
+    updates_.add(topLeft.row(), bottomRight.row(), topLeft.column(), bottomRight.column(), roles);
+    scheduleFlush();
+}
+
+void WalletModel::scheduleStatusUpdated()
+{
+    updates_.addStatus();
+    scheduleFlush();
+}
+
+// The first change starts the interval, the ones coming before it ends go out together
+void WalletModel::scheduleFlush()
+{
+    if (updateTimer_->interval() == 0)
+        flushUpdates();
+    else if (!updateTimer_->isActive())
+        updateTimer_->start();
+}
+
+void WalletModel::flushUpdates()
+{
+    updateTimer_->stop();
+    if (updates_.isEmpty())
+        return;
+    bool status = false;
+    const QVector<UpdateScheduler::Region> regions = updates_.take(rowCount(), status);
+    for (const UpdateScheduler::Region& region : regions)
+        emit dataChanged(index(region.firstRow, region.firstColumn), index(region.lastRow, region.lastColumn), region.roles);
+    if (status)
+        emit statusUpdatedSignal();
+}
+
+void WalletModel::setPaging(bool paging)
+{
+    paging_ = paging;
+    pageHistory();
+}
+
+void WalletModel::setVisibleRows(int firstRow, int lastRow)
+{
+    visibleRuns_.clear();
+    if (firstRow <= lastRow)
+        visibleRuns_ << qMakePair(firstRow, lastRow);
+    pageHistory();
+}
+
+void WalletModel::setVisibleRows(QVector<int> rows)
+{
+    std::sort(rows.begin(), rows.end());
+    visibleRuns_.clear();
+    for (const int row : rows)
+    {
+        if (!visibleRuns_.isEmpty() && row <= visibleRuns_.last().second + 1)
+            visibleRuns_.last().second = qMax(visibleRuns_.last().second, row);
+        else
+            visibleRuns_ << qMakePair(row, row);
+    }
+    pageHistory();
+}
+
+// Rows are newest first and the list is oldest first, the runs are turned into list indexes here.
+// Runs from all over the list (a sorted view) share the margins, so as many rows stay in memory as with one.
+void WalletModel::pageHistory()
+{
+    TxList& txs = pimpl_->txs;
+    const int size = txs.size();
+    if (!paging_ || size == 0 || visibleRuns_.isEmpty())
+        return;
+    QVector<QPair<int, int>> runs;
+    for (auto it = visibleRuns_.crbegin(); it != visibleRuns_.crend(); ++it)
+        runs << qMakePair(qBound(0, size - 1 - it->second, size - 1), qBound(0, size - 1 - it->first, size - 1));
+
+    if (txs.residentCount() > HISTORY_MAX_RESIDENT_ROWS)
+    {
+        const RpcApi::Height confirmedHeight = TxList::confirmationThreshold(pimpl_->status.top_block_height);
+        const int keep = HISTORY_MAX_RESIDENT_ROWS / 2 / runs.size();
+        int begin = 0; // the rows below it are paged out or kept already
+        for (const auto& run : runs)
+        {
+            const int keepFirst = qMax(run.first - keep, 0);
+            if (txs.pageOut(begin, keepFirst, confirmedHeight) > 0)
+                emitHistoryChanged(size - keepFirst, size - 1 - begin);
+            begin = qMax(begin, qMin(run.second + keep, size - 1) + 1);
+        }
+        if (txs.pageOut(begin, size, confirmedHeight) > 0)
+            emitHistoryChanged(0, size - 1 - begin);
+    }
+
+    const int margin = HISTORY_PAGE_ROWS / runs.size();
+    int next = 0; // the rows below it are looked at already
+    for (const auto& run : runs)
+    {
+        const int fetchFirst = qMax(run.first - margin, next);
+        const int fetchLast = qMin(run.second + margin, size - 1);
+        for (int i = fetchFirst; i <= fetchLast; ++i)
+        {
+            if (txs.isResident(i))
+                continue;
+            int j = i;
+            while (j < fetchLast && !txs.isResident(j + 1))
+                ++j;
+            requestPage(txs.heightAt(i), txs.heightAt(j));
+            i = j;
+        }
+        next = qMax(next, fetchLast + 1);
+    }
+}
+
+// Whole heights are asked for, the rows of them still in memory simply come back equal
+void WalletModel::requestPage(RpcApi::Height lowest, RpcApi::Height highest)
+{
+    const RpcApi::Height from_height = lowest > 0 ? lowest - 1 : 0;
+    const RpcApi::Height to_height = highest + 1;
+    for (const auto& request : pimpl_->pageRequests)
+        if (request.first <= from_height && request.second >= to_height)
+            return;
+    pimpl_->pageRequests << qMakePair(from_height, to_height);
+
+    RpcApi::GetTransfers::Request req;
+    req.from_height = from_height;
+    req.to_height = to_height;
+    req.desired_transactions_count = std::numeric_limits<RpcApi::Height>::max();
+    req.forward = false;
+    emit getTransfersSignal(req, pimpl_->status.top_block_height);
 }
 
 //int WalletModel::getTopFetchedHeight() const
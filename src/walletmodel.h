@@ -8,12 +8,17 @@
 #include <QPair>
 
 #include "rpcapi.h"
+#include "txlist.h"
+#include "updatescheduler.h"
 #include "walletd.h"
 
+class QTimer;
+
 namespace WalletGUI
 {
 
 struct WalletModelState;
+class WalletStateModel;
 
 class WalletModel : public QAbstractItemModel
 {
@@ -110,6 +115,8 @@ public:
         ROLE_TIMESTAMP,
         ROLE_RECIPIENTS,
         ROLE_PROOF,
+        ROLE_SORT_KEY, // typed per shown column: amount qint64, fee quint64, height quint32, timestamp qint64 seconds,
+                       // hashes quint64 of their first bytes, unlock time quint64, proof quint32
 
         ROLE_TOP_BLOCK_HEIGHT, // getStatus
         ROLE_TOP_BLOCK_TIMESTAMP,
@@ -159,6 +166,30 @@ public:
 
     void reset();
 
+    // Row 0 alone, without the history, what the widget mappers are to be set on
+    WalletStateModel* getStateModel() const;
+
+    // Paging: confirmed history rows far from the ones shown are dropped from memory and fetched again when needed
+    void setPaging(bool paging);
+    void setVisibleRows(int firstRow, int lastRow);
+    void setVisibleRows(QVector<int> rows); // any order, a sorted view shows rows from all over the history
+
+    QVector<int> findHistoryRows(const TxIndex::Query& query) const; // ascending
+
+    // Totals of the fetched history; balances back in time are the current one less what came after
+    const BalanceSeries& getBalanceSeries() const;
+    RpcApi::SignedAmount getTotalBalance() const;
+    RpcApi::SignedAmount getBalanceAt(RpcApi::Height height) const;
+
+    // Blocks of the history a chain switch replaced, the last time and at most
+    RpcApi::Height getLastReorgDepth() const;
+    RpcApi::Height getMaxReorgDepth() const;
+
+    // Changes reach the views at most once an interval, a frame by default; 0 passes each one on at once
+    void setUpdateInterval(int msec);
+    quint64 getMergedUpdates() const;
+    quint64 getDroppedUpdates() const;
+
     QString getAddress() const;
     bool isConnected() const;
     bool isAmethyst() const;
@@ -194,6 +225,7 @@ signals:
 public slots:
     void statusReceived(const RpcApi::Status& status);
     void transfersReceived(const RpcApi::Transfers& history, RpcApi::Height topHeight, RpcApi::Height from_height, RpcApi::Height to_height);
+    void transferBlockReceived(const RpcApi::Block& block, RpcApi::Height topHeight, RpcApi::Height from_height, RpcApi::Height to_height);
     void walletInfoReceived(const RpcApi::WalletInfo& info);
     void balanceReceived(const RpcApi::Balance& balance);
 
@@ -217,12 +249,36 @@ private:
 
     QVariant getUserRoleAddresses(const QModelIndex& index, int role) const;
     QVariant getUserRoleHistory(const QModelIndex& index, int role) const;
+    QVariant getSortKeyHistory(const QModelIndex& index) const;
+    QVariant renderHistoryCell(const RpcApi::Transaction& tx, int column) const;
+    QVariant renderUnlockTime(quint64 unlockBlockOrTimestamp, qint64 time) const;
     QVariant getUserRoleStatus(const QModelIndex& index, int role) const;
     QVariant getUserRoleBalance(const QModelIndex& index, int role) const;
     QVariant getUserRoleState(const QModelIndex& index, int role) const;
 
+    template<typename Mutator>
+    void resizeRows(int oldSize, int newSize, int restSize, Mutator mutate);
     template<typename Container>
     void containerReceived(Container& oldContainer, const Container& newContainer, int restSize);
+    void applyHistorySplice(const TxList::Splice& splice);
+    void applyWindowSplice(const TxList::Splice& splice);
+    void emitHistoryChanged(int firstRow, int lastRow);
+    bool isLockedRow(int row) const; // its unlock time may still change with the top block
+    void trackLockedRows(int firstRow, int lastRow);
+    void lockedRowsInserted(int first, int count);
+    void lockedRowsRemoved(int first, int count);
+    void scheduleDataChanged(const QModelIndex& topLeft, const QModelIndex& bottomRight, const QVector<int>& roles);
+    void scheduleStatusUpdated();
+    void scheduleFlush();
+    void flushUpdates();
+    void loadHistoryCache(const QString& firstAddress);
+    void checkCachedTransaction(const RpcApi::Transaction& tx);
+    void dropHistoryCache();
+    void saveHistoryCache();
+    void pageHistory();
+    void requestPage(RpcApi::Height lowest, RpcApi::Height highest);
+    void requestPlannedWindows(bool extend);
+    void mergePlannedWindows();
 
     quint32 getTopConfirmedBlock() const;
     quint32 getBottomConfirmedBlock() const;
@@ -230,6 +286,11 @@ private:
 
     const int columnCount_;
     QScopedPointer<WalletModelState> pimpl_;
+    bool paging_;
+    QVector<QPair<int, int>> visibleRuns_; // rows shown, (first, last) ascending
+    UpdateScheduler updates_; // dataChanged and statusUpdatedSignal not emitted yet
+    QTimer* updateTimer_;
+    WalletStateModel* stateModel_;
 };
 
 }
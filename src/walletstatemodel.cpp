@@ -0,0 +1,50 @@
+// Copyright (c) 2015-2018, The Bytecoin developers.
+// Licensed under the GNU Lesser General Public License. See LICENSE for details.
+
+#include "walletstatemodel.h"
+#include "walletmodel.h"
+
+namespace WalletGUI
+{
+
+WalletStateModel::WalletStateModel(WalletModel* walletModel)
+    : QAbstractTableModel(walletModel)
+    , walletModel_(walletModel)
+{
+    connect(walletModel_, &QAbstractItemModel::dataChanged, this, &WalletStateModel::sourceDataChanged);
+    connect(walletModel_, &QAbstractItemModel::modelAboutToBeReset, this, &WalletStateModel::beginResetModel);
+    connect(walletModel_, &QAbstractItemModel::modelReset, this, &WalletStateModel::endResetModel);
+}
+
+WalletStateModel::~WalletStateModel()
+{}
+
+int WalletStateModel::rowCount(const QModelIndex& parent /*= QModelIndex()*/) const
+{
+    return parent.isValid() ? 0 : 1;
+}
+
+int WalletStateModel::columnCount(const QModelIndex& parent /*= QModelIndex()*/) const
+{
+    return parent.isValid() ? 0 : walletModel_->columnCount();
+}
+
+QVariant WalletStateModel::data(const QModelIndex& index, int role /*= Qt::DisplayRole*/) const
+{
+    if (!index.isValid())
+        return QVariant();
+    return walletModel_->index(0, index.column()).data(role);
+}
+
+// WalletModel reports these on its row 0 and nowhere else; the history columns of a change are left out
+void WalletStateModel::sourceDataChanged(const QModelIndex& topLeft, const QModelIndex& bottomRight, const QVector<int>& roles)
+{
+    if (!topLeft.isValid() || !bottomRight.isValid() || topLeft.row() != 0)
+        return;
+    if (topLeft.column() < WalletModel::COLUMN_UNLOCK_TIME)
+        emit dataChanged(index(0, topLeft.column()), index(0, qMin<int>(bottomRight.column(), WalletModel::COLUMN_UNLOCK_TIME - 1)), roles);
+    if (bottomRight.column() > WalletModel::COLUMN_PROOF)
+        emit dataChanged(index(0, qMax<int>(topLeft.column(), WalletModel::COLUMN_PROOF + 1)), index(0, bottomRight.column()), roles);
+}
+
+}
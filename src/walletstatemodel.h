@@ -0,0 +1,38 @@
+// Copyright (c) 2015-2018, The Bytecoin developers.
+// Licensed under the GNU Lesser General Public License. See LICENSE for details.
+
+#ifndef WALLETSTATEMODEL_H
+#define WALLETSTATEMODEL_H
+
+#include <QAbstractTableModel>
+
+namespace WalletGUI
+{
+
+class WalletModel;
+
+// Status, balance, wallet info and walletd state of a WalletModel on a row of their own, for the widget mappers.
+// WalletModel has them on its row 0 too, but history rows come and go in front of it there. Every column
+// of WalletModel is here; the history ones are of no use.
+class WalletStateModel : public QAbstractTableModel
+{
+    Q_OBJECT
+    Q_DISABLE_COPY(WalletStateModel)
+
+public:
+    explicit WalletStateModel(WalletModel* walletModel);
+    virtual ~WalletStateModel();
+
+    virtual int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    virtual int columnCount(const QModelIndex& parent = QModelIndex()) const override;
+    virtual QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+
+private:
+    void sourceDataChanged(const QModelIndex& topLeft, const QModelIndex& bottomRight, const QVector<int>& roles);
+
+    WalletModel* walletModel_;
+};
+
+}
+
+#endif // WALLETSTATEMODEL_H